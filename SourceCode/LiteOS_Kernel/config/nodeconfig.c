@@ -8,6 +8,7 @@
 #include "nodeconfig.h"
 #include "../storage/filesys/storageconstants.h"
 #include "../storage/bytestorage/bytestorage.h"
+#include "../storage/bytestorage/kvstore.h"
 
 //Global variable!!! 
 //This is the id of the current node. Every time it is modified, has to be written back into the 
@@ -33,26 +34,39 @@ char *node_readnodestring()
 
 void node_writenodeid(uint16_t nodeid)
 {
-    write16uint(NODEIDOFFSET, nodeid);
+    kvPut(KV_KEY_NODEID, &nodeid, 2);
 }
 
 //-------------------------------------------------------------------------
 uint16_t node_readnodeid()
 {
-    return read16uint(NODEIDOFFSET);
+    uint16_t nodeid;
+
+    //a node that has not written its id since the store was added still has it where older kernels put it
+    if (kvGet(KV_KEY_NODEID, &nodeid, 2) != 2)
+    {
+        return read16uint(NODEIDOFFSET);
+    }
+    return nodeid;
 }
 
 
 //-------------------------------------------------------------------------
 void node_setradiochannel(uint8_t channel)
 {
-    write8uint(NODECHANNELOFFSET, channel);
+    kvPut(KV_KEY_CHANNEL, &channel, 1);
 }
 
 //-------------------------------------------------------------------------
 uint8_t node_getradiochannel()
 {
-    return read8uint(NODECHANNELOFFSET);
+    uint8_t channel;
+
+    if (kvGet(KV_KEY_CHANNEL, &channel, 1) != 1)
+    {
+        return read8uint(NODECHANNELOFFSET);
+    }
+    return channel;
 }
 
  
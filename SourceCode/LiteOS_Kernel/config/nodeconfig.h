@@ -34,7 +34,7 @@ extern char filenameid[17];
 
 
 /**
-@brief Write the node id into byte storage.
+@brief Write the node id into the key-value store of the byte storage. Nothing is written if the id has not changed.
 @param nodeid The nodeid to be written into storage. 
 @return Void. 
 */
@@ -52,7 +52,7 @@ uint16_t node_readnodeid();
 char *node_readnodestring();
 
 
-/** @brief Write the channel of the current node into byte storage.
+/** @brief Write the channel of the current node into the key-value store of the byte storage.
 	@param channel The channel to be written.
 	@todo Remove this or combine with RF230?
 	@return Void. 
@@ -22,9 +22,11 @@
 #include "./realmain.h"
 #include "../config/nodeconfig.h"
 #include "../storage/bytestorage/bytestorage.h"
+#include "../storage/bytestorage/kvstore.h"
 #include "../io/serial/stdserial.h"
 #include "../storage/filesys/vectorflash.h"
 #include "../storage/filesys/vectornode.h"
+#include "../storage/filesys/wearlevel.h"
 #include "../types/string.h"
 #include "../timer/generictimer.h"
 #include "../timer/globaltiming.h"
@@ -102,11 +104,14 @@ int main()
 	 #ifdef FORMATFILESYSTEM
      formatSystem();
      buildRootNode();
+     fsync2();
      #endif
+     mountSystem();
 	 
-	 
-     genericwriteBytes(NETWORKNAMEOFFSET, 16, networkid);
-     genericwriteBytes(NODEFILENAMEOFFSET, 16, filenameid);
+     kvInit();
+     //the store skips values that have not changed, so a normal boot writes nothing here
+     kvPut(KV_KEY_NETWORKNAME, networkid, 16);
+     kvPut(KV_KEY_NODENAME, filenameid, 16);
      node_writenodeid(nodeid);
 	 
      	 
@@ -118,6 +123,7 @@ int main()
 
     //timer and radio 
     GenericTimerInit();
+    GenericTimerStart(WEAR_LEVEL_TIMER, TIMER_REPEAT, WEAR_LEVEL_INTERVAL);
 	
    
      
@@ -0,0 +1,344 @@
+/** @file cc2420lplm.c
+       @brief The implementation of the low-power listening module for cc2420. 
+
+	The receiver is turned off with SRFOFF, which keeps the oscillator running so that it is back in receive mode
+	within a few hundred microseconds. A check turns it on, waits until the RSSI is valid and reads the CCA pin. A
+	clear channel turns it off again, and a busy one keeps it on for a listen window, extended while a frame is coming
+	in or the radio is sending.
+
+	A train resends the frame left in the TX FIFO as soon as the last copy is out, without a clear channel check, for
+	one check interval. Copies carry the same sequence number, so a receiver passes up the first of them only. The
+	last few packets are remembered, so that the copies of trains from several senders that overlap are all told.
+*/
+
+#include "cc2420lplm.h"
+#include "cc2420radiom.h"
+#include "cc2420controlm.h"
+
+#include "../../hardware/avrhardware.h"
+#include "../../hardware/micaz/micazhardware.h"
+
+#include "../../timer/generictimer.h"
+#include "../../timer/globaltiming.h"
+#include "../../types/types.h"
+
+extern uint8_t cc2420radiom_stateRadio;
+extern bool cc2420radiom_bPacketReceiving;
+
+//the cycle counter wraps at 50000 times 50000
+#define CC2420_LPL_TIME_WRAP 2500000000UL
+
+//the packets remembered to tell their further copies
+#define CC2420_LPL_RECENT 4
+
+//the state of the idle radio when an interval is set
+enum
+{
+    CC2420_LPL_AWAKE = 0, CC2420_LPL_ASLEEP
+};
+
+static cc2420lplm_stats lplstats = { CC2420_LPL_INTERVAL };
+static uint8_t lplstate;
+static bool lplradioon;
+static uint32_t lplonsince;
+//the cycles short of a whole millisecond left over when the times were last added up
+static uint16_t lplonrest;
+static uint16_t lplsendrest;
+static uint32_t lpltrainstart;
+static bool lpltrain;
+
+//the last packets passed up, to tell their further copies, the oldest replaced first
+typedef struct
+{
+    uint16_t addr;
+    uint16_t port;
+    uint8_t dsn;
+    uint8_t length;
+    uint32_t time;
+} cc2420lplm_recent;
+
+static cc2420lplm_recent lplrecent[CC2420_LPL_RECENT];
+static uint8_t lplrecentcount;
+static uint8_t lplrecentnext;
+
+//-------------------------------------------------------------------------
+static uint32_t cc2420lplm_elapsed(uint32_t since)
+{
+    uint32_t now;
+
+    now = getCurrentResolution();
+    if (now >= since)
+    {
+        return now - since;
+    }
+    return now + (CC2420_LPL_TIME_WRAP - since);
+}
+
+//-------------------------------------------------------------------------
+//the times are kept in milliseconds, which the 32-bit counters hold for 49 days
+static void cc2420lplm_addTime(uint32_t * total, uint16_t * rest,
+                               uint32_t since)
+{
+    uint32_t cycles;
+
+    cycles = cc2420lplm_elapsed(since) + *rest;
+    *total += cycles / CC2420_LPL_CYCLES_PER_MS;
+    *rest = (uint16_t) (cycles % CC2420_LPL_CYCLES_PER_MS);
+}
+
+//-------------------------------------------------------------------------
+static void cc2420lplm_radioOn(void)
+{
+    if (!lplradioon)
+    {
+        lplradioon = TRUE;
+        lplonsince = getCurrentResolution();
+    }
+}
+
+//-------------------------------------------------------------------------
+static void cc2420lplm_radioOff(void)
+{
+    if (lplradioon)
+    {
+        cc2420lplm_addTime(&lplstats.ontime, &lplonrest, lplonsince);
+        lplradioon = FALSE;
+    }
+}
+
+//-------------------------------------------------------------------------
+//add up the time the radio has been on so far, before the cycle counter can wrap more than once
+static void cc2420lplm_foldOnTime(void)
+{
+    _atomic_t _atomic;
+
+    _atomic = _atomic_start();
+    if (lplradioon)
+    {
+        cc2420lplm_radioOff();
+        cc2420lplm_radioOn();
+    }
+    _atomic_end(_atomic);
+}
+
+//-------------------------------------------------------------------------
+//turn the receiver off unless the radio is busy, and check the channel again after one interval
+static void cc2420lplm_sleep(void)
+{
+    _atomic_t _atomic;
+
+    _atomic = _atomic_start();
+    if ((lplstats.interval == 0) || (lplstate == CC2420_LPL_ASLEEP))
+    {
+        _atomic_end(_atomic);
+        return;
+    }
+    if ((cc2420radiom_stateRadio != cc2420radiom_IDLE_STATE)
+        || (cc2420radiom_bPacketReceiving))
+    {
+        _atomic_end(_atomic);
+        GenericTimerStart(CC2420_LPL_TIMER, TIMER_ONE_SHOT,
+                          CC2420_LPL_LISTEN_TIME);
+        return;
+    }
+    lplstate = CC2420_LPL_ASLEEP;
+    _atomic_end(_atomic);
+    cc2420radiom_HPLChipcon_cmd(0x06);
+    cc2420radiom_flushRXFIFO();
+    cc2420lplm_radioOff();
+    GenericTimerStart(CC2420_LPL_TIMER, TIMER_ONE_SHOT, lplstats.interval);
+}
+
+//-------------------------------------------------------------------------
+void cc2420lplm_radioStarted(void)
+{
+    lplstate = CC2420_LPL_AWAKE;
+    lpltrain = FALSE;
+    lplrecentcount = 0;
+    cc2420lplm_radioOn();
+    if (lplstats.interval != 0)
+    {
+        GenericTimerStart(CC2420_LPL_TIMER, TIMER_ONE_SHOT,
+                          CC2420_LPL_LISTEN_TIME);
+    }
+    else
+    {
+        //nothing else turns the receiver off, so the timer only adds up its time
+        GenericTimerStart(CC2420_LPL_TIMER, TIMER_REPEAT,
+                          CC2420_LPL_FOLD_TIME);
+    }
+}
+
+//-------------------------------------------------------------------------
+void cc2420lplm_setInterval(uint16_t interval)
+{
+    lplstats.interval = interval;
+    if (interval == 0)
+    {
+        GenericTimerStart(CC2420_LPL_TIMER, TIMER_REPEAT,
+                          CC2420_LPL_FOLD_TIME);
+        cc2420lplm_wake();
+        return;
+    }
+    if (lplstate == CC2420_LPL_AWAKE)
+    {
+        GenericTimerStart(CC2420_LPL_TIMER, TIMER_ONE_SHOT,
+                          CC2420_LPL_LISTEN_TIME);
+    }
+}
+
+//-------------------------------------------------------------------------
+void cc2420lplm_wake(void)
+{
+    _atomic_t _atomic;
+
+    _atomic = _atomic_start();
+    if (lplstate != CC2420_LPL_ASLEEP)
+    {
+        _atomic_end(_atomic);
+        return;
+    }
+    lplstate = CC2420_LPL_AWAKE;
+    _atomic_end(_atomic);
+    cc2420controlm_CC2420Control_RxMode();
+    //the RSSI, and so the CCA pin, is valid 8 symbol periods after the receiver is on
+    LITE_uwait(450);
+    cc2420lplm_radioOn();
+}
+
+//-------------------------------------------------------------------------
+void cc2420lplm_startTrain(void)
+{
+    lpltrain = TRUE;
+    lpltrainstart = getCurrentResolution();
+    if (lplstats.interval != 0)
+    {
+        lplstats.trains++;
+    }
+}
+
+//-------------------------------------------------------------------------
+bool cc2420lplm_trainContinues(void)
+{
+    if ((!lpltrain) || (lplstats.interval == 0))
+    {
+        return FALSE;
+    }
+    lplstats.copies++;
+    return cc2420lplm_elapsed(lpltrainstart) <
+        (uint32_t) lplstats.interval * CC2420_LPL_CYCLES_PER_MS;
+}
+
+//-------------------------------------------------------------------------
+bool cc2420lplm_trainActive(void)
+{
+    if ((!lpltrain) || (lplstats.interval == 0))
+    {
+        return FALSE;
+    }
+    //past this a train that has not ended is stuck, and the radio is restored as for any other packet
+    return cc2420lplm_elapsed(lpltrainstart) <
+        ((uint32_t) lplstats.interval + CC2420_LPL_LISTEN_TIME) *
+        CC2420_LPL_CYCLES_PER_MS;
+}
+
+//-------------------------------------------------------------------------
+void cc2420lplm_sendDone(void)
+{
+    if (!lpltrain)
+    {
+        return;
+    }
+    lpltrain = FALSE;
+    if (lplstats.interval != 0)
+    {
+        cc2420lplm_addTime(&lplstats.sendtime, &lplsendrest,
+                           lpltrainstart);
+        //replies come soon after a packet, so the receiver stays on for a while
+        GenericTimerStart(CC2420_LPL_TIMER, TIMER_ONE_SHOT,
+                          CC2420_LPL_LISTEN_TIME);
+    }
+}
+
+//-------------------------------------------------------------------------
+bool cc2420lplm_isDuplicate(Radio_MsgPtr msg)
+{
+    uint8_t i;
+    cc2420lplm_recent *recent;
+
+    if (lplstats.interval == 0)
+    {
+        return FALSE;
+    }
+    GenericTimerStart(CC2420_LPL_TIMER, TIMER_ONE_SHOT,
+                      CC2420_LPL_LISTEN_TIME);
+    //a damaged frame is dropped by the AM layer, and must not hide the good copies after it
+    if (!msg->crc)
+    {
+        return FALSE;
+    }
+    //copies of one packet come within the interval of its train
+    for (i = 0; i < lplrecentcount; i++)
+    {
+        recent = &lplrecent[i];
+        if ((msg->dsn == recent->dsn) && (msg->addr == recent->addr)
+            && (msg->port == recent->port) && (msg->length == recent->length)
+            && (cc2420lplm_elapsed(recent->time) <
+                (uint32_t) lplstats.interval * CC2420_LPL_CYCLES_PER_MS))
+        {
+            lplstats.duplicates++;
+            return TRUE;
+        }
+    }
+    recent = &lplrecent[lplrecentnext];
+    recent->addr = msg->addr;
+    recent->port = msg->port;
+    recent->dsn = msg->dsn;
+    recent->length = msg->length;
+    recent->time = getCurrentResolution();
+    lplrecentnext = (lplrecentnext + 1) % CC2420_LPL_RECENT;
+    if (lplrecentcount < CC2420_LPL_RECENT)
+    {
+        lplrecentcount++;
+    }
+    return FALSE;
+}
+
+//-------------------------------------------------------------------------
+void cc2420lplm_received(void)
+{
+    lplstats.received++;
+}
+
+//-------------------------------------------------------------------------
+void cc2420lplm_timerFired(void)
+{
+    //with an interval the timer fires at least once an interval while the receiver is on
+    cc2420lplm_foldOnTime();
+    if (lplstats.interval == 0)
+    {
+        return;
+    }
+    if (lplstate == CC2420_LPL_AWAKE)
+    {
+        cc2420lplm_sleep();
+        return;
+    }
+    lplstats.checks++;
+    cc2420lplm_wake();
+    if (LITE_READ_RADIO_CCA_PIN() && !LITE_READ_CC_FIFOP_PIN())
+    {
+        cc2420lplm_sleep();
+        return;
+    }
+    lplstats.wakeups++;
+    GenericTimerStart(CC2420_LPL_TIMER, TIMER_ONE_SHOT,
+                      CC2420_LPL_LISTEN_TIME);
+}
+
+//-------------------------------------------------------------------------
+cc2420lplm_stats *cc2420lplm_getStats(void)
+{
+    cc2420lplm_foldOnTime();
+    return &lplstats;
+}
@@ -0,0 +1,124 @@
+/** @file cc2420lplm.h
+       @brief The declarations of the low-power listening module for cc2420. 
+
+	In low-power listening the receiver is off most of the time, and turned on every check interval just long enough
+	to sample the channel. A packet is sent as a train of copies of its frame lasting one check interval, so every
+	neighbour finds the channel busy at one of its checks and stays on until it has received a copy.
+*/
+
+#ifndef CC2420LPLMH
+#define CC2420LPLMH
+#include "../../types/types.h"
+#include "../radio/amcommon.h"
+
+/** \addtogroup radiocc2420 */
+/** @{ */
+
+/** @brief The generic timer of the low-power listening module. */
+#define CC2420_LPL_TIMER 17
+
+/** @brief The check interval in milliseconds the radio starts with, 0 to keep the receiver on. */
+#ifndef CC2420_LPL_INTERVAL
+#define CC2420_LPL_INTERVAL 0
+#endif
+
+/** @brief How long in milliseconds the receiver stays on after finding the channel busy, or after a packet. */
+#ifndef CC2420_LPL_LISTEN_TIME
+#define CC2420_LPL_LISTEN_TIME 20
+#endif
+
+/** @brief The CPU cycles of a millisecond, in which the time stamps of the counters are taken. */
+#ifndef CC2420_LPL_CYCLES_PER_MS
+#define CC2420_LPL_CYCLES_PER_MS 7373
+#endif
+
+/** @brief How often in milliseconds the time of a receiver that stays on is added up, well within the 339 seconds after which the cycle counter wraps. */
+#ifndef CC2420_LPL_FOLD_TIME
+#define CC2420_LPL_FOLD_TIME 60000
+#endif
+
+/** @brief The counters of the low-power listening module.
+	The energy spent per delivered packet is ontime over received, and the latency added to a packet is the time of
+	its train, which sendtime sums over the trains.
+*/
+typedef struct
+{
+    /// the check interval in milliseconds, 0 if the receiver is always on
+    uint16_t interval;
+    /// channel checks
+    uint16_t checks;
+    /// checks that found the channel busy and kept the receiver on
+    uint16_t wakeups;
+    /// packets sent as trains
+    uint16_t trains;
+    /// frames sent in trains, the first copies included
+    uint16_t copies;
+    /// packets that passed the checks of the AM layer and were delivered
+    uint16_t received;
+    /// further copies of a received packet, which are dropped
+    uint16_t duplicates;
+    /// milliseconds with the receiver or the transmitter on
+    uint32_t ontime;
+    /// milliseconds from the start of each train to its end
+    uint32_t sendtime;
+} cc2420lplm_stats;
+
+/** @brief Note that the radio is on, and start checking the channel if an interval is set.
+	@return Void.
+*/
+void cc2420lplm_radioStarted(void);
+
+/** @brief Set the check interval.
+	@param interval The interval in milliseconds, or 0 to keep the receiver on.
+	@return Void.
+*/
+void cc2420lplm_setInterval(uint16_t interval);
+
+/** @brief Turn the receiver on if it is off.
+	@return Void.
+*/
+void cc2420lplm_wake(void);
+
+/** @brief Start the train of a packet handed over for sending.
+	@return Void.
+*/
+void cc2420lplm_startTrain(void);
+
+/** @brief Count a frame that has been sent, and tell whether the train goes on.
+	@return TRUE if the frame must be sent again.
+*/
+bool cc2420lplm_trainContinues(void);
+
+/** @brief Tell whether a train is still within the time it may take, one interval and a listen window for the last copy.
+	@return TRUE while the packet is legitimately kept by the driver.
+*/
+bool cc2420lplm_trainActive(void);
+
+/** @brief End the train of a packet, sent or failed.
+	@return Void.
+*/
+void cc2420lplm_sendDone(void);
+
+/** @brief Check whether a received frame is another copy of one of the last packets passed up, which are told apart by their sequence number, destination, port and length.
+	@param msg The received message.
+	@return TRUE if the frame is dropped.
+*/
+bool cc2420lplm_isDuplicate(Radio_MsgPtr msg);
+
+/** @brief Count a packet the AM layer has accepted, with a good CRC and addressed to this node.
+	@return Void.
+*/
+void cc2420lplm_received(void);
+
+/** @brief Check the channel, or turn the receiver off at the end of a listen window. Without an interval, only add up the time the receiver is on.
+	@return Void.
+*/
+void cc2420lplm_timerFired(void);
+
+/** @brief Get the counters, with the time the radio is on brought up to date.
+	@return The counters.
+*/
+cc2420lplm_stats *cc2420lplm_getStats(void);
+
+/** @} */
+#endif
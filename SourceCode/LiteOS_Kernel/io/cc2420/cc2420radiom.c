@@ -10,6 +10,7 @@
 
 #include "cc2420const.h"
 #include "cc2420controlm.h"
+#include "cc2420lplm.h"
 #include "cc2420radiom.h"
 #include "hplcc2420fifom.h"
 #include "hplcc2420interruptm.h"
@@ -37,17 +38,6 @@ uint8_t cc2420radiom_txlength;
 Radio_MsgPtr cc2420radiom_txbufptr;
 Radio_MsgPtr cc2420radiom_rxbufptr;
 Radio_Msg cc2420radiom_RxBuf;
- 
-enum cc2420radiom___nesc_unnamed4269
-{
-    cc2420radiom_DISABLED_STATE = 0, cc2420radiom_DISABLED_STATE_STARTTASK,
-    cc2420radiom_IDLE_STATE, cc2420radiom_TX_STATE, cc2420radiom_TX_WAIT,
-    cc2420radiom_PRE_TX_STATE, cc2420radiom_POST_TX_STATE,
-    cc2420radiom_POST_TX_ACK_STATE, cc2420radiom_RX_STATE,
-    cc2420radiom_POWER_DOWN_STATE, cc2420radiom_WARMUP_STATE,
-    cc2420radiom_TIMER_INITIAL = 0, cc2420radiom_TIMER_BACKOFF,
-    cc2420radiom_TIMER_ACK
-};
 
 
 inline result_t cc2420radiom_SplitControl_default_initDone(void)
@@ -216,6 +206,30 @@ inline void cc2420radiom_sendPacket(void)
     }
 }
 
+//-------------------------------------------------------------------------
+//send the frame still in the TX FIFO again; the train holds the channel, so there is no clear channel check
+inline void cc2420radiom_resendPacket(void)
+{
+    uint8_t status;
+
+    {
+        _atomic_t _atomic = _atomic_start();
+
+        cc2420radiom_stateRadio = cc2420radiom_TX_STATE;
+        _atomic_end(_atomic);
+    }
+    cc2420radiom_HPLChipcon_cmd(0x04);
+    status = cc2420radiom_HPLChipcon_cmd(0x00);
+    if ((status >> 3) & 0x01)
+    {
+        cc2420radiom_SFD_enableCapture(TRUE);
+    }
+    else
+    {
+        cc2420radiom_sendFailed();
+    }
+}
+
 //-------------------------------------------------------------------------
 inline void cc2420radiom_tryToSend(void)
 {
@@ -301,6 +315,7 @@ inline result_t cc2420radiom_Send_send(Radio_MsgPtr pMsg)
 
      if (currentstate == cc2420radiom_IDLE_STATE)
     {
+        cc2420lplm_wake();
         pMsg->fcflo = 0x08;
         if (cc2420radiom_bAckEnable)
         {
@@ -326,6 +341,7 @@ inline result_t cc2420radiom_Send_send(Radio_MsgPtr pMsg)
             cc2420radiom_stateRadio = cc2420radiom_PRE_TX_STATE;
             _atomic_end(_atomic);
         }
+        cc2420lplm_startTrain();
         if (!postTask(cc2420radiom_startSend, 5))
         {
             cc2420radiom_sendFailed();
@@ -375,6 +391,7 @@ inline result_t cc2420radiom_CC2420SplitControl_startDone(void)
             cc2420radiom_stateRadio = cc2420radiom_IDLE_STATE;
             _atomic_end(_atomic);
         }
+        cc2420lplm_radioStarted();
     }
     cc2420radiom_SplitControl_startDone();
     return SUCCESS;
@@ -451,7 +468,11 @@ inline void cc2420radiom_PacketRcvd(void)
             pBuf = cc2420radiom_rxbufptr;
         } _atomic_end(_atomic);
     }
-    pBuf = cc2420radiom_Receive_receive((Radio_MsgPtr) pBuf);
+    //a train brings the same frame several times, and only its first copy goes up
+    if (!cc2420lplm_isDuplicate(pBuf))
+    {
+        pBuf = cc2420radiom_Receive_receive((Radio_MsgPtr) pBuf);
+    }
     {
         _atomic_t _atomic = _atomic_start();
 
@@ -572,6 +593,7 @@ inline result_t cc2420radiom_Send_sendDone(Radio_MsgPtr arg_0xa3c3710,
 {
     unsigned char result;
 
+    cc2420lplm_sendDone();
     result = AMStandard_RadioSend_sendDone(arg_0xa3c3710, arg_0xa3c3860);
     return result;
 }
@@ -581,6 +603,11 @@ inline void cc2420radiom_PacketSent(void)
 {
     Radio_MsgPtr pBuf;
 
+    if (cc2420lplm_trainContinues())
+    {
+        cc2420radiom_resendPacket();
+        return;
+    }
     {
         _atomic_t _atomic = _atomic_start();
 
@@ -13,6 +13,17 @@
 #include "../../types/types.h"
 /** \addtogroup radiocc2420 */
 /** @{ */
+
+enum cc2420radiom___nesc_unnamed4269
+{
+    cc2420radiom_DISABLED_STATE = 0, cc2420radiom_DISABLED_STATE_STARTTASK,
+    cc2420radiom_IDLE_STATE, cc2420radiom_TX_STATE, cc2420radiom_TX_WAIT,
+    cc2420radiom_PRE_TX_STATE, cc2420radiom_POST_TX_STATE,
+    cc2420radiom_POST_TX_ACK_STATE, cc2420radiom_RX_STATE,
+    cc2420radiom_POWER_DOWN_STATE, cc2420radiom_WARMUP_STATE,
+    cc2420radiom_TIMER_INITIAL = 0, cc2420radiom_TIMER_BACKOFF,
+    cc2420radiom_TIMER_ACK
+};
 inline result_t cc2420radiom_SplitControl_default_initDone(void);
 inline result_t cc2420radiom_CC2420SplitControl_initDone(void);
 inline result_t cc2420radiom_SplitControl_init(void);
@@ -23,6 +34,7 @@ inline result_t cc2420radiom_StdControl_start(void);
 inline result_t cc2420radiom_SFD_enableCapture(bool arg_0xa41e260);
 inline uint8_t cc2420radiom_HPLChipcon_cmd(uint8_t arg_0xa403928);
 inline void cc2420radiom_sendPacket(void);
+inline void cc2420radiom_resendPacket(void);
 inline void cc2420radiom_tryToSend(void);
 inline result_t cc2420radiom_HPLChipconFIFO_TXFIFODone(uint8_t length,
                                                        uint8_t * data);
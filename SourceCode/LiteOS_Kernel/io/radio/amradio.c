@@ -2,6 +2,10 @@
    @file amradio.c
    @brief Standard radio implementations. 
    
+   Packets to send wait in a bounded queue in the order they were given, and are handed to the radio driver one at
+   a time. The driver reports the end of each through AMStandard_RadioSend_sendDone(), which completes the packet
+   with its callback and hands over the next one, so protocols can queue several packets back to back.
+   
 *  @author Qing Charles Cao (cao@utk.edu)
 */
 
@@ -24,6 +28,7 @@
 #include "../cc2420/hplcc2420interruptm.h"
 #include "../cc2420/hplcc2420m.h"
 #include "../cc2420/hpltimer1.h"
+#include "../cc2420/cc2420lplm.h"
 #endif
 
 #if defined(PLATFORM_AVR) && defined(RADIO_RF230)
@@ -36,7 +41,20 @@
 #endif
 
 bool AMStandard_state;
-Radio_MsgPtr AMStandard_buffer;
+
+typedef struct
+{
+    Radio_MsgPtr msg;
+    AMStandard_sendDoneHandler done;
+} AMStandard_txentry;
+
+//packets waiting for the radio, oldest first; the first one is being sent while AMStandard_state is TRUE
+AMStandard_txentry AMStandard_txqueue[AM_TX_QUEUE_SIZE];
+uint8_t AMStandard_txhead, AMStandard_txcount;
+
+//the first packet is with the driver, which was given AMStandard_txsequence packets so far
+bool AMStandard_txsent;
+uint8_t AMStandard_txsequence, AMStandard_stalledsequence;
  
 uint16_t AMStandard_receive_counter;
 
@@ -62,6 +80,9 @@ inline bool AMStandard_Control_init(void)
 #endif 
 
     AMStandard_state = FALSE;
+    AMStandard_txhead = 0;
+    AMStandard_txcount = 0;
+    AMStandard_txsent = FALSE;
  
     AMStandard_receive_counter = 0;
     return ok2;
@@ -88,14 +109,27 @@ inline bool AMStandard_Control_start(void)
     return ok2;
 }
 
+//-------------------------------------------------------------------------
+void AMStandard_restoreDriver(void)
+{
+#if defined(PLATFORM_AVR) && defined (RADIO_CC2420)
+    restorecc2420state();
+#endif
+
+#if defined(PLATFORM_AVR) && defined (RADIO_RF230)
+   restorerf230state(); 
+#endif
+}
+
 //-------------------------------------------------------------------------
 inline result_t AMStandard_RadioSend_send(Radio_MsgPtr arg_0xa3c31f8)
 {
     unsigned char result;
 
-    //Every time send, restore first. 
+    //Every time send, restore first. The queue hands over a packet only after the last one completed, so only the
+    //driver is reset here. 
     
-    restoreRadioState();
+    AMStandard_restoreDriver();
     
 #if defined(PLATFORM_AVR) && defined(RADIO_CC2420)
     result = cc2420radiom_Send_send(arg_0xa3c31f8);
@@ -108,18 +142,49 @@ inline result_t AMStandard_RadioSend_send(Radio_MsgPtr arg_0xa3c31f8)
     return result;
 }
 
+//-------------------------------------------------------------------------
+//post the send of the first packet unless one is being sent already
+void AMStandard_startNext(void)
+{
+    _atomic_t _atomic = _atomic_start();
+
+    if ((AMStandard_state) || (AMStandard_txcount == 0))
+    {
+        _atomic_end(_atomic);
+        return;
+    }
+    AMStandard_state = TRUE;
+    _atomic_end(_atomic);
+    if (!postTask(AMStandard_sendTask, 20))
+    {
+        //the task queue is full, which failed the send before the queue as well
+        AMStandard_reportSendDone(AMStandard_txqueue[AMStandard_txhead].msg,
+                                  FAIL);
+    }
+}
+
 //-------------------------------------------------------------------------
 inline void AMStandard_sendTask(void)
 {
     result_t ok;
     Radio_MsgPtr buf;
+    _atomic_t _atomic;
 
-    buf = AMStandard_buffer;
+    _atomic = _atomic_start();
+    buf = AMStandard_txqueue[AMStandard_txhead].msg;
+    AMStandard_txsent = TRUE;
+    AMStandard_txsequence++;
+    _atomic_end(_atomic);
     ok = AMStandard_RadioSend_send(buf);
+#if defined(PLATFORM_AVR) && defined(RADIO_RF230)
+    //the RF230 driver sends before it returns and never reports back
+    AMStandard_reportSendDone(buf, ok);
+#else
     if (ok == FAIL)
     {
-        AMStandard_reportSendDone(AMStandard_buffer, FAIL);
+        AMStandard_reportSendDone(buf, FAIL);
     }
+#endif
 }
 
 							 
@@ -130,40 +195,60 @@ inline void AMStandard_sendTask(void)
 result_t AMStandard_SendMsg_send(uint16_t port, uint16_t addr, uint8_t length,
                                  Radio_MsgPtr data)
 {
-	
+    return AMStandard_SendMsg_sendWithDone(port, addr, length, data, NULL);
+}
+
+//-------------------------------------------------------------------------
+result_t AMStandard_SendMsg_sendWithDone(uint16_t port, uint16_t addr,
+                                         uint8_t length, Radio_MsgPtr data,
+                                         AMStandard_sendDoneHandler done)
+{
+    uint8_t i, index;
+    _atomic_t _atomic;
+
 //#ifdef TRACE_ENABLE
   //  addTrace(TRACE_RADIOEVENT_SENDPACKET, 100);
 //#endif
-    if (!AMStandard_state)
+    if (length > DATA_LENGTH)
     {
-        AMStandard_state = TRUE;
-        if (length > DATA_LENGTH)
-        {
-            AMStandard_state = FALSE;
-            return FAIL;
-        }
-        if (!postTask(AMStandard_sendTask, 20))
+        return FAIL;
+    }
+    _atomic = _atomic_start();
+    if (AMStandard_txcount == AM_TX_QUEUE_SIZE)
+    {
+        _atomic_end(_atomic);
+        return FAIL;
+    }
+    //a queued message belongs to the radio until it completes, and its header must not change before
+    for (i = 0; i < AMStandard_txcount; i++)
+    {
+        if (AMStandard_txqueue[(AMStandard_txhead + i) % AM_TX_QUEUE_SIZE].
+            msg == data)
         {
-            {
-            }
-            ;
-            AMStandard_state = FALSE;
+            _atomic_end(_atomic);
             return FAIL;
         }
-        else
-        {
-            //length is the first one that means the actual data length
-            //adr is the next hop id
-            //type is the port
-            //group is manmade result 
-            AMStandard_buffer = data;
-            data->length = length;
-            data->addr = addr;
-            data->port = port;
-        }
-        return SUCCESS;
     }
-    return FAIL;
+    index = (AMStandard_txhead + AMStandard_txcount) % AM_TX_QUEUE_SIZE;
+    AMStandard_txqueue[index].msg = data;
+    AMStandard_txqueue[index].done = done;
+    AMStandard_txcount++;
+    //length is the first one that means the actual data length
+    //adr is the next hop id
+    //type is the port
+    //group is manmade result 
+    data->length = length;
+    data->addr = addr;
+    data->port = port;
+    _atomic_end(_atomic);
+    AMStandard_startNext();
+    return SUCCESS;
+}
+
+//-------------------------------------------------------------------------
+uint8_t AMStandard_SendMsg_queueFree(void)
+{
+    return AM_TX_QUEUE_SIZE - AMStandard_txcount;
 }
 
 //-------------------------------------------------------------------------
@@ -256,6 +341,9 @@ Radio_MsgPtr received(Radio_MsgPtr packet)
         uint16_t port = packet->port;
         Radio_MsgPtr tmp;
 
+	#ifdef RADIO_CC2420
+        cc2420lplm_received();
+	#endif
         tmp = Standard_Receive_Packet(port, packet);
         if (tmp)
         {
@@ -311,24 +399,63 @@ inline result_t AMStandard_RadioSend_sendDone(Radio_MsgPtr msg, result_t
 //-------------------------------------------------------------------------
 result_t AMStandard_reportSendDone(Radio_MsgPtr msg, result_t success)
 {
+    AMStandard_sendDoneHandler done;
+    _atomic_t _atomic;
+
+    _atomic = _atomic_start();
+    //a late report of a packet restoreRadioState() has given up on already
+    if ((!AMStandard_state) || (AMStandard_txcount == 0)
+        || (AMStandard_txqueue[AMStandard_txhead].msg != msg))
+    {
+        _atomic_end(_atomic);
+        return FAIL;
+    }
+    done = AMStandard_txqueue[AMStandard_txhead].done;
+    AMStandard_txhead = (AMStandard_txhead + 1) % AM_TX_QUEUE_SIZE;
+    AMStandard_txcount--;
+    AMStandard_txsent = FALSE;
     AMStandard_state = FALSE;
+    _atomic_end(_atomic);
+    if (done)
+    {
+        done(msg, success);
+    }
     //  AMStandard_SendMsg_sendDone(msg->port, msg, success);
     //  AMStandard_sendDone();
+    AMStandard_startNext();
     return SUCCESS;
 }
 
 //-------------------------------------------------------------------------
 inline void restoreRadioState()
 {
-    AMStandard_state = FALSE;
-#if defined(PLATFORM_AVR) && defined (RADIO_CC2420)
-    restorecc2420state();
-#endif
+    bool stalled;
+    _atomic_t _atomic;
 
-#if defined(PLATFORM_AVR) && defined (RADIO_RF230)
-   restorerf230state(); 
+    //a packet gets until the next call to complete, so only one the driver has had since the last call is lost
+    _atomic = _atomic_start();
+    stalled = AMStandard_txsent
+        && (AMStandard_txsequence == AMStandard_stalledsequence);
+#if defined(PLATFORM_AVR) && defined(RADIO_CC2420)
+    //a strobed train keeps the packet with the driver for a whole check interval
+    if (cc2420lplm_trainActive())
+    {
+        stalled = FALSE;
+    }
 #endif
-
+    AMStandard_stalledsequence = AMStandard_txsequence;
+    if ((AMStandard_state) && (!stalled))
+    {
+        _atomic_end(_atomic);
+        return;
+    }
+    _atomic_end(_atomic);
+    AMStandard_restoreDriver();
+    if (stalled)
+    {
+        AMStandard_reportSendDone(AMStandard_txqueue[AMStandard_txhead].msg,
+                                  FAIL);
+    }
 }
 
 
@@ -13,6 +13,17 @@
 /** @addtogroup radio */
 /** @{ */
 
+/** @brief The number of packets that can wait for the radio, counting the one being sent. */
+#ifndef AM_TX_QUEUE_SIZE
+#define AM_TX_QUEUE_SIZE 4
+#endif
+
+/** @brief Called when a queued packet has been sent, or could not be.
+    The message can be given to the radio again from here.
+*/
+typedef void (*AMStandard_sendDoneHandler) (Radio_MsgPtr msg,
+                                            result_t success);
+
 extern bool AMStandard_state;
 inline bool AMStandard_Control_init(void);
 inline result_t AMStandard_socketradiocontrol_start(void);
@@ -23,6 +34,24 @@ inline void AMStandard_sendTask(void);
 result_t AMStandard_SendMsg_send(uint16_t port, uint16_t addr, uint8_t length,
                                  Radio_MsgPtr data);
 
+/** @brief Queue a packet for the radio.
+    The message belongs to the radio until done is called with it, and must not be changed or queued again before.
+    @param port The port.
+    @param addr The next hop, or BCAST_ADDRESS.
+    @param length The length of the payload, at most DATA_LENGTH.
+    @param data The message.
+    @param done The function called when the packet completes, or NULL.
+    @return SUCCESS if the packet was queued, FAIL if it is too long, already queued or the queue is full.
+*/
+result_t AMStandard_SendMsg_sendWithDone(uint16_t port, uint16_t addr,
+                                         uint8_t length, Radio_MsgPtr data,
+                                         AMStandard_sendDoneHandler done);
+
+/** @brief Get the number of packets that can be queued before the queue is full.
+    @return The number of free entries.
+*/
+uint8_t AMStandard_SendMsg_queueFree(void);
+
 inline result_t AMStandard_SendMsg_default_sendDone(uint8_t id, Radio_MsgPtr
                                                     msg, result_t success);
 inline result_t AMStandard_SendMsg_sendDone(uint16_t arg_0xa3b8f90,
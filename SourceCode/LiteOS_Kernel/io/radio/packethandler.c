@@ -2,6 +2,15 @@
    @file packethandler.c
    @brief Implementatio for standard sockdet for receiving packets. 
    
+   A handle registered without a data buffer takes its packets by pointer. Such packets are queued in a pool of
+   receive buffers until the thread takes them, and go back to the pool when it releases them. On the CC2420 the
+   buffer the driver received into is queued as it is, and a free one of the pool is given back to the driver in its
+   place, so the packet is never copied and the next one cannot overwrite it.
+
+   Ports are found through a hashed table with open addressing, and each entry links the handles listening to its
+   port, so every one of them gets the packet. An entry whose handles are all gone stays in the table, keeping its
+   counters, until another port takes it over.
+   
 *  @author Qing Charles Cao (cao@utk.edu)
 */
 
@@ -15,6 +24,34 @@
 //the handles definition
 radio_receiving_buffer receivehandles[RECEIVE_HANDLE_NUM];
 
+//the next handle listening to the same port, RECEIVE_HANDLE_NUM at the end
+static uint8_t handlenext[RECEIVE_HANDLE_NUM];
+
+static radio_port_entry porttable[RECEIVE_PORT_NUM];
+
+//only the CC2420 driver receives the next packet into the buffer it is given back
+#if defined(PLATFORM_AVR) && defined(RADIO_CC2420)
+#define RX_SWAP_BUFFERS TRUE
+#else
+#define RX_SWAP_BUFFERS FALSE
+#endif
+
+//the driver always owns one buffer, and each of the others is free, queued or taken 
+static Radio_Msg rxpool[RADIO_RX_POOL_SIZE];
+static Radio_MsgPtr rxfree[RADIO_RX_POOL_SIZE];
+static uint8_t rxfreecount;
+
+//queued packets, oldest first, and the handle of each
+static Radio_MsgPtr rxqueue[RADIO_RX_POOL_SIZE];
+static uint8_t rxqueuehandle[RADIO_RX_POOL_SIZE];
+
+//taken packets, and the dataReady of the handle that took each, which lies in the memory of its thread
+static Radio_MsgPtr rxheld[RADIO_RX_POOL_SIZE];
+static uint8_t *rxheldowner[RADIO_RX_POOL_SIZE];
+
+//depth and held count the queued and the taken packets
+static radio_receive_stats rxstats;
+
 #ifdef VER_DEBUG
 Radio_MsgPtr debug; 
 #endif 
@@ -28,9 +65,117 @@ void initRadioHandle()
     {
         receivehandles[i].handlevalid = 0;
     }
+    for (i = 0; i < RECEIVE_PORT_NUM; i++)
+    {
+        porttable[i].used = FALSE;
+    }
+    for (i = 0; i < RADIO_RX_POOL_SIZE; i++)
+    {
+        rxfree[i] = &rxpool[i];
+    }
+    rxfreecount = RADIO_RX_POOL_SIZE;
+    rxstats.received = 0;
+    rxstats.dropped = 0;
+    rxstats.depth = 0;
+    rxstats.maxdepth = 0;
+    rxstats.held = 0;
 	 
 }
 
+//-------------------------------------------------------------------------
+//give the packets queued for a handle back to the pool
+static void dropQueuedPackets(uint8_t handle)
+{
+    uint8_t i, j;
+
+    j = 0;
+    for (i = 0; i < rxstats.depth; i++)
+    {
+        if (rxqueuehandle[i] == handle)
+        {
+            rxfree[rxfreecount++] = rxqueue[i];
+        }
+        else
+        {
+            rxqueue[j] = rxqueue[i];
+            rxqueuehandle[j] = rxqueuehandle[i];
+            j++;
+        }
+    }
+    rxstats.depth = j;
+}
+
+//-------------------------------------------------------------------------
+static uint8_t portHash(uint16_t port)
+{
+    return (uint8_t) (port ^ (port >> 8)) & (RECEIVE_PORT_NUM - 1);
+}
+
+//-------------------------------------------------------------------------
+//the entry of a port, or RECEIVE_PORT_NUM if it has none; with create, a port without one takes an entry
+static uint8_t findPort(uint16_t port, bool create)
+{
+    uint8_t i, index, idle;
+
+    idle = RECEIVE_PORT_NUM;
+    index = portHash(port);
+    for (i = 0; i < RECEIVE_PORT_NUM; i++)
+    {
+        if (!porttable[index].used)
+        {
+            break;
+        }
+        if (porttable[index].port == port)
+        {
+            return index;
+        }
+        if ((idle == RECEIVE_PORT_NUM) && (porttable[index].subscribers == 0))
+        {
+            idle = index;
+        }
+        index = (index + 1) & (RECEIVE_PORT_NUM - 1);
+    }
+    if (!create)
+    {
+        return RECEIVE_PORT_NUM;
+    }
+    //an entry is never emptied, so the ports behind it on the probe are still found
+    if (idle == RECEIVE_PORT_NUM)
+    {
+        if (i == RECEIVE_PORT_NUM)
+        {
+            return RECEIVE_PORT_NUM;
+        }
+        idle = index;
+    }
+    porttable[idle].port = port;
+    porttable[idle].delivered = 0;
+    porttable[idle].dropped = 0;
+    porttable[idle].subscribers = 0;
+    porttable[idle].first = RECEIVE_HANDLE_NUM;
+    porttable[idle].used = TRUE;
+    return idle;
+}
+
+//-------------------------------------------------------------------------
+static void removeHandle(uint8_t handle)
+{
+    uint8_t entry;
+    uint8_t *link;
+
+    entry = findPort(receivehandles[handle].port, FALSE);
+    link = &porttable[entry].first;
+    while (*link != handle)
+    {
+        link = &handlenext[*link];
+    }
+    *link = handlenext[handle];
+    porttable[entry].subscribers--;
+    receivehandles[handle].handlevalid = 0;
+    receivehandles[handle].port = 0;
+    dropQueuedPackets(handle);
+}
+
 //Register A New Handle
 //supply the following :
 //the port listening to
@@ -43,35 +188,109 @@ void registerEvent(uint16_t port, uint8_t maxLength, uint8_t * dataReady,
                    uint8_t * data, uint8_t * packetinfo,
                    void (*handlefunc) (void))
 {
-    uint8_t i;
+    uint8_t i, entry;
+    _atomic_t _atomic = _atomic_start();
 
-    for (i = 0; i < RECEIVE_HANDLE_NUM; i++)
-        if (receivehandles[i].handlevalid == 0)
-        {
-            receivehandles[i].port = port;
-            receivehandles[i].maxLength = maxLength;
-            receivehandles[i].dataReady = dataReady;
-            receivehandles[i].data = data;
-            receivehandles[i].packetinfo = packetinfo;
-            receivehandles[i].handlefunc = handlefunc;
-            receivehandles[i].handlevalid = 1;
+    entry = findPort(port, TRUE);
+    if (entry == RECEIVE_PORT_NUM)
+    {
+        _atomic_end(_atomic);
+        return;
+    }
+    //a thread registers again every time it waits for a packet, which must not take another handle
+    for (i = porttable[entry].first; i < RECEIVE_HANDLE_NUM; i = handlenext[i])
+    {
+        if (receivehandles[i].dataReady == dataReady)
+        {
+            break;
+        }
+    }
+    if (i == RECEIVE_HANDLE_NUM)
+    {
+        for (i = 0; i < RECEIVE_HANDLE_NUM; i++)
+        {
+            if (receivehandles[i].handlevalid == 0)
+            {
+                break;
+            }
+        }
+        if (i == RECEIVE_HANDLE_NUM)
+        {
+            _atomic_end(_atomic);
             return;
         }
+        handlenext[i] = porttable[entry].first;
+        porttable[entry].first = i;
+        porttable[entry].subscribers++;
+    }
+    receivehandles[i].port = port;
+    receivehandles[i].maxLength = maxLength;
+    receivehandles[i].dataReady = dataReady;
+    receivehandles[i].data = data;
+    receivehandles[i].packetinfo = packetinfo;
+    receivehandles[i].handlefunc = handlefunc;
+    receivehandles[i].handlevalid = 1;
+    _atomic_end(_atomic);
 }
 
 //-------------------------------------------------------------------------
-void deRegisterEvent(uint16_t port)
+void deRegisterEvent(uint16_t port, uint8_t * dataReady)
 {
-    uint8_t i;
+    uint8_t i, entry;
+    _atomic_t _atomic = _atomic_start();
 
-    for (i = 0; i < RECEIVE_HANDLE_NUM; i++)
-        if ((receivehandles[i].handlevalid == 1) && (receivehandles[i].port
-                                                     == port))
+    entry = findPort(port, FALSE);
+    if (entry == RECEIVE_PORT_NUM)
+    {
+        _atomic_end(_atomic);
+        return;
+    }
+    //the other handles of the port belong to other subscribers, and are left alone
+    for (i = porttable[entry].first; i < RECEIVE_HANDLE_NUM; i = handlenext[i])
+    {
+        if (receivehandles[i].dataReady == dataReady)
         {
-            receivehandles[i].handlevalid = 0;
-            receivehandles[i].port = 0;
-            return;
+            removeHandle(i);
+            break;
         }
+    }
+    _atomic_end(_atomic);
+}
+
+//-------------------------------------------------------------------------
+//queue a packet for a handle without a data buffer; the buffer to give back to the caller is left in packet
+static bool queuePacket(uint8_t handle, Radio_MsgPtr * packet, bool swap)
+{
+    Radio_MsgPtr fresh;
+    _atomic_t _atomic = _atomic_start();
+
+    rxstats.received++;
+    if (rxfreecount == 0)
+    {
+        //the packets before it have not been released yet, and are not written over
+        rxstats.dropped++;
+        _atomic_end(_atomic);
+        return FALSE;
+    }
+    fresh = rxfree[--rxfreecount];
+    if (swap)
+    {
+        rxqueue[rxstats.depth] = *packet;
+        *packet = fresh;
+    }
+    else
+    {
+        *fresh = **packet;
+        rxqueue[rxstats.depth] = fresh;
+    }
+    rxqueuehandle[rxstats.depth] = handle;
+    rxstats.depth++;
+    if (rxstats.depth > rxstats.maxdepth)
+    {
+        rxstats.maxdepth = rxstats.depth;
+    }
+    _atomic_end(_atomic);
+    return TRUE;
 }
 
 
@@ -79,58 +298,189 @@ void deRegisterEvent(uint16_t port)
 
 
 //Now this OS has a new packet, needs to deliver it to the correct thread for processing, and return the packet as soon as possible 
+static void deliverToHandle(uint8_t entry, uint8_t i, Radio_MsgPtr * packet,
+                            bool swap)
+{
+    uint8_t temp;
+    uint8_t j;
+    uint8_t *buf;
+
+    if (receivehandles[i].data == NULL)
+    {
+        temp = (*packet)->length;
+        if (!queuePacket(i, packet, swap))
+        {
+            porttable[entry].dropped++;
+            return;
+        }
+    }
+    else
+    {
+        buf = (uint8_t *) receivehandles[i].data;
+        temp =
+            ((*packet)->length >
+             (receivehandles[i].maxLength) ? (receivehandles[i].
+                                              maxLength) : (*packet)->length);
+        for (j = 0; j < temp; j++)
+        {
+            *buf = (*packet)->data[j];
+            buf++;
+        }
+        if (receivehandles[i].packetinfo != NULL)
+        {
+            buf = (uint8_t *) receivehandles[i].packetinfo;
+            *buf = (*packet)->strength;
+            buf++;
+            *buf = (*packet)->lqi;
+        }
+    }
+    porttable[entry].delivered++;
+    if (receivehandles[i].handlefunc != NULL)
+    {
+        postTask(receivehandles[i].handlefunc, 6);
+    }
+    //if (*(receivehandles[i].dataReady) == 0) 
+    *(receivehandles[i].dataReady) = temp;
+}
+
+//-------------------------------------------------------------------------
+static Radio_MsgPtr deliverPacket(uint16_t port, Radio_MsgPtr packet,
+                                  bool swap)
+{
+    uint8_t i, entry, last;
+
+#ifdef VER_DEBUG
+    debug = packet; 
+#endif 
+    entry = findPort(port, FALSE);
+    if (entry == RECEIVE_PORT_NUM)
+    {
+        return packet;
+    }
+    if (porttable[entry].subscribers == 0)
+    {
+        porttable[entry].dropped++;
+        return packet;
+    }
+    //the buffer can be given away only once, and only after every other handle has read it
+    last = RECEIVE_HANDLE_NUM;
+    for (i = porttable[entry].first; i < RECEIVE_HANDLE_NUM; i = handlenext[i])
+    {
+        if (receivehandles[i].data != NULL)
+        {
+            deliverToHandle(entry, i, &packet, FALSE);
+            continue;
+        }
+        if (last != RECEIVE_HANDLE_NUM)
+        {
+            deliverToHandle(entry, last, &packet, FALSE);
+        }
+        last = i;
+    }
+    if (last != RECEIVE_HANDLE_NUM)
+    {
+        deliverToHandle(entry, last, &packet, swap);
+    }
+    return packet;
+}
+
+//-------------------------------------------------------------------------
 Radio_MsgPtr Standard_Receive_Packet(uint16_t port, Radio_MsgPtr packet)
 {
-    uint8_t i;
+    return deliverPacket(port, packet, RX_SWAP_BUFFERS);
+}
 
-  
-		 
-    for (i = 0; i < RECEIVE_HANDLE_NUM; i++)
+//-------------------------------------------------------------------------
+void Standard_Receive_LocalPacket(uint16_t port, Radio_MsgPtr packet)
+{
+    deliverPacket(port, packet, FALSE);
+}
+
+//-------------------------------------------------------------------------
+Radio_MsgPtr takeReceivedPacket(uint16_t port, uint8_t * dataReady)
+{
+    Radio_MsgPtr packet;
+    uint8_t i, handle;
+    _atomic_t _atomic = _atomic_start();
+
+    for (i = 0; i < rxstats.depth; i++)
     {
-		#ifdef VER_DEBUG
-		debug = packet; 
-		#endif 
-		
-        if ((receivehandles[i].port == port)
-            && (receivehandles[i].handlevalid == 1))
-        {
-            uint8_t temp;
-            uint8_t j;
-            uint8_t *buf;
-
-            buf = (uint8_t *) receivehandles[i].data;
-            temp =
-                (packet->length >
-                 (receivehandles[i].maxLength) ? (receivehandles[i].
-                                                  maxLength) : packet->length);
-            for (j = 0; j < temp; j++)
-            {
-                *buf = packet->data[j];
-                buf++;
-            }
-            if (receivehandles[i].packetinfo != NULL)
-            {
-                buf = (uint8_t *) receivehandles[i].packetinfo;
-                *buf = packet->strength;
-                buf++;
-                *buf = packet->lqi;
-            }
-            if (receivehandles[i].handlefunc != NULL)
-            {
-                postTask(receivehandles[i].handlefunc, 6);
-            }
-            //if (*(receivehandles[i].dataReady) == 0) 
-            *(receivehandles[i].dataReady) = temp;
-            return packet;
+        handle = rxqueuehandle[i];
+        if ((receivehandles[handle].port == port)
+            && (receivehandles[handle].dataReady == dataReady))
+        {
+            break;
         }
     }
+    if (i == rxstats.depth)
+    {
+        _atomic_end(_atomic);
+        return NULL;
+    }
+    packet = rxqueue[i];
+    rxheld[rxstats.held] = packet;
+    rxheldowner[rxstats.held] = dataReady;
+    rxstats.held++;
+    for (; i + 1 < rxstats.depth; i++)
+    {
+        rxqueue[i] = rxqueue[i + 1];
+        rxqueuehandle[i] = rxqueuehandle[i + 1];
+    }
+    rxstats.depth--;
+    _atomic_end(_atomic);
     return packet;
 }
 
+//-------------------------------------------------------------------------
+void releaseReceivedPacket(Radio_MsgPtr packet)
+{
+    uint8_t i;
+    _atomic_t _atomic = _atomic_start();
+
+    for (i = 0; i < rxstats.held; i++)
+    {
+        if (rxheld[i] == packet)
+        {
+            break;
+        }
+    }
+    //a buffer that is not taken, or is released twice, must not enter the pool
+    if (i == rxstats.held)
+    {
+        _atomic_end(_atomic);
+        return;
+    }
+    rxfree[rxfreecount++] = packet;
+    rxstats.held--;
+    rxheld[i] = rxheld[rxstats.held];
+    rxheldowner[i] = rxheldowner[rxstats.held];
+    _atomic_end(_atomic);
+}
+
+//-------------------------------------------------------------------------
+radio_receive_stats *getRadioReceiveStats()
+{
+    return &rxstats;
+}
+
+//-------------------------------------------------------------------------
+radio_port_entry *getRadioPortStats(uint16_t port)
+{
+    uint8_t entry;
+
+    entry = findPort(port, FALSE);
+    if (entry == RECEIVE_PORT_NUM)
+    {
+        return NULL;
+    }
+    return &porttable[entry];
+}
+
 //-------------------------------------------------------------------------
 void deleteThreadRegistrationInReceiverHandles(uint8_t * start, uint8_t * end)
 {
     uint8_t i;
+    _atomic_t _atomic = _atomic_start();
 
     for (i = 0; i < RECEIVE_HANDLE_NUM; i++)
     {
@@ -138,8 +488,24 @@ void deleteThreadRegistrationInReceiverHandles(uint8_t * start, uint8_t * end)
             && (receivehandles[i].dataReady <= end)
             && (receivehandles[i].dataReady >= start))
         {
-            receivehandles[i].handlevalid = 0;
-            receivehandles[i].port = 0;
+            removeHandle(i);
+        }
+    }
+    //the packets a thread has taken go back with it
+    i = 0;
+    while (i < rxstats.held)
+    {
+        if ((rxheldowner[i] <= end) && (rxheldowner[i] >= start))
+        {
+            rxfree[rxfreecount++] = rxheld[i];
+            rxstats.held--;
+            rxheld[i] = rxheld[rxstats.held];
+            rxheldowner[i] = rxheldowner[rxstats.held];
+        }
+        else
+        {
+            i++;
         }
     }
+    _atomic_end(_atomic);
 }
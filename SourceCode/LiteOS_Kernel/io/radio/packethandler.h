@@ -21,6 +21,16 @@ enum
     RECEIVE_HANDLE_NUM = 5,
 };
 
+/** @brief The number of receive buffers kept for packets delivered by pointer. */
+#ifndef RADIO_RX_POOL_SIZE
+#define RADIO_RX_POOL_SIZE 3
+#endif
+
+/** @brief The number of entries of the port table, a power of 2 above the number of ports listened to at once. */
+#ifndef RECEIVE_PORT_NUM
+#define RECEIVE_PORT_NUM 8
+#endif
+
 
 /** @brief The packet receiving buffer. */
  typedef struct 
@@ -34,6 +44,29 @@ enum
     void (*handlefunc) (void);
 } radio_receiving_buffer;
 
+/** @brief An entry of the port table, with the counters of its port. */
+typedef struct
+{
+    uint16_t port;
+    /// packets handed to a handle, once for each handle
+    uint16_t delivered;
+    /// packets a handle did not get for want of a receive buffer, or that came with no handle listening
+    uint16_t dropped;
+    uint8_t subscribers;
+    uint8_t first;
+    bool used;
+} radio_port_entry;
+
+/** @brief The statistics of the packets delivered by pointer. */
+typedef struct
+{
+    uint16_t received;
+    uint16_t dropped;
+    uint8_t depth;
+    uint8_t maxdepth;
+    uint8_t held;
+} radio_receive_stats;
+
 
 
 /** @brief Init the radio handle data structure.
@@ -42,6 +75,9 @@ enum
 void initRadioHandle();
 
 /** @brief Allow the user appliation to register a port by providing necessary info.
+	If data is NULL, packets are not copied but queued in the receive buffer pool, and taken with takeReceivedPacket().
+	A registration with the port and dataReady of an existing handle replaces that handle. Every handle of a port gets
+	each packet of it.
 	@param port The port number the application listening to.
 	@param maxLength The maximum number of bytes provided in RAM for the incoming packet.
 	@param dataReady The actual number of bytes will be received. No more than maxLength.
@@ -54,11 +90,12 @@ void registerEvent(uint16_t port, uint8_t maxLength, uint8_t * dataReady,
                    uint8_t * data, uint8_t * packetinfo,
                    void (*handlefunc) (void));
 
-/** @brief Allow the user appliation to register a port by providing necessary info.
+/** @brief Remove the handle a caller registered for a port.
 	@param port The previous port listening to.
+	@param dataReady The dataready byte the handle was registered with, which tells the subscribers of the port apart.
 	@return Void. 
 */
-void deRegisterEvent(uint16_t port);
+void deRegisterEvent(uint16_t port, uint8_t * dataReady);
 
 /** @brief  Called by the Received() which is the called by the coming packet trigger. This is NOT part of the user API.
 	@param port The port number.
@@ -68,8 +105,40 @@ void deRegisterEvent(uint16_t port);
  */
 Radio_MsgPtr Standard_Receive_Packet(uint16_t port, Radio_MsgPtr packet);
 
+/** @brief Deliver a packet whose buffer stays with the caller, such as one sent to the node itself.
+	@param port The port number.
+	@param packet The packet. 
+	@return Void. 
+*/
+void Standard_Receive_LocalPacket(uint16_t port, Radio_MsgPtr packet);
+
+/** @brief Take the oldest packet queued for a handle.
+	The packet belongs to the caller until it is given back with releaseReceivedPacket().
+	@param port The port number of the handle.
+	@param dataReady The dataReady of the handle.
+	@return The packet, or NULL if none is queued. 
+*/
+Radio_MsgPtr takeReceivedPacket(uint16_t port, uint8_t * dataReady);
+
+/** @brief Give a packet taken with takeReceivedPacket() back to the receive buffer pool.
+	@param packet The packet. 
+	@return Void. 
+*/
+void releaseReceivedPacket(Radio_MsgPtr packet);
+
+/** @brief Get the statistics of the packets delivered by pointer.
+	@return The statistics. 
+*/
+radio_receive_stats *getRadioReceiveStats();
+
+/** @brief Get the counters of a port.
+	@param port The port number.
+	@return The entry of the port, or NULL if it was never listened to or its entry was taken over. 
+*/
+radio_port_entry *getRadioPortStats(uint16_t port);
+
 
-/**	@brief Delete all receive handles.
+/**	@brief Delete all receive handles, and the packets queued for them or taken by them.
 	@param start The starting address.
 	@param end The ending address.
 	@return Void. 
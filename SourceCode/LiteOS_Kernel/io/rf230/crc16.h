@@ -21,12 +21,14 @@
 #define CRC_16_H
 /*============================ INCLUDE =======================================*/
 #include "../../types/types.h"
+#include "../../utilities/crc.h"
 
 /*============================ MACROS ========================================*/
-/*============================ TYPDEFS =======================================*/
-/*============================ PROTOTYPES ====================================*/
 #if defined( __ICCAVR__ )
-uint16_t crc_ccitt_update( uint16_t crc, uint8_t data );
+/* The kernel's table-driven CRC gives the same results as avr-libc's. */
+#define crc_ccitt_update( crc, data ) crcCcittUpdate( crc, data )
 #endif /* __ICCAVR__ */
+/*============================ TYPDEFS =======================================*/
+/*============================ PROTOTYPES ====================================*/
 #endif
 /*EOF*/
@@ -177,4 +177,20 @@ void barrier_unblock(uint8_t type, uint8_t id)
   _atomic_end(currentatomic);
 }
 
+//-------------------------------------------------------------------------
+void barrier_unblock_thread(uint8_t index, uint8_t type, uint8_t id)
+{
+  _atomic_t currentatomic;
+
+  currentatomic = _atomic_start();
+  if ((thread_table[index].state == STATE_IO) && 
+    (thread_table[index].data.iostate.type == type) && 
+    (thread_table[index].data.iostate.id == id))
+  {
+    thread_table[index].state = STATE_ACTIVE;
+    postNewThreadTask();
+  }
+  _atomic_end(currentatomic);
+}
+
 
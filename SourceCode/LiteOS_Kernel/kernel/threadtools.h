@@ -53,6 +53,14 @@ int getThreadIndexAddress();
 */
 void barrier_unblock(uint8_t type, uint8_t id); 
 
+/**	@brief Unblock a single thread waiting on a barrier. 
+	@param index The index of the thread in the thread table. 
+	@param type The type of the barrier. 
+	@param id The id of the barrier.
+	@return Void. 
+*/
+void barrier_unblock_thread(uint8_t index, uint8_t type, uint8_t id); 
+
 /** @} */
  
 #endif
@@ -13,11 +13,9 @@
 #include "libeeprom.h"
 #include "../types/types.h"
 
-//Assume that the file system take 0-3199.
+//The kernel takes the whole EEPROM: the file system uses 0-3103, and its metadata, the node configuration and the key-value store the rest
 
-//The remaining 3200-4000 , 25 32-byte locations are provided to store hash data
-
-//And the EEPROM library also allows user to access, read, and write to individual EEPROM locations
+//Applications keep their own data under the keys from 8 to 15, and the kernel refuses raw writes into the EEPROM it owns
 
 
 
@@ -79,10 +77,11 @@ void lib_read_from_eeprom(uint16_t addr, uint16_t nBytes, uint8_t *buffer)
 
 //Turn off the interrupt, access the location, and use system call to implement poll based implementation provided by avr libc
 
-void lib_writeToEEPROM(uint16_t addr, uint16_t nBytes, uint8_t *buffer)
+int lib_write_to_eeprom(uint16_t addr, uint16_t nBytes, uint8_t *buffer)
 {
 
 	_atomic_t currentatomic;
+	int result;
 
 	currentatomic = _atomic_start();
 
@@ -98,10 +97,70 @@ void lib_writeToEEPROM(uint16_t addr, uint16_t nBytes, uint8_t *buffer)
 
     getaddrfp();
 
+    result = eeprominfoaddr-> nBytes == 0 ? 0 : -1;
+
 	_atomic_end(currentatomic);
 
+	return result;
+}
+
+
+
+//Keys go through the key-value store of the kernel, which keeps each value as a record appended to a log instead of at a fixed location
+
+int lib_read_key(uint8_t key, uint8_t nBytes, uint8_t *buffer)
+{
+
+	_atomic_t currentatomic;
+	int length;
+
+	currentatomic = _atomic_start();
+
+    genericByteStorageHandle *eeprominfoaddr;
+    eeprominfoaddr = getCurrentEEPROMInfo();
+
+	void (*getaddrfp)(void) = (void (*)(void))READ_KEY_EEPROM_TASK;
+
+    eeprominfoaddr-> addr = key;
+    eeprominfoaddr-> nBytes = nBytes;
+    eeprominfoaddr-> buffer = buffer;
+
+
+    getaddrfp();
+
+    length = eeprominfoaddr-> nBytes == 0xffff ? -1 : eeprominfoaddr-> nBytes;
 
+	_atomic_end(currentatomic);
+
+	return length;
 }
 
 
 
+
+int lib_write_key(uint8_t key, uint8_t nBytes, uint8_t *buffer)
+{
+
+	_atomic_t currentatomic;
+	int result;
+
+	currentatomic = _atomic_start();
+
+    genericByteStorageHandle *eeprominfoaddr;
+    eeprominfoaddr = getCurrentEEPROMInfo();
+
+	void (*getaddrfp)(void) = (void (*)(void))WRITE_KEY_EEPROM_TASK;
+
+    eeprominfoaddr-> addr = key;
+    eeprominfoaddr-> nBytes = nBytes;
+    eeprominfoaddr-> buffer = buffer;
+
+
+    getaddrfp();
+
+    result = eeprominfoaddr-> nBytes == 0 ? 0 : -1;
+
+	_atomic_end(currentatomic);
+
+	return result;
+}
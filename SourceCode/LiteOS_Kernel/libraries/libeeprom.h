@@ -32,15 +32,15 @@
 		  for (i=0;i<20;i++)
   		 receivedata[i] = i*6; 
 
-		  for (i=3200;i<4000;i+=20)
-	    lib_write_to_eeprom(i, 20, receivedata);
+		  for (i=8;i<16;i++)
+	    lib_write_key(i, 20, receivedata);
 
-	  	for (i=3200;i<4000;i+=20)
+	  	for (i=8;i<16;i++)
 	  	{
 	    for (j=0;j<20;j++)
    		 receivedata[j] = 0; 
 
-			 lib_read_from_eeprom(i, 20, receivedata);
+			 lib_read_key(i, 20, receivedata);
 
 			 serialSend(20, receivedata); 
 	    }
@@ -61,7 +61,7 @@
        @param nBytes The number of bytes read from EEPROM
        @param buffer Pointer to the internal buffer to keep EEPROM data
        @return NONE
-       @note The first 3200 bytes of EEPROM is occupied by the LiteFS file system
+       @note The kernel uses the whole EEPROM, for the LiteFS file system and its metadata, the node configuration and the key-value store
 */
 void lib_read_from_eeprom(uint16_t addr, uint16_t nBytes, uint8_t *buffer);
 
@@ -70,11 +70,30 @@ void lib_read_from_eeprom(uint16_t addr, uint16_t nBytes, uint8_t *buffer);
        @param addr The start address of the EEPROM
        @param nBytes The number of bytes written to EEPROM
        @param buffer Pointer to the internal buffer to retrive data to be written
-       @return NONE
-       @note The first 3200 bytes of EEPROM is occupied by the LiteFS file system
+       @return 0 on success, or -1 if the write overlaps the EEPROM the kernel owns
+       @note The kernel uses the whole EEPROM, for the file system, the node configuration and the key-value store, so it refuses every raw write. Applications keep their data with lib_write_key() instead
 */ 
 
-void lib_write_to_eeprom(uint16_t addr, uint16_t nBytes, uint8_t *buffer);
+int lib_write_to_eeprom(uint16_t addr, uint16_t nBytes, uint8_t *buffer);
+
+
+/** @brief Read the value of a key from the key-value store the kernel keeps in EEPROM
+       @param key The key, from 8 to 15 for applications, as 0 to 7 hold the node configuration
+       @param nBytes The size of the buffer
+       @param buffer Pointer to the buffer to keep the value
+       @return The length of the value, or -1 if the key has no value or it does not fit
+*/
+int lib_read_key(uint8_t key, uint8_t nBytes, uint8_t *buffer);
+
+
+/** @brief Write the value of a key to the key-value store the kernel keeps in EEPROM
+       @param key The key, from 8 to 15, as 0 to 7 hold the node configuration and cannot be written by applications
+       @param nBytes The length of the value, at most 32 bytes, or 0 to remove the key
+       @param buffer Pointer to the value
+       @return 0 on success, or -1 if the store is full or the key or length is out of range
+       @note Nothing is written if the key already has this value
+*/
+int lib_write_key(uint8_t key, uint8_t nBytes, uint8_t *buffer);
 
 /** @} */
 
@@ -93,6 +93,54 @@ void lib_seek_file_syscall()
 
 
 
+void lib_read_record_file_syscall()
+{
+ void (*filefp)() = (void (*)(void))READ_RECORD_FILE_SYSCALL;
+ filefp();
+}
+
+
+
+void lib_map_file_syscall()
+{
+ void (*filefp)() = (void (*)(void))MAP_FILE_SYSCALL;
+ filefp();
+}
+
+
+
+void lib_read_mapped_file_syscall()
+{
+ void (*filefp)() = (void (*)(void))READ_MAPPED_FILE_SYSCALL;
+ filefp();
+}
+
+
+
+void lib_unmap_file_syscall()
+{
+ void (*filefp)() = (void (*)(void))UNMAP_FILE_SYSCALL;
+ filefp();
+}
+
+
+
+void lib_verify_file_syscall()
+{
+ void (*filefp)() = (void (*)(void))VERIFY_FILE_SYSCALL;
+ filefp();
+}
+
+
+
+void lib_create_ring_file_syscall()
+{
+ void (*filefp)() = (void (*)(void))CREATE_RING_FILE_SYSCALL;
+ filefp();
+}
+
+
+
 
 LIB_MYFILE *lib_mfopen(const char *pathname, const char *mode)
 {
@@ -197,6 +245,136 @@ void lib_mfwrite(LIB_MYFILE *fp, void *buffer, int nBytes)
 }
 
 
+int lib_mfreadrecord(LIB_MYFILE *fp, void *buffer, int size)
+{
+   lib_thread** current_thread;
+
+   current_thread = lib_get_current_thread();
+
+   (*current_thread)->filedata.filestate.fileptr = (uint8_t*)fp;
+   (*current_thread)->filedata.filestate.bufferptr = (uint8_t*)buffer;
+   (*current_thread)->filedata.filestate.bytes = size;
+
+   lib_read_record_file_syscall();
+
+   lib_file_barrier_block(7, 5);
+
+   return (int16_t)(*current_thread)->filedata.filestate.bytes;
+}
+
+
+
+int lib_mfcreatering(const char *pathname, int32_t capacity)
+{
+   char *commonpathnameaddr;
+
+   lib_thread** current_thread;
+
+   current_thread = lib_get_current_thread();
+
+   commonpathnameaddr =  lib_get_file_path_address();
+
+   lib_mystrcpy(commonpathnameaddr, pathname);
+
+   (*current_thread)->filedata.filestate.bufferptr = (uint8_t*)&capacity;
+
+   lib_create_ring_file_syscall();
+
+   lib_file_barrier_block(7, 8);
+
+   return (int16_t)(*current_thread)->filedata.filestate.bytes;
+}
+
+
+
+int lib_mfmap(LIB_MYFILE *fp)
+{
+   lib_thread** current_thread;
+
+   current_thread = lib_get_current_thread();
+
+   (*current_thread)->filedata.filestate.fileptr = (uint8_t*)fp;
+
+   lib_map_file_syscall();
+
+   lib_file_barrier_block(7, 6);
+
+   return (int16_t)(*current_thread)->filedata.filestate.bytes;
+}
+
+
+
+int lib_mfmapread(LIB_MYFILE *fp, void *buffer, int nBytes)
+{
+   lib_thread** current_thread;
+   uint8_t *p;
+   int count;
+   uint8_t attempt;
+
+   current_thread = lib_get_current_thread();
+   p = (uint8_t*)buffer;
+
+   while (nBytes > 0)
+   {
+      //a read stays within the page of the cursor
+      count = 256 - (int)(fp->fpos % 256);
+      if (count > nBytes)
+        count = nBytes;
+
+      for (attempt = 0; attempt < 2; attempt++)
+      {
+         (*current_thread)->filedata.filestate.fileptr = (uint8_t*)fp;
+         (*current_thread)->filedata.filestate.bufferptr = p;
+         (*current_thread)->filedata.filestate.bytes = count;
+
+         lib_read_mapped_file_syscall();
+
+         if ((*current_thread)->filedata.filestate.bytes == 0)
+           break;
+
+         //the cursor moved into another page, or the page was taken: map the page at the cursor
+         if ((attempt > 0) || (lib_mfmap(fp) <= 0))
+           return -1;
+      }
+
+      p += count;
+      nBytes -= count;
+   }
+
+   return 0;
+}
+
+
+
+void lib_mfunmap(LIB_MYFILE *fp)
+{
+   lib_thread** current_thread;
+
+   current_thread = lib_get_current_thread();
+
+   (*current_thread)->filedata.filestate.fileptr = (uint8_t*)fp;
+
+   lib_unmap_file_syscall();
+}
+
+
+
+int lib_mfverify(LIB_MYFILE *fp)
+{
+   lib_thread** current_thread;
+
+   current_thread = lib_get_current_thread();
+
+   (*current_thread)->filedata.filestate.fileptr = (uint8_t*)fp;
+
+   lib_verify_file_syscall();
+
+   lib_file_barrier_block(7, 7);
+
+   return (int16_t)(*current_thread)->filedata.filestate.bytes;
+}
+
+
 void lib_mfwrite_withoutlength(LIB_MYFILE *fp, void *buffer)
 {
 
@@ -139,6 +139,59 @@ void lib_mfseek(LIB_MYFILE *fp, int offset, int position);
 
 void lib_mfwrite_withoutlength(LIB_MYFILE *fp, void *buffer);
 
+/** @brief Read the next record from a file opened with mode "l".
+       Writes to a log file are appended as records, which are read back in order from the start of the file. 
+       @param fp The pointer of the previously opened file. 
+       @param buffer The buffer for the record. 
+       @param size The size of the buffer. 
+       @return The length of the record, or -1 at the end of the log.
+*/
+
+int lib_mfreadrecord(LIB_MYFILE *fp, void *buffer, int size);
+
+/** @brief Map the flash page at the position of a file for lib_mfmapread().
+       Reading a large file field by field through lib_mfread() costs a queued request per field. A mapped page is kept in an SRAM buffer of the flash instead, and read from there at once. 
+       One page is mapped at a time for all threads, and lib_mfmapread() maps pages itself as needed, so calling this function first is optional. 
+       @param fp The pointer of the previously opened file. 
+       @return The number of bytes from the file position to the end of the page, 0 at the end of the file, or -1 for a ring file.
+*/
+
+int lib_mfmap(LIB_MYFILE *fp);
+
+/** @brief Read from a file through the mapped page, moving the file position past the bytes read.
+       The position of the file works as a cursor, and the next page is mapped when the cursor reaches it. 
+       @param fp The pointer of the previously opened file. 
+       @param buffer The buffer for the data, such as a single field. 
+       @param nBytes The number of bytes. 
+       @return 0 on success, or -1 if the bytes reach past the end of the file or the file cannot be mapped.
+*/
+
+int lib_mfmapread(LIB_MYFILE *fp, void *buffer, int nBytes);
+
+/** @brief End the mapping of a file, so that writes regain their full speed. Closing the file does so as well.
+       @param fp The pointer of the previously opened file. 
+       @return Void.
+*/
+
+void lib_mfunmap(LIB_MYFILE *fp);
+
+/** @brief Check every page of a file against the CRC stored with it in the flash.
+       A page is checked with a single read of its data, so a whole file can be checked before its data is trusted, such as after a reset. Pages written before the CRCs were kept are not counted. 
+       @param fp The pointer of the previously opened file. 
+       @return The number of corrupted pages, 0 if the file is intact.
+*/
+
+int lib_mfverify(LIB_MYFILE *fp);
+
+/** @brief Create a ring file, which takes all the sectors of its capacity when it is created and then overwrites its oldest bytes once it is full.
+       Writes to a ring never allocate, so it suits logging that must not fail for lack of flash. The fsimage tool makes ring files ahead of time with its ring command. 
+       @param pathname The full path of the new file. 
+       @param capacity The number of bytes the ring holds, rounded up to whole sectors of 2048 bytes.
+       @return 0 on success, -1 if the file exists or the capacity or the free inodes and flash do not allow it.
+*/
+
+int lib_mfcreatering(const char *pathname, int32_t capacity);
+
 /** @}*/
 
 #endif 
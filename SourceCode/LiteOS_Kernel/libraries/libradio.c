@@ -258,6 +258,200 @@ int lib_radio_receive_timed(uint16_t port, uint8_t maxlength, uint8_t *msg, uint
 	return radioReceiveDataReady;
 }
 
+//take the oldest packet queued for the handle of this thread on a port, or NULL
+
+radiopackettype *lib_radio_take_packet(uint16_t port)
+{
+   _atomic_t currentatomic;
+   radiopackettype *packet;
+
+   void (*takefp)(void) = (void (*)(void))TAKE_RADIO_PACKET;
+   radiohandletype *radiohandleaddr = lib_get_current_radio_receive_handle_addr();
+
+   //the handle is told apart from those of other threads on the port by its dataReady
+   currentatomic = _atomic_start();
+   radiohandleaddr->port = port;
+   radiohandleaddr->dataReady = &radioReceiveDataReady;
+   asm volatile("push r20" "\n\t"
+                "push r21" "\n\t"
+                ::);
+   takefp();
+   asm volatile(" mov %A0, r20" "\n\t"
+	             "mov %B0, r21" "\n\t"
+				 :"=r" (packet)
+				 :
+                );
+   asm volatile("pop r21" "\n\t"
+	             "pop r20" "\n\t"
+	              ::);
+   _atomic_end(currentatomic);
+   return packet;
+}
+
+//remove the handle of this thread from a port, with the packets still queued for it
+
+void lib_radio_deregister(uint16_t port)
+{
+   _atomic_t currentatomic;
+
+   void (*deregisterfp)(void) = (void (*)(void))DEREGISTER_RADIO_RECEIVE_EVENT;
+   radiohandletype *radiohandleaddr = lib_get_current_radio_receive_handle_addr();
+
+   currentatomic = _atomic_start();
+   radiohandleaddr->port = port;
+   radiohandleaddr->dataReady = &radioReceiveDataReady;
+   deregisterfp();
+   _atomic_end(currentatomic);
+}
+
+radiopackettype *lib_radio_receive_packet(uint16_t port, uint16_t time)
+{
+   _atomic_t currentatomic;
+   radiopackettype *packet;
+   
+   void (*radio_register_function_pointer)(void) = (void (*)(void))REGISTER_RADIO_RECEIVE_EVENT;
+   lib_thread** current_thread = lib_get_current_thread();
+   radiohandletype *radiohandleaddr = lib_get_current_radio_receive_handle_addr();
+
+   //without a data buffer, the kernel queues the packets instead of copying them
+
+   radiohandleaddr->port = port;
+   radiohandleaddr->maxLength = 0;
+   radiohandleaddr->dataReady = &radioReceiveDataReady;
+   radiohandleaddr->data = NULL;
+   radiohandleaddr->packetinfo = NULL;
+   radiohandleaddr->handlefunc = lib_wakeup_mythread;
+
+	currentatomic = _atomic_start();
+	radio_register_function_pointer();
+
+	//a packet may have been queued while the thread was not waiting
+	packet = lib_radio_take_packet(port);
+	if (packet == NULL)
+	{
+		(*current_thread)->state = STATE_SLEEP;
+		mythread = *current_thread;
+		_atomic_end(currentatomic);
+
+		if (time == 0)
+			lib_yield();
+		else
+			lib_sleep_thread(time);
+
+		currentatomic = _atomic_start();
+		packet = lib_radio_take_packet(port);
+	}
+
+	//the handle would otherwise keep taking receive buffers for packets nobody waits for
+	lib_radio_deregister(port);
+	_atomic_end(currentatomic);
+	return packet;
+}
+
+void lib_radio_release_packet(radiopackettype *packet)
+{
+   void (*releasefp)(void) = (void (*)(void))RELEASE_RADIO_PACKET;
+
+   asm volatile("push r20" "\n\t"
+                "push r21" "\n\t"
+                ::);
+   asm volatile(" mov r20, %A0" "\n\t"
+	              "mov r21, %B0" "\n\t"
+				 :
+				 :"r" (packet)
+                );
+   releasefp();
+   asm volatile("pop r21" "\n\t"
+	             "pop r20" "\n\t"
+	              ::);
+   return;
+}
+
+radioreceivestatstype *lib_radio_get_receive_stats()
+{
+   radioreceivestatstype *stats;
+   void (*getaddrfp)(void) = (void (*)(void))GET_RADIO_RECEIVE_STATS;
+   asm volatile("push r20" "\n\t"
+                "push r21" "\n\t"
+                ::);
+   getaddrfp();
+   asm volatile(" mov %A0, r20" "\n\t"
+	             "mov %B0, r21" "\n\t"
+				 :"=r" (stats)
+				 :
+                );
+    asm volatile("pop r21" "\n\t"
+	             "pop r20" "\n\t"
+	              ::);
+   return stats;
+}
+
+radioportstatstype *lib_radio_get_port_stats(uint16_t port)
+{
+   radioportstatstype *stats;
+
+   void (*getaddrfp)(void) = (void (*)(void))GET_RADIO_PORT_STATS;
+
+   asm volatile("push r20" "\n\t"
+                "push r21" "\n\t"
+                ::);
+   asm volatile(" mov r20, %A0" "\n\t"
+	              "mov r21, %B0" "\n\t"
+				 :
+				 :"r" (port)
+                );
+   getaddrfp();
+   asm volatile(" mov %A0, r20" "\n\t"
+	             "mov %B0, r21" "\n\t"
+				 :"=r" (stats)
+				 :
+                );
+   asm volatile("pop r21" "\n\t"
+	             "pop r20" "\n\t"
+	              ::);
+   return stats;
+}
+
+void lib_radio_set_lpl_interval(uint16_t interval)
+{
+
+  void (*setintervalfp)(void) = (void (*)(void))SET_RADIO_LPL_INTERVAL;
+
+  asm volatile("push r20" "\n\t"
+               "push r21" "\n\t"
+               ::);
+
+  asm volatile(" mov r20, %A0" "\n\t"
+	              "mov r21, %B0" "\n\t"
+				 :
+				 :"r" (interval)
+                );
+   setintervalfp();
+   asm volatile("pop r21" "\n\t"
+	             "pop r20" "\n\t"
+	              ::);
+   return;
+}
+
+radiolplstatstype *lib_radio_get_lpl_stats()
+{
+   radiolplstatstype *stats;
+   void (*getaddrfp)(void) = (void (*)(void))GET_RADIO_LPL_STATS;
+   asm volatile("push r20" "\n\t"
+                "push r21" "\n\t"
+                ::);
+   getaddrfp();
+   asm volatile(" mov %A0, r20" "\n\t"
+	             "mov %B0, r21" "\n\t"
+				 :"=r" (stats)
+				 :
+                );
+    asm volatile("pop r21" "\n\t"
+	             "pop r20" "\n\t"
+	              ::);
+   return stats;
+}
+
 //Get and set the radio lock. Assumed to be called by apps. 
 
 void lib_get_radio_lock(){
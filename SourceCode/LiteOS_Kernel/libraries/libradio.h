@@ -127,6 +127,66 @@ radioinfotype *lib_get_current_radio_send_addr();
 void lib_radio_send_msg_syscall();
 
 
+/**  @brief Take the oldest packet received for this thread on a port without waiting.
+        @param port The port number.
+        @return The packet, or NULL if none is waiting. 
+*/
+radiopackettype *lib_radio_take_packet(uint16_t port);
+
+
+/**  @brief Stop receiving on a port. The packets still queued for this thread on the port are dropped, while those it has taken stay valid until they are released.
+        @param port The port number.
+        @return Void. 
+*/
+void lib_radio_deregister(uint16_t port);
+
+
+/**  @brief Receive a radio message by pointer, without copying it.
+        The packet must be given back with lib_radio_release_packet() once it is consumed. 
+        Packets that arrive while the buffers of the kernel are all taken are dropped, and so are those that arrive while the thread is not waiting, as the thread stops receiving on the port once the call returns.
+        @param port The port number.
+        @param time The waiting time, or 0 to wait until a packet comes. 
+        @return The packet, or NULL if none came in time. 
+*/
+radiopackettype *lib_radio_receive_packet(uint16_t port, uint16_t time);
+
+
+/**  @brief Give a received packet back to the kernel.
+        @param packet The packet. 
+        @return Void. 
+*/
+void lib_radio_release_packet(radiopackettype *packet);
+
+
+/**  @brief Get the statistics of the packets received by pointer. 
+        @return The statistics, kept up to date by the kernel. 
+*/
+radioreceivestatstype *lib_radio_get_receive_stats();
+
+
+/**  @brief Get the counters of a port, shared by every thread listening to it. 
+        @param port The port number.
+        @return The counters, or NULL if the port is not known to the kernel. 
+*/
+radioportstatstype *lib_radio_get_port_stats(uint16_t port);
+
+
+/**  @brief Set the low-power listening check interval. 
+        A longer interval saves energy at the receivers, and makes every packet take that long to send. 
+        @param interval The interval in milliseconds, or 0 to keep the receiver on. 
+        @return Void. 
+*/
+void lib_radio_set_lpl_interval(uint16_t interval);
+
+
+/**  @brief Get the low-power listening counters. 
+        The times are in milliseconds. Energy per delivered packet is ontime over received, and the latency a train
+        adds is sendtime over trains. 
+        @return The counters, or NULL if the radio has no low-power listening. 
+*/
+radiolplstatstype *lib_radio_get_lpl_stats();
+
+
 /** @brief Get the radio lock to operate. May suspend the current thread. 
 	@return void. 
 	
@@ -103,6 +103,34 @@
 
 #define RELEASE_CURRENT_RADIO_LOCK                              0xEC24
 
+//Take a received packet, by pointer 
+
+#define TAKE_RADIO_PACKET                                      0xEC28
+
+//Give a taken packet back 
+
+#define RELEASE_RADIO_PACKET                                   0xEC2C
+
+//Get the receive statistics 
+
+#define GET_RADIO_RECEIVE_STATS                                0xEC30
+
+//Get the counters of a port 
+
+#define GET_RADIO_PORT_STATS                                   0xEC34
+
+//Set the low-power listening check interval 
+
+#define SET_RADIO_LPL_INTERVAL                                 0xEC38
+
+//Get the low-power listening counters 
+
+#define GET_RADIO_LPL_STATS                                    0xEC3C
+
+//Remove the handle of this thread from a port 
+
+#define DEREGISTER_RADIO_RECEIVE_EVENT                         0xEC40
+
 
 
 
@@ -163,6 +191,12 @@
 
 #define WRITE_EEPROM_TASK 											0xED88
 
+//read the value of a key of the key-value store
+#define READ_KEY_EEPROM_TASK 										0xED8C
+
+//write the value of a key of the key-value store
+#define WRITE_KEY_EEPROM_TASK 										0xED90
+
 
 //Definition group 9
 
@@ -190,6 +224,24 @@
 //seek between the file location 
 #define SEEK_FILE_SYSCALL 											0xEE18
 
+//read the next record of a log file
+#define READ_RECORD_FILE_SYSCALL 									0xEE1C
+
+//map the flash page at the position of a file
+#define MAP_FILE_SYSCALL 											0xEE20
+
+//read from the mapped page, served right away rather than queued
+#define READ_MAPPED_FILE_SYSCALL 									0xEE24
+
+//end the mapping of a file
+#define UNMAP_FILE_SYSCALL 											0xEE28
+
+//check the pages of a file against their CRCs
+#define VERIFY_FILE_SYSCALL 										0xEE2C
+
+//create a ring file of a fixed capacity
+#define CREATE_RING_FILE_SYSCALL 									0xEE30
+
 
 //Definition group 10 
  
@@ -239,6 +291,55 @@ typedef struct {
 }radiohandletype;
 
 
+typedef struct {
+  uint8_t length; 
+  uint8_t fcfhi; 
+  uint8_t fcflo; 
+  uint8_t dsn; 
+  uint16_t destpan; 
+  uint16_t addr; 
+  uint16_t port; 
+  int8_t data[100]; 
+  uint8_t strength; 
+  uint8_t lqi; 
+  uint8_t crc; 
+  uint8_t ack; 
+  uint16_t time; 
+}radiopackettype;
+
+
+typedef struct {
+  uint16_t received; 
+  uint16_t dropped; 
+  uint8_t depth; 
+  uint8_t maxdepth; 
+  uint8_t held; 
+}radioreceivestatstype;
+
+
+typedef struct {
+  uint16_t port; 
+  uint16_t delivered; 
+  uint16_t dropped; 
+  uint8_t subscribers; 
+  uint8_t first; 
+  uint8_t used; 
+}radioportstatstype;
+
+
+typedef struct {
+  uint16_t interval; 
+  uint16_t checks; 
+  uint16_t wakeups; 
+  uint16_t trains; 
+  uint16_t copies; 
+  uint16_t received; 
+  uint16_t duplicates; 
+  uint32_t ontime; 
+  uint32_t sendtime; 
+}radiolplstatstype;
+
+
  
 
 typedef struct ecb_block {
@@ -347,7 +448,7 @@ typedef struct
   uint8_t index;
   uint8_t addr;
   uint8_t mode;
-  uint16_t size; 
+  int32_t size; 
   int32_t fpos;
 } LIB_MYFILE;
 
@@ -412,15 +412,26 @@ void reply_ls_long(uint8_t block)
     uint8_t blockindex;
     uint8_t childblock;
     uint8_t seq = 0;
+    uint8_t dirblock;
 
     if (openedfile != NULL)
     {
         //fclose2( openedfile );
         openedfile = NULL;
     }
-    for (blockindex = 0; blockindex < 10; blockindex++)
+    //directories with more than 10 entries continue in chained blocks
+    for (dirblock = block, blockindex = 0; ; blockindex++)
     {
-        childblock = fsread8uint(block, DIR_ADDRSUBOFFSET + blockindex);
+        if (blockindex == 10)
+        {
+            dirblock = fsread8uint(dirblock, DIR_NEXTOFFSET);
+            if (dirblock == 0)
+            {
+                break;
+            }
+            blockindex = 0;
+        }
+        childblock = fsread8uint(dirblock, DIR_ADDRSUBOFFSET + blockindex);
         if (childblock == 0)
         {
             continue;
@@ -967,4 +978,6 @@ void commandHandle(uint8_t * receivebuffer, uint8_t total)
         reply_nodeRestart(receivebuffer);
         break;
     }
+    //shell commands modify the file system directly, so make their changes durable here
+    fsync2();
 }
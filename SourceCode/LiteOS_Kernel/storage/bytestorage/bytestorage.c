@@ -22,6 +22,12 @@ void genericwriteBytes(uint16_t addr, int nBytes, void *buffer)
     eeprom_writeBytes(addr, nBytes, buffer);
 }
 
+//-------------------------------------------------------------------------
+void genericflushBytes()
+{
+    eeprom_flush();
+}
+
 //-------------------------------------------------------------------------
 void initBytes(uint16_t addr, int nBytes, uint8_t value)
 {
@@ -33,6 +33,13 @@ void genericreadBytes(uint16_t addr, int nBytes, void *buffer);
 */
 void genericwriteBytes(uint16_t addr, int nBytes, void *buffer);
 
+/** @ingroup bytestorage 
+	@brief Wait until all written bytes have reached the byte storage.
+	Writes may complete in the background; reads always return the written values. Call this before a point that has to survive a reset.
+	@return Void. 
+*/
+void genericflushBytes();
+
 
 
 /** @ingroup bytestorage 
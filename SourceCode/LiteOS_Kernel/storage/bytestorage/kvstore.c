@@ -0,0 +1,283 @@
+/** @file kvstore.c
+       @brief The functional implementation of the key-value store in the byte storage.
+
+	The region is split into two banks. One bank is active at a time, and holds a header with its generation
+	followed by records appended in order:
+	[key][length][version][value][check]
+	The check is the low byte of the CRC of the rest of the record, and a key of 0xff marks the end of the records.
+	The key of a record is written after the rest of it, so a record becomes part of the log in a single byte write.
+	A key takes the value of its last record, found once by kvInit() and kept in a RAM index afterwards.
+
+	When the active bank fills up, the newest record of every key is copied into the other bank, which becomes
+	active when its header is written with the next generation. Until then a reset leaves the old bank active, so
+	no value is lost, and the writes are spread evenly over both banks.
+*/
+
+#include "kvstore.h"
+#include "bytestorage.h"
+#include "../filesys/storageconstants.h"
+#include "../../utilities/crc.h"
+
+#define KV_BANK_SIZE (KVSTORESIZE / 2)
+#define KV_HEADER_SIZE 3
+#define KV_RECORD_HEADER 3
+#define KV_END 0xff
+
+static uint8_t kvindex[KV_KEYS];        //offset of the newest record of each key in the active bank, 0 if none
+static uint8_t kvbank;          //the active bank
+static uint8_t kvend;           //offset behind the last record of the active bank
+static uint16_t kvgeneration;   //generation of the active bank
+
+//-------------------------------------------------------------------------
+static uint16_t kvBankStart(uint8_t bank)
+{
+    return KVSTORESTART + (uint16_t) bank * KV_BANK_SIZE;
+}
+
+//-------------------------------------------------------------------------
+static uint8_t kvCheck(uint8_t * record, uint8_t length)
+{
+    return (uint8_t) crcCcittBlock(CRC_INIT, record, KV_RECORD_HEADER + length);
+}
+
+//-------------------------------------------------------------------------
+//the generation of a bank, or 0 if its header is not valid
+static uint16_t kvReadHeader(uint8_t bank)
+{
+    uint8_t header[KV_HEADER_SIZE];
+    uint16_t generation;
+
+    genericreadBytes(kvBankStart(bank), KV_HEADER_SIZE, header);
+    generation = header[0] | ((uint16_t) header[1] << 8);
+    if ((header[2] != (uint8_t) (header[0] ^ header[1] ^ 0xa5))
+        || (generation == 0))
+    {
+        return 0;
+    }
+    return generation;
+}
+
+//-------------------------------------------------------------------------
+static void kvWriteHeader(uint8_t bank, uint16_t generation)
+{
+    uint8_t header[KV_HEADER_SIZE];
+
+    header[0] = (uint8_t) generation;
+    header[1] = (uint8_t) (generation >> 8);
+    header[2] = header[0] ^ header[1] ^ 0xa5;
+    genericwriteBytes(kvBankStart(bank), KV_HEADER_SIZE, header);
+}
+
+//-------------------------------------------------------------------------
+//read the record at an offset of the active bank; its length, or -1 at the end of the records
+static int kvReadRecord(uint8_t offset, uint8_t * record)
+{
+    uint8_t length;
+
+    if (offset + KV_RECORD_HEADER + 1 > KV_BANK_SIZE)
+    {
+        return -1;
+    }
+    genericreadBytes(kvBankStart(kvbank) + offset, KV_RECORD_HEADER, record);
+    length = record[1];
+    if ((record[0] >= KV_KEYS) || (length > KV_MAX_VALUE)
+        || (offset + KV_RECORD_HEADER + length + 1 > KV_BANK_SIZE))
+    {
+        return -1;
+    }
+    genericreadBytes(kvBankStart(kvbank) + offset + KV_RECORD_HEADER,
+                     length + 1, record + KV_RECORD_HEADER);
+    //a damaged record ends the log, and the next write goes over it
+    if (record[KV_RECORD_HEADER + length] != kvCheck(record, length))
+    {
+        return -1;
+    }
+    return length;
+}
+
+//-------------------------------------------------------------------------
+static void kvScan()
+{
+    uint8_t record[KV_RECORD_HEADER + KV_MAX_VALUE + 1];
+    uint8_t i;
+    int length;
+
+    for (i = 0; i < KV_KEYS; i++)
+    {
+        kvindex[i] = 0;
+    }
+    kvend = KV_HEADER_SIZE;
+    while ((length = kvReadRecord(kvend, record)) >= 0)
+    {
+        kvindex[record[0]] = length > 0 ? kvend : 0;
+        kvend += KV_RECORD_HEADER + length + 1;
+    }
+}
+
+//-------------------------------------------------------------------------
+//copy the newest record of every key into the other bank and make it the active one
+static void kvCompact()
+{
+    uint8_t record[KV_RECORD_HEADER + KV_MAX_VALUE + 1];
+    uint8_t target, offset, i;
+    int length;
+
+    target = kvbank ^ 1;
+    offset = KV_HEADER_SIZE;
+    for (i = 0; i < KV_KEYS; i++)
+    {
+        if (kvindex[i] == 0)
+        {
+            continue;
+        }
+        length = kvReadRecord(kvindex[i], record);
+        genericwriteBytes(kvBankStart(target) + offset,
+                          KV_RECORD_HEADER + length + 1, record);
+        kvindex[i] = offset;
+        offset += KV_RECORD_HEADER + length + 1;
+    }
+    //records of older generations must not be taken for records of this one
+    initBytes(kvBankStart(target) + offset, KV_BANK_SIZE - offset, KV_END);
+    genericflushBytes();
+    kvgeneration++;
+    if (kvgeneration == 0)
+    {
+        kvgeneration = 1;
+    }
+    kvWriteHeader(target, kvgeneration);
+    kvbank = target;
+    kvend = offset;
+}
+
+//-------------------------------------------------------------------------
+void kvInit()
+{
+    uint16_t first, second;
+
+    first = kvReadHeader(0);
+    second = kvReadHeader(1);
+    if ((first == 0) && (second == 0))
+    {
+        initBytes(kvBankStart(0) + KV_HEADER_SIZE,
+                  KV_BANK_SIZE - KV_HEADER_SIZE, KV_END);
+        kvWriteHeader(0, 1);
+        first = 1;
+    }
+    //generations wrap, so the newer bank is the one the other is behind
+    if ((second == 0)
+        || ((first != 0) && ((int16_t) (first - second) > 0)))
+    {
+        kvbank = 0;
+        kvgeneration = first;
+    }
+    else
+    {
+        kvbank = 1;
+        kvgeneration = second;
+    }
+    kvScan();
+}
+
+//-------------------------------------------------------------------------
+int kvGet(uint8_t key, void *buffer, uint8_t size)
+{
+    uint8_t record[KV_RECORD_HEADER];
+    uint8_t length;
+
+    if ((key >= KV_KEYS) || (kvindex[key] == 0))
+    {
+        return -1;
+    }
+    genericreadBytes(kvBankStart(kvbank) + kvindex[key], KV_RECORD_HEADER,
+                     record);
+    length = record[1];
+    if (length > size)
+    {
+        return -1;
+    }
+    genericreadBytes(kvBankStart(kvbank) + kvindex[key] + KV_RECORD_HEADER,
+                     length, buffer);
+    return length;
+}
+
+//-------------------------------------------------------------------------
+int kvVersion(uint8_t key)
+{
+    if ((key >= KV_KEYS) || (kvindex[key] == 0))
+    {
+        return -1;
+    }
+    return read8uint(kvBankStart(kvbank) + kvindex[key] + 2);
+}
+
+//-------------------------------------------------------------------------
+int kvPut(uint8_t key, const void *buffer, uint8_t length)
+{
+    uint8_t record[KV_RECORD_HEADER + KV_MAX_VALUE + 2];
+    uint8_t old[KV_RECORD_HEADER + KV_MAX_VALUE + 1];
+    uint8_t i, size;
+    int oldlength;
+
+    if ((key >= KV_KEYS) || (length > KV_MAX_VALUE))
+    {
+        return -1;
+    }
+    record[0] = key;
+    record[1] = length;
+    record[2] = 1;
+    for (i = 0; i < length; i++)
+    {
+        record[KV_RECORD_HEADER + i] = ((const uint8_t *)buffer)[i];
+    }
+    oldlength = kvindex[key] > 0 ? kvReadRecord(kvindex[key], old) : -1;
+    if (oldlength >= 0)
+    {
+        //configuration is mostly rewritten with the value it already has
+        for (i = 0; (oldlength == length) && (i < length); i++)
+        {
+            if (old[KV_RECORD_HEADER + i] != record[KV_RECORD_HEADER + i])
+            {
+                break;
+            }
+        }
+        if ((oldlength == length) && (i == length))
+        {
+            return 0;
+        }
+        record[2] = old[2] + 1;
+        if (record[2] == 0)
+        {
+            record[2] = 1;
+        }
+    }
+    else if (length == 0)
+    {
+        return 0;
+    }
+    size = KV_RECORD_HEADER + length + 1;
+    if (kvend + size > KV_BANK_SIZE)
+    {
+        kvCompact();
+        if (kvend + size > KV_BANK_SIZE)
+        {
+            return -1;
+        }
+    }
+    record[KV_RECORD_HEADER + length] = kvCheck(record, length);
+    //the end mark goes with the record, so that nothing left behind it is read as a record
+    if (kvend + size < KV_BANK_SIZE)
+    {
+        record[size] = KV_END;
+        genericwriteBytes(kvBankStart(kvbank) + kvend + 1, size, record + 1);
+    }
+    else
+    {
+        genericwriteBytes(kvBankStart(kvbank) + kvend + 1, size - 1,
+                          record + 1);
+    }
+    //the key replaces the end mark last, as writes reach the EEPROM in order, so a reset never leaves half a record
+    genericwriteBytes(kvBankStart(kvbank) + kvend, 1, record);
+    kvindex[key] = length > 0 ? kvend : 0;
+    kvend += size;
+    return 0;
+}
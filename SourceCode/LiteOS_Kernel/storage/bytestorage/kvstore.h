@@ -0,0 +1,82 @@
+/** @file kvstore.h
+       @brief The functional prototypes of the key-value store in the byte storage.
+	Small values such as the node configuration are kept as records appended to a log in the byte storage, so that
+	changing a value writes a few new bytes instead of rewriting the same location every time.
+*/
+
+#ifndef KVSTOREH
+#define KVSTOREH
+
+#include "../../types/types.h"
+
+/**@defgroup kvstore Key-value store in the byte storage.
+*/
+
+/** @ingroup kvstore
+	@brief The number of keys. Keys range from 0 to KV_KEYS - 1, and each costs one byte of RAM for the index.
+*/
+#define KV_KEYS 16
+
+/** @ingroup kvstore
+	@brief The longest value.
+*/
+#define KV_MAX_VALUE 32
+
+/** @ingroup kvstore
+	@brief The node id, 2 bytes.
+*/
+#define KV_KEY_NODEID 0
+
+/** @ingroup kvstore
+	@brief The radio channel, 1 byte.
+*/
+#define KV_KEY_CHANNEL 1
+
+/** @ingroup kvstore
+	@brief The name of the network the node belongs to, 16 bytes.
+*/
+#define KV_KEY_NETWORKNAME 2
+
+/** @ingroup kvstore
+	@brief The name of the node, 16 bytes.
+*/
+#define KV_KEY_NODENAME 3
+
+/** @ingroup kvstore
+	@brief The first key left to user applications.
+*/
+#define KV_KEY_USER 8
+
+/** @ingroup kvstore
+	@brief Find the newest record of every key, and format the store if it holds none.
+	@return Void.
+*/
+void kvInit();
+
+/** @ingroup kvstore
+	@brief Read the value of a key.
+	@param key The key.
+	@param buffer The buffer.
+	@param size The size of the buffer.
+	@return The length of the value, or -1 if the key has no value or the value does not fit.
+*/
+int kvGet(uint8_t key, void *buffer, uint8_t size);
+
+/** @ingroup kvstore
+	@brief Set the value of a key.
+	Nothing is written if the key already has this value. A value of length 0 removes the key.
+	@param key The key.
+	@param buffer The value.
+	@param length The length of the value, at most KV_MAX_VALUE.
+	@return 0 on success, -1 if the key or the length is out of range or the store is full.
+*/
+int kvPut(uint8_t key, const void *buffer, uint8_t length);
+
+/** @ingroup kvstore
+	@brief Get the version of a key, which counts the writes of its value.
+	@param key The key.
+	@return The version, or -1 if the key has no value.
+*/
+int kvVersion(uint8_t key);
+
+#endif
@@ -2,6 +2,11 @@
        @brief The functional implementation of the eeprom byte operations. 
 
 	This file implements the eeprom layer for byte wise operations. 
+
+	Writing an EEPROM byte takes about 3.3 ms. Instead of waiting for every byte, writes are put into a small FIFO
+	queue that the EEPROM ready interrupt drains one byte at a time, and bytes that already hold the written value
+	are skipped. Reads see the queued bytes, so the queue is invisible to callers except for timing. Because the
+	queue keeps the order of the writes, a reset loses a suffix of them, just as it would with immediate writes.
 	@author Qing Charles Cao (cao@utk.edu)
 */
 
@@ -9,189 +14,262 @@
 #include "ioeeprom.h"
 #include "../../hardware/avrhardware.h"
 #include <avr/eeprom.h>
+#include <avr/interrupt.h>
+
+//the ATmega1281 renamed the write enable bits
+#ifndef EEWE
+#define EEWE EEPE
+#define EEMWE EEMPE
+#endif
 
+typedef struct
+{
+    uint16_t addr;
+    uint8_t value;
+} eepromqueueentry;
+
+static volatile eepromqueueentry eepromqueue[EEPROM_QUEUE_SIZE];
+static volatile uint8_t eepromqueuehead, eepromqueuecount;
 
 //-------------------------------------------------------------------------
-void eeprom_readBytes(uint16_t addr, int nBytes, void *buffer)
+//Start programming the oldest queued byte. Called with interrupts disabled and no write in progress.
+static void eepromStartNext()
 {
+    EEAR = eepromqueue[eepromqueuehead].addr;
+    EEDR = eepromqueue[eepromqueuehead].value;
+    EECR |= _BV(EEMWE);
+    EECR |= _BV(EEWE);
+    eepromqueuehead++;
+    if (eepromqueuehead == EEPROM_QUEUE_SIZE)
+    {
+        eepromqueuehead = 0;
+    }
+    eepromqueuecount--;
+}
+
+//-------------------------------------------------------------------------
+ISR(EE_READY_vect)
+{
+    if (eepromqueuecount > 0)
+    {
+        eepromStartNext();
+    }
+    else
+    {
+        EECR &= ~_BV(EERIE);
+    }
+}
+
+//-------------------------------------------------------------------------
+//The value a byte will have once the queue is drained. Called with interrupts disabled.
+static uint8_t eepromPendingByte(uint16_t addr, uint8_t value)
+{
+    uint8_t i, index;
+
+    index = eepromqueuehead;
+    for (i = 0; i < eepromqueuecount; i++)
+    {
+        if (eepromqueue[index].addr == addr)
+        {
+            value = eepromqueue[index].value;
+        }
+        index++;
+        if (index == EEPROM_QUEUE_SIZE)
+        {
+            index = 0;
+        }
+    }
+    return value;
+}
+
+//-------------------------------------------------------------------------
+//The array cannot be read while a byte is being programmed. Hold the queue and wait for the current byte, at most one write time.
+static void eepromPause()
+{
+    EECR &= ~_BV(EERIE);
     eeprom_busy_wait();
+}
+
+//-------------------------------------------------------------------------
+static void eepromResume()
+{
+    if (eepromqueuecount > 0)
+    {
+        EECR |= _BV(EERIE);
+    }
+}
+
+//-------------------------------------------------------------------------
+void eeprom_readBytes(uint16_t addr, int nBytes, void *buffer)
+{
+    uint8_t *p;
+    int i;
+    _atomic_t _atomic;
+
+    eepromPause();
+    _atomic = _atomic_start();
     eeprom_read_block(buffer, (void *)addr, nBytes);
+    if (eepromqueuecount > 0)
+    {
+        p = (uint8_t *) buffer;
+        for (i = 0; i < nBytes; i++)
+        {
+            p[i] = eepromPendingByte(addr + i, p[i]);
+        }
+    }
+    _atomic_end(_atomic);
+    eepromResume();
     return;
 }
 
 //-------------------------------------------------------------------------
 void eeprom_writeBytes(uint16_t addr, int nBytes, void *buffer)
 {
-    eeprom_busy_wait();
-    eeprom_write_block(buffer, (void *)addr, nBytes);
+    uint8_t *p;
+    uint8_t current, tail;
+    int i;
+    _atomic_t _atomic;
+
+    p = (uint8_t *) buffer;
+    eepromPause();
+    for (i = 0; i < nBytes; i++)
+    {
+        //with the queue full, program the oldest byte here
+        if (eepromqueuecount == EEPROM_QUEUE_SIZE)
+        {
+            _atomic = _atomic_start();
+            eepromStartNext();
+            _atomic_end(_atomic);
+            eeprom_busy_wait();
+        }
+        _atomic = _atomic_start();
+        current = eepromPendingByte(addr + i, eeprom_read_byte((uint8_t *) (addr + i)));
+        //rewriting an unchanged byte costs the same time and wear as changing it
+        if (current != p[i])
+        {
+            tail = eepromqueuehead + eepromqueuecount;
+            if (tail >= EEPROM_QUEUE_SIZE)
+            {
+                tail -= EEPROM_QUEUE_SIZE;
+            }
+            eepromqueue[tail].addr = addr + i;
+            eepromqueue[tail].value = p[i];
+            eepromqueuecount++;
+        }
+        _atomic_end(_atomic);
+    }
+    eepromResume();
     return;
 }
 
+//-------------------------------------------------------------------------
+void eeprom_flush()
+{
+    _atomic_t _atomic;
+
+    eepromPause();
+    while (eepromqueuecount > 0)
+    {
+        _atomic = _atomic_start();
+        eepromStartNext();
+        _atomic_end(_atomic);
+        eeprom_busy_wait();
+    }
+}
+
 //-------------------------------------------------------------------------
 uint8_t eeprom_read8uint(uint16_t addr)
 {
     uint8_t ret;
-    _atomic_t _atomic = _atomic_start();
 
-    eeprom_busy_wait();
-    ret = eeprom_read_byte((uint8_t *) addr);
-    _atomic_end(_atomic);
+    eeprom_readBytes(addr, 1, &ret);
     return ret;
 }
 
 //-------------------------------------------------------------------------
 int8_t eeprom_read8int(uint16_t addr)
 {
-    uint8_t value;
-    _atomic_t _atomic = _atomic_start();
+    int8_t value;
 
-    eeprom_busy_wait();
-    value = eeprom_read_byte((uint8_t *) addr);
-    _atomic_end(_atomic);
-    return *(int8_t *) & value;
+    eeprom_readBytes(addr, 1, &value);
+    return value;
 }
 
 //-------------------------------------------------------------------------
 uint16_t eeprom_read16uint(uint16_t addr)
 {
     uint16_t value;
-    _atomic_t _atomic = _atomic_start();
 
-    eeprom_busy_wait();
-    value = eeprom_read_word((uint16_t *) addr);
-    _atomic_end(_atomic);
+    eeprom_readBytes(addr, 2, &value);
     return value;
 }
 
 //-------------------------------------------------------------------------
 int16_t eeprom_read16int(uint16_t addr)
 {
-    uint16_t value;
-    _atomic_t _atomic = _atomic_start();
+    int16_t value;
 
-    eeprom_busy_wait();
-    value = eeprom_read_word((uint16_t *) addr);
-    _atomic_end(_atomic);
-    return *(int16_t *) & value;
+    eeprom_readBytes(addr, 2, &value);
+    return value;
 }
 
 //-------------------------------------------------------------------------
 void eeprom_write8uint(uint16_t addr, uint8_t value)
 {
-    _atomic_t _atomic = _atomic_start();
-
-    eeprom_busy_wait();
-    eeprom_write_byte((uint8_t *) addr, value);
-    _atomic_end(_atomic);
+    eeprom_writeBytes(addr, 1, &value);
     return;
 }
 
 //-------------------------------------------------------------------------
 void eeprom_write8int(uint16_t addr, int8_t value)
 {
-    uint8_t value2;
-    _atomic_t _atomic = _atomic_start();
-
-    eeprom_busy_wait();
-    value2 = *(uint8_t *) & value;
-    eeprom_write_byte((uint8_t *) addr, value2);
-    _atomic_end(_atomic);
+    eeprom_writeBytes(addr, 1, &value);
     return;
 }
 
 //-------------------------------------------------------------------------
 void eeprom_write16uint(uint16_t addr, uint16_t value)
 {
-    _atomic_t _atomic = _atomic_start();
-
-    eeprom_busy_wait();
-    eeprom_write_word((uint16_t *) addr, value);
-    _atomic_end(_atomic);
+    eeprom_writeBytes(addr, 2, &value);
     return;
 }
 
 //-------------------------------------------------------------------------
 void eeprom_write16int(uint16_t addr, int16_t value)
 {
-    uint16_t value2;
-    _atomic_t _atomic = _atomic_start();
-
-    eeprom_busy_wait();
-    value2 = *(uint16_t *) & value;
-    eeprom_write_word((uint16_t *) addr, value2);
-    _atomic_end(_atomic);
+    eeprom_writeBytes(addr, 2, &value);
     return;
 }
 
 //-------------------------------------------------------------------------
 uint32_t eeprom_read32uint(uint16_t addr)
 {
-    uint16_t value1;
-    uint16_t value2;
-    _atomic_t _atomic = _atomic_start();
+    uint32_t value;
 
-    eeprom_busy_wait();
-    value1 = eeprom_read_word((uint16_t *) addr);
-    eeprom_busy_wait();
-    value2 = eeprom_read_word((uint16_t *) (addr + 2));
-    _atomic_end(_atomic);
-    return (((uint32_t) value2) << 16) + (uint32_t) value1;
+    eeprom_readBytes(addr, 4, &value);
+    return value;
 }
 
 //-------------------------------------------------------------------------
 int32_t eeprom_read32int(uint16_t addr)
 {
-    uint16_t value1;
-    uint16_t value2;
-    uint32_t returnvalue;
-    _atomic_t _atomic = _atomic_start();
+    int32_t value;
 
-    eeprom_busy_wait();
-    value1 = eeprom_read_word((uint16_t *) addr);
-    eeprom_busy_wait();
-    value2 = eeprom_read_word((uint16_t *) (addr + 2));
-    returnvalue = ((((uint32_t) value2) << 16) + (uint32_t) value1);
-    _atomic_end(_atomic);
-    return *(int32_t *) & returnvalue;
+    eeprom_readBytes(addr, 4, &value);
+    return value;
 }
 
 //-------------------------------------------------------------------------
 void eeprom_write32uint(uint16_t addr, uint32_t value)
 {
-    uint16_t value1;
-    uint16_t value2;
-    _atomic_t _atomic = _atomic_start();
-
-    value1 = (uint16_t) (value >> 16);
-    value2 = (uint16_t) (value & 0x0000ffff);
-    eeprom_busy_wait();
-    //value2 = *(uint16_t *)&value;
-    eeprom_write_word((uint16_t *) addr, value2);
-    addr = addr + 2;
-    eeprom_busy_wait();
-    //value2 = *(uint16_t *)&value;
-    eeprom_write_word((uint16_t *) addr, value1);
-    _atomic_end(_atomic);
+    eeprom_writeBytes(addr, 4, &value);
     return;
 }
 
 //-------------------------------------------------------------------------
 void eeprom_write32int(uint16_t addr, int32_t value)
 {
-    uint16_t value1;
-    uint32_t value2;
-    _atomic_t _atomic = _atomic_start();
-
-    value1 = (uint16_t) ((*(uint32_t *) & value) >> 16);
-    value2 = (uint16_t) ((*(uint32_t *) & value) & 0x0000ffff);
-    eeprom_busy_wait();
-    //value2 = *(uint16_t *)&value;
-    eeprom_write_word((uint16_t *) addr, value2);
-    addr = addr + 2;
-    eeprom_busy_wait();
-    //value2 = *(uint16_t *)&value;
-    eeprom_write_word((uint16_t *) addr, value1);
-    _atomic_end(_atomic);
+    eeprom_writeBytes(addr, 4, &value);
     return;
 }
 
@@ -199,11 +277,9 @@ void eeprom_write32int(uint16_t addr, int32_t value)
 void eeprom_initBytes(uint16_t addr, int nBytes, uint8_t value)
 {
     int i;
-    _atomic_t _atomic = _atomic_start();
 
     for (i = 0; i < nBytes; i++)
     {
-        eeprom_write8uint(addr + i, value);
+        eeprom_writeBytes(addr + i, 1, &value);
     }
-    _atomic_end(_atomic);
 }
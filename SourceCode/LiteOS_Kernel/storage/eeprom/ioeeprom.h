@@ -15,6 +15,11 @@
 
 /** @{ */
 
+/** @brief The number of written bytes that may wait for the EEPROM ready interrupt. Each entry costs 3 bytes of RAM. */
+#ifndef EEPROM_QUEUE_SIZE
+#define EEPROM_QUEUE_SIZE 16
+#endif
+
 
 /** @ingroup eeprom
 	@brief Read an unsigned 8-bit integer from the eeprom.
@@ -137,6 +142,7 @@ void eeprom_readBytes(uint16_t addr, int nBytes, void *buffer);
 
 /** @ingroup eeprom
 	@brief Write a block of integers into the eeprom from buffer.
+	Bytes that already hold their value are skipped. The others are queued and programmed from the EEPROM ready interrupt; a full queue is drained here.
 	@param addr The address.
 	@param nBytes The number of bytes.
 	@param buffer The pointer to the buffer.
@@ -158,5 +164,11 @@ void eeprom_writeBytes(uint16_t addr, int nBytes, void *buffer);
 
 void eeprom_initBytes(uint16_t addr, int nBytes, uint8_t value);
 
+/** @ingroup eeprom
+	@brief Wait until every queued byte has been programmed.
+	@return Void.
+*/
+void eeprom_flush();
+
 /**@}*/
 #endif
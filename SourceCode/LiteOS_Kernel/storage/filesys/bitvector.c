@@ -0,0 +1,105 @@
+/** @file bitvector.c
+	 @brief This file implements the bit vector operations shared by the inode and flash page allocators.
+*/
+
+#include "bitvector.h"
+
+//-------------------------------------------------------------------------
+int bitvectorGet(char *set, int number)
+{
+    return (set[number >> 3] & (1 << (number & 7))) != 0;
+}
+
+//-------------------------------------------------------------------------
+int bitvectorSet(char *set, int number, int value)
+{
+    char old;
+
+    set += number >> 3;
+    old = *set;
+    if (value)
+    {
+        *set |= 1 << (number & 7);
+    }
+    else
+    {
+        *set &= ~(1 << (number & 7));
+    }
+    return *set != old;
+}
+
+//-------------------------------------------------------------------------
+int bitvectorFirstZero(uint16_t word)
+{
+    int bit;
+
+    if (word == 0xffff)
+    {
+        return -1;
+    }
+    //binary search for the lowest clear bit, halving the window each step
+    bit = 0;
+    if ((word & 0xff) == 0xff)
+    {
+        word >>= 8;
+        bit += 8;
+    }
+    if ((word & 0x0f) == 0x0f)
+    {
+        word >>= 4;
+        bit += 4;
+    }
+    if ((word & 0x03) == 0x03)
+    {
+        word >>= 2;
+        bit += 2;
+    }
+    if (word & 0x01)
+    {
+        bit += 1;
+    }
+    return bit;
+}
+
+//-------------------------------------------------------------------------
+int bitvectorFindZero(char *set, int bits, int start)
+{
+    int bytes, index, i;
+    uint8_t mask;
+
+    bytes = bits >> 3;
+    index = start >> 3;
+    //bits below start in the first byte are treated as set until the scan wraps around to them
+    mask = (uint8_t) ((1 << (start & 7)) - 1);
+    for (i = 0; i <= bytes; i++)
+    {
+        if (((uint8_t) set[index] | mask) != 0xff)
+        {
+            return (index << 3) +
+                bitvectorFirstZero(0xff00 | (uint8_t) set[index] | mask);
+        }
+        mask = 0;
+        index++;
+        if (index == bytes)
+        {
+            index = 0;
+        }
+    }
+    return -1;
+}
+
+//-------------------------------------------------------------------------
+int bitvectorCount(char *set, int bits)
+{
+    static const uint8_t nibblecount[16] =
+        { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+    int i, count;
+
+    count = 0;
+    for (i = 0; i < (bits >> 3); i++)
+    {
+        count += nibblecount[(uint8_t) set[i] & 0x0f];
+        count += nibblecount[(uint8_t) set[i] >> 4];
+    }
+    return count;
+}
@@ -0,0 +1,52 @@
+/** @file bitvector.h
+	 @brief This file declares the bit vector operations shared by the inode and flash page allocators.
+*/
+
+
+#ifndef BITVECTORH
+#define BITVECTORH
+#include "../../types/types.h"
+
+/** \addtogroup filesystem */
+
+/** @{ */
+
+/** @brief Get a bit.
+	@param set The bit vector.
+	@param number The bit number.
+	@return 0 or 1.
+*/
+int bitvectorGet(char *set, int number);
+
+/** @brief Set or clear a bit.
+	@param set The bit vector.
+	@param number The bit number.
+	@param value Nonzero to set the bit, 0 to clear it.
+	@return 1 if the bit changed, 0 otherwise.
+*/
+int bitvectorSet(char *set, int number, int value);
+
+/** @brief Find the lowest clear bit of a 16-bit word.
+	@param word The word.
+	@return The bit number, or -1 if all bits are set.
+*/
+int bitvectorFirstZero(uint16_t word);
+
+/** @brief Find the first clear bit at or after a starting bit, wrapping around at the end of the vector.
+	Whole bytes that are fully set are skipped without looking at their bits.
+	@param set The bit vector.
+	@param bits The number of bits in the vector, a multiple of 8.
+	@param start The bit to start from.
+	@return The bit number, or -1 if all bits are set.
+*/
+int bitvectorFindZero(char *set, int bits, int start);
+
+/** @brief Count the set bits.
+	@param set The bit vector.
+	@param bits The number of bits in the vector, a multiple of 8.
+	@return The number of set bits.
+*/
+int bitvectorCount(char *set, int bits);
+
+/** @} */
+#endif
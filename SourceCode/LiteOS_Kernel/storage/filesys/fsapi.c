@@ -13,14 +13,24 @@
 #include "fsconfig.h"
 #include "inode.h"
 #include "fsapi.h"
+#include "inodecache.h"
+#include "logfile.h"
+#include "ringfile.h"
+#include "journal.h"
 #include "../flash/pagestorage.h"
 #include "../bytestorage/bytestorage.h"
+#include "storageconstants.h"
 #include "../../types/types.h"
 #include "../../types/string.h"
 
 
 extern fid fidtable[MAX_FILE_TABLE_SIZE];
 
+//the file handle whose page is mapped for fmapread(), -1 for none
+static int8_t mappedfid = -1;
+static uint16_t mappedpage;     //the flash page of the mapping, looked up once by fmap()
+static int32_t mappedfilepage;  //the page of the file it holds
+
 //-------------------------------------------------------------------------
 MYFILE *fsopen(char *pathname, char *mode)
 {
@@ -42,7 +52,7 @@ MYFILE *fsopen(char *pathname, char *mode)
     //first, file does not exist
     if (state == 0)
     {
-        if (openmode == 2)
+        if ((openmode == 2) || (openmode == 6) || (openmode == 7))
         {
             int blockaddr;
             int fid;
@@ -63,6 +73,12 @@ MYFILE *fsopen(char *pathname, char *mode)
     {
         return NULL;
     }
+    //a ring overwrites its oldest bytes, which would cut records out of a log
+    if (((openmode == 6) || (openmode == 7))
+        && (fsread8uint(retaddr, FILE_FLAGSOFFSET) & FILE_FLAG_RING))
+    {
+        return NULL;
+    }
     {
         int fid;
 
@@ -75,15 +91,132 @@ MYFILE *fsopen(char *pathname, char *mode)
 //-------------------------------------------------------------------------
 void fclose2(MYFILE * fp)
 {
+    fsync2();
+    logClose(fp);
+    funmap(fp);
     releaseFid(fp->index);
     fp = NULL;
     return;
 }
 
+//-------------------------------------------------------------------------
+void fsync2()
+{
+    //data reaches the flash before the sizes that cover it reach the inodes
+    syncpagestorage();
+    logSync();
+    ringSync();
+    fscommit();
+}
+
+//-------------------------------------------------------------------------
+void fscommit()
+{
+    inodeCacheSync();
+    writeVectorNodeToExternalStorage();
+    writeVectorFlashToExternalStorage();
+    journalCommit();
+}
+
+//-------------------------------------------------------------------------
+//Revision 1 kept 16-bit sizes and 8-bit sector ids; the bytes that now hold their upper bits were left unused
+//Revision 2 had no name hashes
+//Revision 3 had no journal, and its allocation vectors and open log marks were never written
+static void migrateSystem(uint8_t revision)
+{
+    int addr;
+    uint8_t type;
+    char name[13];
+    uint8_t zero;
+
+    journalReset();
+
+    if (revision < 2)
+    {
+        for (addr = 1; addr <= INODENUM; addr++)
+        {
+            type = checkNodeValid(addr);
+            if ((type == FILENODE) || (type == EXTNODE))
+            {
+                fswrite16uint(addr, FILE_SIZEHIGHOFFSET, 0);
+                fswrite8uint(addr, FILE_SECTORHIGHOFFSET, 0);
+            }
+        }
+        inodeCacheSync();
+        journalCommit();
+    }
+    if (revision < 3)
+    {
+        for (addr = 0; addr <= INODENUM; addr++)
+        {
+            type = checkNodeValid(addr);
+            if ((type > 0) && (type != EXTNODE) && (type != DIREXTNODE))
+            {
+                getName(name, addr);
+                setNodeHash(addr, name);
+            }
+        }
+    }
+    if (revision < 4)
+    {
+        zero = 0;
+        for (addr = 0; addr < (INODENUM + 8) / 8; addr++)
+        {
+            genericwriteBytes(OPENLOGSTART + addr, 1, &zero);
+        }
+    }
+    revision = FS_REVISION;
+    genericwriteBytes(FSREVISIONOFFSET, 1, &revision);
+}
+
+//-------------------------------------------------------------------------
+void mountSystem()
+{
+    int addr;
+    uint8_t revision;
+
+    genericreadBytes(FSREVISIONOFFSET, 1, &revision);
+    initFidTable();
+    initVectorNode();
+    initVectorFlash();
+    //the stored vectors can be trusted only if the last sync point committed whole
+    if ((revision == FS_REVISION) && (journalRecover()))
+    {
+        readVectorNodeFromExternalStorage();
+        readVectorFlashFromExternalStorage();
+        logRecoverOpen();
+        buildNameIndex();
+        fsync2();
+        return;
+    }
+    if (revision != FS_REVISION)
+    {
+        //an erased EEPROM reads 0xff, which is taken as the first revision
+        if (revision > FS_REVISION)
+        {
+            revision = 1;
+        }
+        migrateSystem(revision);
+    }
+    scanVectorNode();
+    scanVectorFlash();
+    for (addr = 1; addr <= INODENUM; addr++)
+    {
+        if ((checkNodeValid(addr) == FILENODE)
+            && (fsread8uint(addr, FILE_LOGOFFSET) != 0))
+        {
+            logRecover(addr);
+        }
+    }
+    logRecoverOpen();
+    buildNameIndex();
+    fsync2();
+}
+
 //-------------------------------------------------------------------------
 int fseek2(MYFILE * fp, int32_t offset, int position)
 {
-    int temp;
+    int32_t temp;
 
     if (position == 0)
     {
@@ -146,11 +279,51 @@ int fcreatedir2(char *pathname)
     if (state == 0)
     {
         createDir(extractLastName(pathname), retaddr);
+        fsync2();
         return 0;
     }
     return -1;
 }
 
+//-------------------------------------------------------------------------
+int fcreatering(char *pathname, int32_t capacity)
+{
+    int retaddr, state, fid, sectors;
+    uint8_t addr;
+
+    retaddr = locateFileName(pathname, &state);
+    if ((retaddr == -1) || (state != 0) || (capacity <= 0)
+        || (capacity > FILE_MAX_SIZE))
+    {
+        return -1;
+    }
+    //the file and every continuation inode are taken up front, with the sectors and the block the parent may need
+    sectors = (capacity + 2047) / 2048;
+    if ((countVectorFlash() < sectors)
+        || (countVectorNode() < (sectors + 7) / 8 + childNodeCost(retaddr)))
+    {
+        return -1;
+    }
+    addr = createFileFromDirectory(extractLastName(pathname), retaddr);
+    if ((addr == 0) || (addr == 255))
+    {
+        return -1;
+    }
+    fid = getFreeFid();
+    openFile(addr, fid, 2);
+    if (reserveFileSpace(fid, (int32_t) sectors * 2048) < 0)
+    {
+        releaseFid(fid);
+        deleteNode(addr);
+        fsync2();
+        return -1;
+    }
+    fswrite8uint(addr, FILE_FLAGSOFFSET, FILE_FLAG_RING);
+    releaseFid(fid);
+    fsync2();
+    return 0;
+}
+
 //-------------------------------------------------------------------------
 int fdelete2(char *pathname)
 {
@@ -163,6 +336,7 @@ int fdelete2(char *pathname)
     else
     {
         deleteNode(ret);
+        fsync2();
         return 0;
     }
 }
@@ -199,139 +373,156 @@ void fsprintall()
 //-------------------------------------------------------------------------
 int fread2(MYFILE * fp, void *buffer, int nBytes)
 {
-    int startsector;
-    int endsector;
-    uint8_t realsector;
-    int readbytes;
-    int pagenum, blockoffset, pageoffset;
-
+    if (fsread8uint(fp->addr, FILE_FLAGSOFFSET) & FILE_FLAG_RING)
+    {
+        return ringRead(fp, buffer, nBytes);
+    }
     if (fp->fpos + nBytes > fp->size)
     {
         return -1;
     }
-    startsector = fp->fpos / 2048;
-    endsector = (fp->fpos + nBytes - 1) / 2048;
-    if (startsector == endsector)
+    if (transferFileBytes(fp->index, fp->fpos, buffer, nBytes, 0) < 0)
     {
-        blockoffset = fp->fpos % 2048;
-        pageoffset = blockoffset % 256;
-        pagenum = blockoffset / 256;
-        //realsector = read8uint(fp->addr, FILE_ADDRPAGEOFFSET+startsector);
-        //  realsector = read8uint(fp->addr, FILE_ADDRPAGEOFFSET+startsector);
-        realsector = getRealSector(fp->addr, startsector);
-        pagenum = pagenum + (realsector - 1) * 8;
-        //now pagenum, offset2 means the actual start location just read it
-        readpagestorage(pagenum, pageoffset, buffer, nBytes);
-    }
-    else
-    {
-        blockoffset = fp->fpos % 2048;
-        pageoffset = blockoffset % 256;
-        pagenum = blockoffset / 256;
-        //      realsector = read8uint(fp->addr, FILE_ADDRPAGEOFFSET+startsector);
-        //realsector = read8uint(fp->addr, FILE_ADDRPAGEOFFSET+startsector);
-        realsector = getRealSector(fp->addr, startsector);
-        pagenum = pagenum + (realsector - 1) * 8;
-        readbytes = 256 - pageoffset;
-        //now pagenum, offset2 means the actual start location just read it
-        readpagestorage(pagenum, pageoffset, buffer, readbytes);
-        buffer = (void *)((char *)buffer + readbytes);
-        blockoffset = (fp->fpos + nBytes - 1) % 2048;
-        pageoffset = blockoffset % 256;
-        pagenum = blockoffset / 256;
-        //realsector = read8uint(fp->addr, FILE_ADDRPAGEOFFSET+endsector);
-        //realsector = read8uint(fp->addr, FILE_ADDRPAGEOFFSET+startsector);
-        realsector = getRealSector(fp->addr, endsector);
-        pagenum = pagenum + (realsector - 1) * 8;
-        readbytes = nBytes - readbytes;
-        //now pagenum, offset2 means the actual start location just read it
-        readpagestorage(pagenum, 0, buffer, readbytes);
+        return -1;
     }
+    readAheadFileBytes(fp->index, fp->fpos, nBytes);
     return 0;
 }
 
 //-------------------------------------------------------------------------
 int fwrite2(MYFILE * fp, void *buffer, int nBytes)
 {
-    int startsector;
-    int endsector;
-    uint8_t realsector;
-    int readbytes;
-    int pagenum, blockoffset, pageoffset;
-
-    //first it checks whether there is enough space for the writing to take place, then it does the actual writing in the same way as above 
-    if (fp->fpos + nBytes <= fp->size)
+    if (fp->mode == 6)
     {
-        //there is no need to change the size or allocate more space for the write
+        return logAppend(fp, buffer, nBytes);
     }
-    else
+    if (fsread8uint(fp->addr, FILE_FLAGSOFFSET) & FILE_FLAG_RING)
     {
-        uint16_t allocate;
-
-        allocate = (fp->size / 2048) * 2048;
-        if (fp->size % 2048 > 0)
+        return ringAppend(fp, buffer, nBytes);
+    }
+    //first it checks whether there is enough space for the writing to take place, then it does the actual writing in the same way as above 
+    if (fp->fpos + nBytes > fp->size)
+    {
+        //avoid flash overflow
+        if (fp->fpos + nBytes > FILE_MAX_SIZE)
         {
-            allocate += 2048;
+            return 2;
         }
-        //     if ((allocate == 32768)&&(fp->fpos + nBytes > 32768))
-        //         foobar(); 
-        if (fp->fpos + nBytes > allocate)
+        if (reserveFileSpace(fp->index, fp->fpos + nBytes) < 0)
         {
-            newSector(fp->addr);
+            return 2;
         }
+    }
+    if (unshareFileSpace(fp->index, fp->fpos, fp->fpos + nBytes) < 0)
+    {
+        return 2;
+    }
+    if (transferFileBytes(fp->index, fp->fpos, buffer, nBytes, 1) < 0)
+    {
+        return 2;
+    }
+    //the file grows only once the bytes it grows over have been written
+    if (fp->fpos + nBytes > fp->size)
+    {
+        fp->size = fp->fpos + nBytes;
+        fswriteFileSize(fp->addr, fp->size);
+    }
+    return 0;
+}
 
-        if (fp->fpos + nBytes > fp->size)
-        {
-            fp->size = fp->fpos + nBytes;
-            fswrite16uint(fp->addr, FILE_SIZEOFFSET, fp->size);
-        }
+//-------------------------------------------------------------------------
+int fmap(MYFILE * fp)
+{
+    uint16_t realsector;
+    int available;
+
+    if (fsread8uint(fp->addr, FILE_FLAGSOFFSET) & FILE_FLAG_RING)
+    {
+        return -1;
+    }
+    if (fp->fpos >= fp->size)
+    {
+        return 0;
     }
-    
-    //avoid flash overflow
-    if (fp->size > 64000)
-    	return 2; 
-    	 
-    startsector = fp->fpos / 2048;
-    endsector = (fp->fpos + nBytes - 1) / 2048;
-    if (startsector == endsector)
-    {
-        blockoffset = fp->fpos % 2048;
-        pageoffset = blockoffset % 256;
-        pagenum = blockoffset / 256;
-        //      realsector = read8uint(fp->addr, FILE_ADDRPAGEOFFSET+startsector);
-        //realsector = read8uint(fp->addr, FILE_ADDRPAGEOFFSET+startsector);
-        realsector = getRealSector(fp->addr, startsector);
-        pagenum = pagenum + (realsector - 1) * 8;
-        //now pagenum, offset2 means the actual start location just read it
-        writepagestorage(pagenum, pageoffset, buffer, nBytes);
+    realsector = getFileSector(fp->index, fp->fpos / 2048);
+    if (realsector == 0)
+    {
+        return -1;
     }
-    else
+    mappedpage = (realsector - 1) * 8 + (fp->fpos % 2048) / 256;
+    mappedfilepage = fp->fpos / 256;
+    mappagestorage(mappedpage);
+    mappedfid = fp->index;
+    available = 256 - fp->fpos % 256;
+    if (available > fp->size - fp->fpos)
     {
-        blockoffset = fp->fpos % 2048;
-        pageoffset = blockoffset % 256;
-        pagenum = blockoffset / 256;
-        //realsector = read8uint(fp->addr, FILE_ADDRPAGEOFFSET+startsector);
-        //realsector = read8uint(fp->addr, FILE_ADDRPAGEOFFSET+startsector);
-        realsector = getRealSector(fp->addr, startsector);
-        pagenum = pagenum + (realsector - 1) * 8;
-        readbytes = 256 - pageoffset;
-        //now pagenum, offset2 means the actual start location just read it
-        writepagestorage(pagenum, pageoffset, buffer, readbytes);
-        buffer = (void *)((char *)buffer + readbytes);
-        blockoffset = (fp->fpos + nBytes - 1) % 2048;
-        pageoffset = blockoffset % 256;
-        pagenum = blockoffset / 256;
-        //realsector = read8uint(fp->addr, FILE_ADDRPAGEOFFSET+endsector);
-        //realsector = read8uint(fp->addr, FILE_ADDRPAGEOFFSET+startsector);
-        realsector = getRealSector(fp->addr, endsector);
-        pagenum = pagenum + (realsector - 1) * 8;
-        readbytes = nBytes - readbytes;
-        //now pagenum, offset2 means the actual start location just read it
-        writepagestorage(pagenum, 0, buffer, readbytes);
+        available = fp->size - fp->fpos;
     }
+    return available;
+}
+
+//-------------------------------------------------------------------------
+int fmapread(MYFILE * fp, void *buffer, int nBytes)
+{
+    //only the pinned buffer is read, as this runs with interrupts disabled; a sector that moved has ended the mapping
+    if ((fp->index != mappedfid) || (fp->fpos / 256 != mappedfilepage)
+        || (fp->fpos + nBytes > fp->size)
+        || (fp->fpos % 256 + nBytes > 256))
+    {
+        return -1;
+    }
+    if (readmappedpagestorage(mappedpage, fp->fpos % 256, buffer, nBytes) ==
+        FALSE)
+    {
+        return -1;
+    }
+    fp->fpos += nBytes;
     return 0;
 }
 
+//-------------------------------------------------------------------------
+void fmapmoved(uint16_t sector)
+{
+    if ((mappedfid >= 0) && (mappedpage / 8 + 1 == sector))
+    {
+        unmappagestorage();
+        mappedfid = -1;
+    }
+}
+
+//-------------------------------------------------------------------------
+void funmap(MYFILE * fp)
+{
+    if (fp->index == mappedfid)
+    {
+        unmappagestorage();
+        mappedfid = -1;
+    }
+}
+
+//-------------------------------------------------------------------------
+int fverify(MYFILE * fp)
+{
+    int32_t pos;
+    uint16_t realsector;
+    int corrupted;
+
+    //pages still in the write buffers are stamped as they are programmed
+    syncpagestorage();
+    corrupted = 0;
+    for (pos = 0; pos < fp->size; pos += 256)
+    {
+        realsector = getFileSector(fp->index, pos / 2048);
+        if ((realsector > 0)
+            && (verifypagestorage((realsector - 1) * 8 + (pos % 2048) / 256)
+                == PAGE_CORRUPTED))
+        {
+            corrupted++;
+        }
+    }
+    return corrupted;
+}
+
 //-------------------------------------------------------------------------
 int fmove(char *source, char *target)
 {
@@ -346,51 +537,107 @@ int fmove(char *source, char *target)
     q = target + mystrlen(target);
     namelength = q - p;
     ret1 = locateFileName(source, &state1);
+    ret2 = locateFileName(target, &state2);
+    if ((ret1 == -1) || (state1 == 0) || (ret1 == 0) || (ret2 == -1)
+        || (state2 != 0) || (fullBlock(ret2) == 1))
+    {
+        return -1;
+    }
     parent = fsread8uint(ret1, FILE_PARENTOFFSET);
     removeChildNode(parent, ret1);
-    ret2 = locateFileName(target, &state2);
+    invalidatePathCache();
     fswrite8uint(ret1, FILE_PARENTOFFSET, ret2);
     fswriteBytes(ret1, FILENAMEOFFSET, namelength, p);
     fswrite8uint(ret1, FILENAMEOFFSET + namelength, 0);
+    setNodeHash(ret1, p);
     addChildNode(ret2, ret1);
+    fsync2();
     return 0;
 }
 
 //-------------------------------------------------------------------------
+//the copy shares the sectors of the source, and either file copies a shared sector before writing it (see unshareFileSpace())
 int fcopy(char *source, char *target)
 {
-    //if ((ret = fexist(pathname))==-1)
     int ret1, ret2;
     int state1, state2;
     uint8_t i;
     char *p;
     char *q;
-    int NewNode;
+    int NewNode, chainlength;
     uint8_t namelength;
+    uint8_t from, to, next, ext;
 
     p = extractLastName(target);
     q = target + mystrlen(target);
     namelength = q - p;
     ret1 = locateFileName(source, &state1);
     ret2 = locateFileName(target, &state2);
+    if ((ret1 == -1) || (state1 == 0) || (ret2 == -1) || (state2 != 0)
+        || (fsread8uint(ret1, TYPEOFFSET) != FILENODE)
+        || (fullBlock(ret2) == 1))
+    {
+        return -1;
+    }
+    //the copy needs an inode for every inode in the chain of the source, and one more if the target directory must grow a block
+    chainlength = 0;
+    for (from = ret1; from > 0; from = fsread8uint(from, FILE_NEXTOFFSET))
+    {
+        chainlength++;
+    }
+    if (countVectorNode() < chainlength + childNodeCost(ret2))
+    {
+        return -1;
+    }
+    //the shared sectors must hold everything written to the source so far
+    fsync2();
     NewNode = getVectorNode();
     copyVectorNode(ret1, NewNode);
     fswriteBytes(NewNode, FILENAMEOFFSET, namelength, p);
     fswrite8uint(NewNode, FILENAMEOFFSET + namelength, 0);
+    setNodeHash(NewNode, p);
     fswrite8uint(NewNode, FILE_PARENTOFFSET, ret2);
-    addChildNode(ret2, NewNode);
-    for (i = 0; i < 8; i++)
+    //log records are checked against the inode number, so the copy holds the bytes of the log as a plain file
+    fswrite8uint(NewNode, FILE_LOGOFFSET, 0);
+    //a copy of a ring is a ring with the same head
+    fswrite8uint(NewNode, FILE_FLAGSOFFSET, fsread8uint(ret1, FILE_FLAGSOFFSET)
+                 & (FILE_FLAG_RING | FILE_FLAG_WRAPPED));
+    from = ret1;
+    to = NewNode;
+    while (1)
     {
-        uint8_t temp, temp1;
+        for (i = 0; i < 8; i++)
+        {
+            uint16_t temp;
 
-        temp = fsread8uint(ret1, FILE_ADDRPAGEOFFSET + i);
-        if (temp > 0)
+            temp = fsreadFileSector(from, i);
+            if (temp > 0)
+            {
+                shareFlashPage(temp);
+            }
+        }
+        next = fsread8uint(from, FILE_NEXTOFFSET);
+        if (next == 0)
         {
-            temp1 = getFlashPage();
-            fswrite8uint(NewNode, FILE_ADDRPAGEOFFSET + i, temp1);
-            copyVectorPage(temp, temp1);
+            break;
         }
+        //every continuation inode is duplicated, rather than shared with the source
+        ext = getVectorNode();
+        copyVectorNode(next, ext);
+        fswrite8uint(ext, FILE_PARENTOFFSET, NewNode);
+        fswrite8uint(to, FILE_NEXTOFFSET, ext);
+        from = next;
+        to = ext;
     }
+    invalidatePathCache();
+    if (addChildNode(ret2, NewNode) < 0)
+    {
+        //deleting the unlinked copy drops its share of the sectors and frees its inodes
+        deleteNode(NewNode);
+        fsync2();
+        return -1;
+    }
+    fsync2();
     return 0;
 }
 
@@ -458,12 +705,15 @@ void fsearch(uint8_t * addrlist, uint8_t * size, char *string)
 {
     uint8_t i;
     uint8_t *p;
+    uint16_t signature;
 
     p = addrlist;
     *size = 0;
+    signature = nameSignature(string);
     for (i = 1; i <= INODENUM; i++)
     {
-        if (inodeMatch(i, string) == 1)
+        //the names are read only for the nodes the signatures leave
+        if ((nodeSignatureMatch(i, signature)) && (inodeMatch(i, string) == 1))
         {
             p[*size] = i;
             (*size)++;
@@ -475,7 +725,13 @@ void fsearch(uint8_t * addrlist, uint8_t * size, char *string)
 //-------------------------------------------------------------------------
 void formatSystem()
 {
+    uint8_t revision;
+
+    journalReset();
     formatFS();
+    fsync2();
+    revision = FS_REVISION;
+    genericwriteBytes(FSREVISIONOFFSET, 1, &revision);
 }
 
 //-------------------------------------------------------------------------
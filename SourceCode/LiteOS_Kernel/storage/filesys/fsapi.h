@@ -22,7 +22,7 @@ typedef struct
     uint8_t index;
     uint8_t addr;
     uint8_t mode;
-    uint16_t size;
+    int32_t size;
     int32_t fpos;
 } fid, *fidptr, MYFILE;
 
@@ -30,7 +30,7 @@ typedef struct
 /** @brief Open a file. 
 	This function opens a file according to a pathname and the mode. The file opened must be a file, not program, device driver and directory.
 	@param pathname The path of the file. 
-	@param mode Opening mode of the file. 
+	@param mode Opening mode of the file: "r", "w", "a", "t" (truncate), two characters for read and write, "l" to append records to a log file (see logfile.h), or "c" to do so with the records compressed. A log keeps the way its first record was stored until it is truncated. "w", "l" and "c" create the file if it does not exist.
 	@return The file handle. 
 */
 MYFILE *fsopen(char *pathname, char *mode);
@@ -41,6 +41,24 @@ MYFILE *fsopen(char *pathname, char *mode);
 */
 void fclose2(MYFILE * fp);
 
+/** @brief Write the cached file system metadata and buffered file pages back into storage.
+	Metadata is buffered in RAM and file pages in the flash write buffers between sync points. fclose2() and the directory operations call this function, and long-running writers may call it to bound what a reset can lose.
+	@return Void.
+*/
+void fsync2();
+
+/** @brief Commit the cached inodes and the allocation vectors as one journal transaction.
+	Unlike fsync2(), buffered file pages are not written. Either all of the metadata changed since the last commit survives a reset, or none of it does.
+	@return Void.
+*/
+void fscommit();
+
+/** @brief Mount the file system at boot.
+	Replays the metadata journal, loads the allocation bitmaps committed with the inodes and recovers the size of log files that were not closed before a reset. A file system written by an older revision is migrated to FS_REVISION first, and its bitmaps are rebuilt from the inodes, as they are whenever the journal does not end with a whole sync point.
+	@return Void.
+*/
+void mountSystem();
+
 /** @brief This function changes teh current location of fpos parameter.
 	@param fp The file handle. 
 	@param offset The offset.
@@ -62,6 +80,14 @@ int fexist2(char *pathname);
 */
 int fcreatedir2(char *pathname);
 
+/** @brief Create a ring file, which records continuously in a fixed amount of flash.
+	All of its sectors are allocated here, so writing never runs out of space: once the ring is full, every write overwrites the oldest bytes. Writes always go to the head of the ring, whatever the file position, and reads count positions from the oldest byte the ring held when it was opened, so reading from 0 to the size of the handle gives the recording from oldest to newest. Truncating it with "t" empties it but keeps its sectors, and it cannot be opened as a log.
+	@param pathname The pathname of the file, which must not exist.
+	@param capacity The number of bytes kept, rounded up to whole 2KB sectors.
+	@return 0 on success, -1 if the file exists or there is not enough space.
+*/
+int fcreatering(char *pathname, int32_t capacity);
+
 /** @brief Deletes a file.
 	Right now this is implemented in a simple way. Bsaically it checks the pathname and see if the file is there. If it is, then it deletes the block of the file.  
 	@param pathname The pathname to the directory or the file. 
@@ -86,6 +112,41 @@ int fread2(MYFILE * fp, void *buffer, int nBytes);
 
 int fwrite2(MYFILE * fp, void *buffer, int nBytes);
 
+/** @brief Map the flash page holding the file position, so that fmapread() reads it straight from the page storage.
+	One page is mapped at a time, and mapping another one, from any handle, ends the mapping. Ring files cannot be mapped.
+	@param fp The file handle.
+	@return The number of bytes of the file from the file position to the end of the page, 0 at the end of the file, or -1 if the file cannot be mapped.
+*/
+int fmap(MYFILE * fp);
+
+/** @brief Read bytes of the mapped page at the file position, and advance the file position past them.
+	The read never waits on the page storage, which makes it cheap enough to read single fields.
+	@param fp The file handle.
+	@param buffer The buffer.
+	@param nBytes The number of bytes, which must not reach past the page.
+	@return 0 on success, or -1 if the page is not mapped or not readable right now, in which case it must be mapped again with fmap().
+*/
+int fmapread(MYFILE * fp, void *buffer, int nBytes);
+
+/** @brief End the mapping if its page is in a sector that a file is about to stop pointing to, as fmapread() does not look the page up again.
+	@param sector The sector.
+	@return Void.
+*/
+void fmapmoved(uint16_t sector);
+
+/** @brief End the mapping of a file, if it has one. Closing the file does so as well.
+	@param fp The file handle.
+	@return Void.
+*/
+void funmap(MYFILE * fp);
+
+/** @brief Check every page of an open file against the CRC the page storage keeps with it.
+	Pages written before the storage kept CRCs have nothing to be checked against and are not counted.
+	@param fp The file handle.
+	@return The number of corrupted pages, 0 if the file is intact.
+*/
+int fverify(MYFILE * fp);
+
 /** @brief Move a file.
 	@param source The source file.
 	@param target The target file.
@@ -5,139 +5,195 @@
 */
 
 #include "fsconfig.h"
-#include "../bytestorage/bytestorage.h"
+#include "inodecache.h"
 
 //-------------------------------------------------------------------------
 uint8_t fsread8uint(int inode, int offset)
 {
-    uint16_t addr;
+    uint8_t *line;
 
-    addr = inode * INODESIZE + offset;
-    return read8uint(addr);
+    line = inodeCacheLine(inode);
+    return line[offset];
 }
 
 //-------------------------------------------------------------------------
 int8_t fsread8int(int inode, int offset)
 {
-    uint16_t addr;
-
-    addr = inode * INODESIZE + offset;
-    return read8int(addr);
+    return (int8_t) fsread8uint(inode, offset);
 }
 
 //-------------------------------------------------------------------------
 uint16_t fsread16uint(int inode, int offset)
 {
-    uint16_t addr;
+    uint8_t *line;
 
-    addr = inode * INODESIZE + offset;
-    return read16uint(addr);
+    line = inodeCacheLine(inode);
+    return (uint16_t) line[offset] + ((uint16_t) line[offset + 1] << 8);
 }
 
 //-------------------------------------------------------------------------
 int16_t fsread16int(int inode, int offset)
 {
-    uint16_t addr;
-
-    addr = inode * INODESIZE + offset;
-    return read16int(addr);
+    return (int16_t) fsread16uint(inode, offset);
 }
 
 //-------------------------------------------------------------------------
 uint32_t fsread32uint(int inode, int offset)
 {
-    uint16_t addr;
+    uint8_t *line;
 
-    addr = inode * INODESIZE + offset;
-    return read32uint(addr);
+    line = inodeCacheLine(inode);
+    return (uint32_t) line[offset] + ((uint32_t) line[offset + 1] << 8) +
+        ((uint32_t) line[offset + 2] << 16) +
+        ((uint32_t) line[offset + 3] << 24);
 }
 
 //-------------------------------------------------------------------------
 int32_t fsread32int(int inode, int offset)
 {
-    uint16_t addr;
-
-    addr = inode * INODESIZE + offset;
-    return read32int(addr);
+    return (int32_t) fsread32uint(inode, offset);
 }
 
 //-------------------------------------------------------------------------
 void fswrite8uint(int inode, int offset, uint8_t value)
 {
-    uint16_t addr;
+    uint8_t *line;
 
-    addr = inode * INODESIZE + offset;
-    write8uint(addr, value);
+    line = inodeCacheLine(inode);
+    line[offset] = value;
+    inodeCacheMarkDirty(inode, offset, 1);
 }
 
 //-------------------------------------------------------------------------
 void fswrite8int(int inode, int offset, int8_t value)
 {
-    uint16_t addr;
-
-    addr = inode * INODESIZE + offset;
-    write8int(addr, value);
+    fswrite8uint(inode, offset, (uint8_t) value);
 }
 
 //-------------------------------------------------------------------------
 void fswrite16uint(int inode, int offset, uint16_t value)
 {
-    uint16_t addr;
+    uint8_t *line;
 
-    addr = inode * INODESIZE + offset;
-    write16uint(addr, value);
+    line = inodeCacheLine(inode);
+    line[offset] = (uint8_t) value;
+    line[offset + 1] = (uint8_t) (value >> 8);
+    inodeCacheMarkDirty(inode, offset, 2);
 }
 
 //-------------------------------------------------------------------------
 void fswrite16int(int inode, int offset, int16_t value)
 {
-    uint16_t addr;
-
-    addr = inode * INODESIZE + offset;
-    write16int(addr, value);
+    fswrite16uint(inode, offset, (uint16_t) value);
 }
 
 //-------------------------------------------------------------------------
 void fswrite32uint(int inode, int offset, uint32_t value)
 {
-    uint16_t addr;
-
-    addr = inode * INODESIZE + offset;
-    write32uint(addr, value);
+    uint8_t *line;
+    uint8_t i;
+
+    line = inodeCacheLine(inode);
+    for (i = 0; i < 4; i++)
+    {
+        line[offset + i] = (uint8_t) value;
+        value >>= 8;
+    }
+    inodeCacheMarkDirty(inode, offset, 4);
 }
 
 //-------------------------------------------------------------------------
 void fswrite32int(int inode, int offset, int32_t value)
 {
-    uint16_t addr;
-
-    addr = inode * INODESIZE + offset;
-    write32uint(addr, value);
+    fswrite32uint(inode, offset, (uint32_t) value);
 }
 
 //-------------------------------------------------------------------------
 void fsreadBytes(int inode, int offset, int nBytes, void *buffer)
 {
-    uint16_t addr;
-
-    addr = inode * INODESIZE + offset;
-    genericreadBytes(addr, nBytes, buffer);
+    uint8_t *line;
+    uint8_t *p;
+    int i;
+
+    line = inodeCacheLine(inode);
+    p = (uint8_t *) buffer;
+    for (i = 0; i < nBytes; i++)
+    {
+        p[i] = line[offset + i];
+    }
 }
 
 //-------------------------------------------------------------------------
 void fswriteBytes(int inode, int offset, int nBytes, void *buffer)
 {
-    uint16_t addr;
-
-    addr = inode * INODESIZE + offset;
-    genericwriteBytes(addr, nBytes, buffer);
+    uint8_t *line;
+    uint8_t *p;
+    int i;
+
+    line = inodeCacheLine(inode);
+    p = (uint8_t *) buffer;
+    for (i = 0; i < nBytes; i++)
+    {
+        line[offset + i] = p[i];
+    }
+    inodeCacheMarkDirty(inode, offset, nBytes);
 }
 
 //-------------------------------------------------------------------------
 void fsinitBytes(int inode, int offset, int nBytes, uint8_t value)
 {
-    uint16_t addr;
+    uint8_t *line;
+    int i;
+
+    line = inodeCacheLine(inode);
+    for (i = 0; i < nBytes; i++)
+    {
+        line[offset + i] = value;
+    }
+    inodeCacheMarkDirty(inode, offset, nBytes);
+}
+
+//-------------------------------------------------------------------------
+int32_t fsreadFileSize(int inode)
+{
+    return (int32_t) fsread16uint(inode, FILE_SIZEOFFSET) +
+        ((int32_t) fsread16uint(inode, FILE_SIZEHIGHOFFSET) << 16);
+}
+
+//-------------------------------------------------------------------------
+void fswriteFileSize(int inode, int32_t size)
+{
+    fswrite16uint(inode, FILE_SIZEOFFSET, (uint16_t) size);
+    fswrite16uint(inode, FILE_SIZEHIGHOFFSET, (uint16_t) (size >> 16));
+}
+
+//-------------------------------------------------------------------------
+uint16_t fsreadFileSector(int inode, int slot)
+{
+    uint16_t sector;
+
+    sector = fsread8uint(inode, FILE_ADDRPAGEOFFSET + slot);
+    if (fsread8uint(inode, FILE_SECTORHIGHOFFSET) & (1 << slot))
+    {
+        sector += 256;
+    }
+    return sector;
+}
 
-    addr = inode * INODESIZE + offset;
-    initBytes(addr, nBytes, value);
+//-------------------------------------------------------------------------
+void fswriteFileSector(int inode, int slot, uint16_t sector)
+{
+    uint8_t high;
+
+    fswrite8uint(inode, FILE_ADDRPAGEOFFSET + slot, (uint8_t) sector);
+    high = fsread8uint(inode, FILE_SECTORHIGHOFFSET);
+    if (sector & 0x100)
+    {
+        high |= 1 << slot;
+    }
+    else
+    {
+        high &= ~(1 << slot);
+    }
+    fswrite8uint(inode, FILE_SECTORHIGHOFFSET, high);
 }
@@ -23,6 +23,21 @@
 /** @brief The total number of inodes. */
 #define INODENUM 96
 
+/** @brief The on-flash format revision written by formatSystem(). Revision 2 added 32-bit file sizes and 9-bit sector ids, revision 3 the name hash table, revision 4 the metadata journal; older file systems are migrated in place when mounted. */
+#define FS_REVISION 4
+
+/** @brief The number of 2KB flash sectors managed by the file system, 8 flash pages each. 256 covers the whole AT45DB041, and is also the most the byte storage keeps vectors and erase counters for. */
+#ifndef FLASH_SECTOR_NUM
+#define FLASH_SECTOR_NUM 256
+#endif
+
+#if FLASH_SECTOR_NUM > 256
+#error "the flash vector, the shared vector and the erase counters in the byte storage hold at most 256 sectors"
+#endif
+
+/** @brief The largest file the flash can hold. */
+#define FILE_MAX_SIZE ((int32_t) FLASH_SECTOR_NUM * 2048)
+
 /**@}*/
 
 /** \addtogroup filesystem */
@@ -46,9 +61,12 @@
 /** @brief Node type structures. */
      enum
      {
-         DIRNODE = 1, FILENODE = 2, DEVNODE = 3, APPNODE = 4,
+         DIRNODE = 1, FILENODE = 2, DEVNODE = 3, APPNODE = 4, EXTNODE = 5,
+         DIREXTNODE = 6,
      };
 
+/** @brief EXTNODE marks the unnamed continuation inodes of a file's sector chain, so that they are accounted for when the file system is mounted. DIREXTNODE marks the continuation blocks of a directory that has outgrown its 10 child slots. */
+
 /** @brief The file name offset. */
 #define FILENAMEOFFSET 0
 
@@ -88,16 +106,18 @@ struct filenode
     uint8_t type;
     uint8_t valid;
     uint8_t addr_page[8];
-    uint16_t endpageuse;
+    uint16_t sizehigh;
     uint8_t next;
-    uint8_t protect_rwx[3];
+    uint8_t sectorhigh;
+    uint8_t protect_rwx;
+    uint8_t logepoch;
     uint8_t uid;
     uint16_t size;
     uint8_t parent;
 };
 
 #define FILE_ADDRPAGEOFFSET 14
-#define FILE_ENDPAGEUSEOFFSET 22
+#define FILE_SIZEHIGHOFFSET 22
 #define FILE_EXTRAOFFSET 24
 #define FILE_NEXTOFFSET 24
 #define FILE_PROTECTOFFSET 25
@@ -105,6 +125,34 @@ struct filenode
 #define FILE_SIZEOFFSET 29
 #define FILE_PARENTOFFSET 31
 
+/** @brief The ninth bit of each of the 8 sector ids in addr_page, one bit per slot. It takes the first protection byte. */
+#define FILE_SECTORHIGHOFFSET 25
+
+/** @brief The log epoch of a file opened in log mode, 0 for ordinary files. It takes the last protection byte. */
+#define FILE_LOGOFFSET 27
+
+/** @brief The flags of a file. It takes the middle protection byte. */
+#define FILE_FLAGSOFFSET 26
+
+/** @brief The records of the log are stored compressed (see logfile.h). Only set while the log is empty. */
+#define FILE_FLAG_COMPRESSED 0x01
+
+/** @brief The file is a ring of fixed capacity (see ringfile.h). */
+#define FILE_FLAG_RING 0x02
+
+/** @brief The ring has been filled, so its oldest byte is at its head rather than at its start. */
+#define FILE_FLAG_WRAPPED 0x04
+
+/** @brief The number of chain inodes remembered per open file, each covering 8 sectors (16KB). */
+#ifndef FILE_CHAIN_CACHE_SIZE
+#define FILE_CHAIN_CACHE_SIZE 4
+#endif
+
+/** @brief The number of back-to-back sequential reads of an open file after which the page that follows is loaded ahead of the reader. */
+#ifndef READ_AHEAD_TRIGGER
+#define READ_AHEAD_TRIGGER 2
+#endif
+
 /** @brief The definition of the app node.  */
 struct appnode
 {
@@ -289,4 +337,32 @@ void fswriteBytes(int inode, int offset, int nBytes, void *buffer);
 
 
 void fsinitBytes(int inode, int offset, int nBytes, uint8_t value);
+
+/** @brief Read the 32-bit size of a file, kept as a low half at FILE_SIZEOFFSET and a high half at FILE_SIZEHIGHOFFSET.
+	@param inode The inode number.
+	@return The file size.
+*/
+int32_t fsreadFileSize(int inode);
+
+/** @brief Write the 32-bit size of a file.
+	@param inode The inode number.
+	@param size The file size.
+	@return Void.
+*/
+void fswriteFileSize(int inode, int32_t size);
+
+/** @brief Read a sector id from the sector table of a file or continuation inode.
+	@param inode The inode number.
+	@param slot The slot, 0 to 7.
+	@return The sector id, 0 if the slot is empty.
+*/
+uint16_t fsreadFileSector(int inode, int slot);
+
+/** @brief Write a sector id into the sector table of a file or continuation inode.
+	@param inode The inode number.
+	@param slot The slot, 0 to 7.
+	@param sector The sector id, 0 to empty the slot.
+	@return Void.
+*/
+void fswriteFileSector(int inode, int slot, uint16_t sector);
 #endif
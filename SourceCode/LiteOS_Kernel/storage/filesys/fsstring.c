@@ -76,6 +76,16 @@ int fileMode(char *s)
         {
             return 4;
         }
+
+        if (s[0] == 'l')
+        {
+            return 6;
+        }
+
+        if (s[0] == 'c')
+        {
+            return 7;
+        }
     }
     else if (mystrlen(s) == 2)
     {
@@ -87,3 +97,32 @@ int fileMode(char *s)
     }
     return 0;
 }
+
+//-------------------------------------------------------------------------
+uint8_t nameHash(char *name)
+{
+    uint8_t hash;
+    uint8_t i;
+
+    hash = 0;
+    for (i = 0; (i < 12) && (name[i] != '\0'); i++)
+    {
+        hash = hash * 31 + (uint8_t) name[i];
+    }
+    return hash;
+}
+
+//-------------------------------------------------------------------------
+uint16_t nameSignature(char *name)
+{
+    uint16_t signature;
+    uint8_t i, pair;
+
+    signature = 0;
+    for (i = 0; (i < 11) && (name[i] != '\0') && (name[i + 1] != '\0'); i++)
+    {
+        pair = (uint8_t) name[i] * 7 + (uint8_t) name[i + 1];
+        signature |= (uint16_t) 1 << ((pair ^ (pair >> 4)) & 15);
+    }
+    return signature;
+}
@@ -7,6 +7,7 @@
 
 #ifndef FSSTRINGH
 #define FSSTRINGH
+#include "../../types/types.h"
 
 /** \addtogroup filesystem */
 
@@ -31,5 +32,18 @@ char *extractLastName(char *pathname);
 */
 int fileMode(char *s);
 
+/** @brief Hash a single-level file name into 8 bits. Only the first 12 characters are used, as in the inode.
+	@param name The file name.
+	@return The hash.
+*/
+uint8_t nameHash(char *name);
+
+/** @brief Compute the signature of a file name, with one of 16 bits set for every pair of adjacent characters.
+	Every string found in a name has a signature whose bits are all set in the signature of the name. Only the first 12 characters are used, as in the inode.
+	@param name The file name or the string searched for.
+	@return The signature.
+*/
+uint16_t nameSignature(char *name);
+
 /**@}*/
 #endif
@@ -10,6 +10,15 @@
 #include "vectornode.h"
 #include "vectorflash.h"
 #include "../flash/pagestorage.h"
+#include "../bytestorage/bytestorage.h"
+#include "storageconstants.h"
+#include "fsstring.h"
+#include "stdfsa.h"
+#include "journal.h"
+#include "fsapi.h"
+
+//the name signature of every inode but the root, kept for search (see nameSignature())
+static uint16_t namesignature[INODENUM];
 
 
 
@@ -43,6 +52,8 @@ void buildNewNode(int addr, char *name, uint8_t uid, uint8_t parent, uint8_t
     {
         namelength++;
     }
+    setNodeHash(addr, name);
+    invalidatePathCache();
     //consider several types of type
     if (type == DIRNODE)
     {
@@ -89,19 +100,7 @@ void buildNewNode(int addr, char *name, uint8_t uid, uint8_t parent, uint8_t
     }
     else
     {
-        int i;
-
-        for (i = 0; i < 10; i++)
-        {
-            uint8_t subaddr;
-
-            subaddr = fsread8uint(parent, DIR_ADDRSUBOFFSET + i);
-            if (subaddr == 0)
-            {
-                fswrite8uint(parent, DIR_ADDRSUBOFFSET + i, addr);
-                break;
-            }
-        }
+        addChildNode(parent, addr);
     }
     return;
 }
@@ -163,6 +162,10 @@ void formatFS()
     {
         fsinitBytes(i, 0, 32, 0);
     }
+    for (i = 0; i < INODENUM; i++)
+    {
+        namesignature[i] = 0;
+    }
     //  write8uint(i, VALIDOFFSET, 0); 
     initVectorFlash();
     initVectorNode();
@@ -180,157 +183,122 @@ void deleteNode(int addr)
 {
     uint8_t type;
     uint8_t parent;
+    int child;
 
     type = fsread8uint(addr, TYPEOFFSET);
     parent = fsread8uint(addr, 31);
+    invalidatePathCache();
     if (type == DIRNODE)
     {
-        uint8_t i;
-
-        for (i = 0; i < 10; i++)
-        {
-            uint8_t subaddr;
-
-            subaddr = fsread8uint(addr, DIR_ADDRSUBOFFSET + i);
-            if (subaddr > 0)
-            {
-                deleteNode(subaddr);
-            }
-        }
-        fswrite8uint(addr, VALIDOFFSET, 0);
-        if ((addr == 0) && (parent == 0))
+        //each deletion unlinks the child, releasing continuation blocks as they empty
+        while ((child = firstChildNode(addr)) > 0)
         {
-        }
-        else
-        {
-            uint8_t i;
-
-            for (i = 0; i < 10; i++)
-            {
-                uint8_t subaddr;
-
-                subaddr = fsread8uint(parent, DIR_ADDRSUBOFFSET + i);
-                if (subaddr == addr)
-                {
-                    fswrite8uint(parent, DIR_ADDRSUBOFFSET + i, 0);
-                    break;
-                }
-            }
+            deleteNode(child);
         }
     }
-    else if (type == FILENODE)
+    fswrite8uint(addr, VALIDOFFSET, 0);
+    if ((addr == 0) && (parent == 0))
     {
-        char i;
-        uint8_t readpage;
+    }
+    else
+    {
+        removeChildNode(parent, addr);
+    }
+    if (addr > 0)
+    {
+        namesignature[addr - 1] = 0;
+    }
+    if (type == FILENODE)
+    {
+        releaseFileChain(addr);
+    }
+    releaseVectorNode(addr);
+}
 
-        fswrite8uint(addr, VALIDOFFSET, 0);
-        if ((addr == 0) && (parent == 0))
-        {
-        }
-        else
-        {
-            for (i = 0; i < 10; i++)
-            {
-                uint8_t subaddr;
-
-                subaddr = fsread8uint(parent, DIR_ADDRSUBOFFSET + i);
-                if (subaddr == addr)
-                {
-                    fswrite8uint(parent, DIR_ADDRSUBOFFSET + i, 0);
-                    break;
-                }
-            }
-        }
+//-------------------------------------------------------------------------
+void releaseFileChain(int addr)
+{
+    uint8_t i;
+    uint16_t readpage;
+    uint8_t currentaddr, next;
+
+    currentaddr = addr;
+    while (currentaddr > 0)
+    {
         for (i = 0; i < 8; i++)
         {
-            readpage = fsread8uint(addr, FILE_ADDRPAGEOFFSET + i);
+            readpage = fsreadFileSector(currentaddr, i);
             if (readpage == 0)
             {
                 break;
             }
-            else
-            {
-                releaseFlashPage(readpage);
-            }
+            fmapmoved(readpage);
+            dropFlashPage(readpage, addr);
         }
+        next = fsread8uint(currentaddr, FILE_NEXTOFFSET);
+        if (currentaddr != addr)
         {
-            uint8_t currentaddr;
-
-            currentaddr = addr;
-            while (1)
-            {
-                currentaddr = fsread8uint(currentaddr, FILE_NEXTOFFSET);
-                if (currentaddr > 0)
-                {
-                    releaseVectorNode(currentaddr);
-                    for (i = 0; i < 8; i++)
-                    {
-                        readpage =
-                            fsread8uint(currentaddr, FILE_ADDRPAGEOFFSET + i);
-                        if (readpage == 0)
-                        {
-                            break;
-                        }
-                        else
-                        {
-                            releaseFlashPage(readpage);
-                        }
-                    }
-                }
-                else
-                {
-                    break;
-                }
-            }
+            fswrite8uint(currentaddr, VALIDOFFSET, 0);
+            releaseVectorNode(currentaddr);
         }
+        currentaddr = next;
     }
-    else if (type == DEVNODE)
-    {
-        fswrite8uint(addr, VALIDOFFSET, 0);
-        if ((addr == 0) && (parent == 0))
-        {
-        }
-        else
-        {
-            int i;
+    fsinitBytes(addr, FILE_ADDRPAGEOFFSET, 8, 0);
+    fswrite8uint(addr, FILE_NEXTOFFSET, 0);
+    fswrite8uint(addr, FILE_SECTORHIGHOFFSET, 0);
+}
 
-            for (i = 0; i < 10; i++)
-            {
-                uint8_t subaddr;
-
-                subaddr = fsread8uint(parent, DIR_ADDRSUBOFFSET + i);
-                if (subaddr == addr)
-                {
-                    fswrite8uint(parent, DIR_ADDRSUBOFFSET + i, 0);
-                    break;
-                }
-            }
-        }
+//-------------------------------------------------------------------------
+void setNodeHash(int addr, char *name)
+{
+    uint8_t hash;
+
+    if (addr > 0)
+    {
+        namesignature[addr - 1] = nameSignature(name);
     }
-    else if (type == APPNODE)
+    hash = nameHash(name);
+    //the hash commits with the name it belongs to
+    journalWrite(NAMEHASHSTART + addr, 1, &hash);
+}
+
+//-------------------------------------------------------------------------
+uint8_t getNodeHash(int addr)
+{
+    uint8_t hash;
+
+    journalRead(NAMEHASHSTART + addr, 1, &hash);
+    return hash;
+}
+
+//-------------------------------------------------------------------------
+void buildNameIndex()
+{
+    char name[13];
+    uint8_t addr, type, hash;
+
+    for (addr = 1; addr <= INODENUM; addr++)
     {
-        fswrite8uint(addr, VALIDOFFSET, 0);
-        if ((addr == 0) && (parent == 0))
+        namesignature[addr - 1] = 0;
+        type = checkNodeValid(addr);
+        if ((type > 0) && (type != EXTNODE) && (type != DIREXTNODE))
         {
-        }
-        else
-        {
-            int i;
-
-            for (i = 0; i < 10; i++)
+            getName(name, addr);
+            namesignature[addr - 1] = nameSignature(name);
+            //a file system written before the hashes were journaled may hold a hash that does not match the name
+            hash = nameHash(name);
+            if (getNodeHash(addr) != hash)
             {
-                uint8_t subaddr;
-
-                subaddr = fsread8uint(parent, DIR_ADDRSUBOFFSET + i);
-                if (subaddr == addr)
-                {
-                    fswrite8uint(parent, DIR_ADDRSUBOFFSET + i, 0);
-                    break;
-                }
+                journalWrite(NAMEHASHSTART + addr, 1, &hash);
             }
         }
     }
-    releaseVectorNode(addr);
+}
+
+//-------------------------------------------------------------------------
+uint8_t nodeSignatureMatch(uint8_t addr, uint16_t signature)
+{
+    return (namesignature[addr - 1] & signature) == signature;
 }
 
 //-------------------------------------------------------------------------
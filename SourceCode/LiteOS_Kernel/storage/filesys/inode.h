@@ -139,5 +139,46 @@ void copyVectorPage(int from, int to);
 
 void formatFSLite();
 
+/** @ingroup filesystem
+	@brief Release the flash sectors and continuation inodes of a file. The file inode itself stays valid with no sectors.
+	@param addr The address of the file inode. 
+	@return Void.
+*/
+
+void releaseFileChain(int addr);
+
+/** @ingroup filesystem
+	@brief Record the hash and the signature of the name of a node, which directory lookups and search check before reading the name itself. Every change of a node name must be followed by this call.
+	@param addr The address of the node.
+	@param name The name of the node.
+	@return Void.
+*/
+
+void setNodeHash(int addr, char *name);
+
+/** @ingroup filesystem
+	@brief Get the hash of the name of a node.
+	@param addr The address of the node.
+	@return The hash recorded by setNodeHash().
+*/
+
+uint8_t getNodeHash(int addr);
+
+/** @ingroup filesystem
+	@brief Rebuild the name signatures that search checks before reading the name of a node. They are kept in RAM, so this is called at mount. Stored name hashes that do not match the names are rewritten.
+	@return Void.
+*/
+
+void buildNameIndex();
+
+/** @ingroup filesystem
+	@brief Whether the name of a node may hold a string, by its name signature. A node that passes still has to be matched by inodeMatch().
+	@param addr The address of the node, from 1 to INODENUM.
+	@param signature The name signature of the string.
+	@return True or false.
+*/
+
+uint8_t nodeSignatureMatch(uint8_t addr, uint16_t signature);
+
 /**@}*/
 #endif
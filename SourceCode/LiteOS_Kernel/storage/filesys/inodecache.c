@@ -0,0 +1,158 @@
+/** @file inodecache.c
+	 @brief This file implements the RAM-resident write-back cache for inodes.
+
+	 Every inode field access used to go to the EEPROM one byte at a time. The cache keeps the most recently used
+	 inodes in RAM, tracks modified bytes with a per-inode bit mask, and writes only those bytes back when an entry
+	 is evicted or when the file system reaches a sync point (see fsync2()). Replacement uses the clock algorithm.
+	 Written bytes go into the open journal transaction (see journal.h), and misses read through it, so an inode
+	 evicted between sync points still only reaches its place when the transaction commits.
+*/
+
+#include "inodecache.h"
+#include "fsconfig.h"
+#include "journal.h"
+
+typedef struct
+{
+    uint8_t tag;                //inode number plus one, 0 for an empty entry
+    uint8_t referenced;
+    uint32_t dirtymask;         //one bit per byte of the inode
+    uint8_t data[INODESIZE];
+} inodecacheentry;
+
+static inodecacheentry inodecache[INODE_CACHE_SIZE];
+static uint8_t clockhand;
+static uint16_t cachehits, cachemisses;
+
+//-------------------------------------------------------------------------
+static void writeBackEntry(inodecacheentry * entry)
+{
+    uint16_t base;
+    uint8_t start, end;
+
+    if (entry->dirtymask == 0)
+    {
+        return;
+    }
+    base = (uint16_t) (entry->tag - 1) * INODESIZE;
+    start = 0;
+    while (start < INODESIZE)
+    {
+        if ((entry->dirtymask & ((uint32_t) 1 << start)) == 0)
+        {
+            start++;
+            continue;
+        }
+        //write contiguous runs of modified bytes in one block operation
+        end = start + 1;
+        while ((end < INODESIZE)
+               && (entry->dirtymask & ((uint32_t) 1 << end)))
+        {
+            end++;
+        }
+        journalWrite(base + start, end - start, &entry->data[start]);
+        start = end;
+    }
+    entry->dirtymask = 0;
+}
+
+//-------------------------------------------------------------------------
+static inodecacheentry *findEntry(int inode)
+{
+    uint8_t i;
+
+    for (i = 0; i < INODE_CACHE_SIZE; i++)
+    {
+        if (inodecache[i].tag == (uint8_t) (inode + 1))
+        {
+            return &inodecache[i];
+        }
+    }
+    return NULL;
+}
+
+//-------------------------------------------------------------------------
+uint8_t *inodeCacheLine(int inode)
+{
+    inodecacheentry *entry;
+
+    entry = findEntry(inode);
+    if (entry != NULL)
+    {
+        cachehits++;
+        entry->referenced = 1;
+        return entry->data;
+    }
+    cachemisses++;
+    //clock replacement: skip entries referenced since the hand last passed
+    while (1)
+    {
+        entry = &inodecache[clockhand];
+        clockhand++;
+        if (clockhand == INODE_CACHE_SIZE)
+        {
+            clockhand = 0;
+        }
+        if ((entry->tag == 0) || (entry->referenced == 0))
+        {
+            break;
+        }
+        entry->referenced = 0;
+    }
+    writeBackEntry(entry);
+    journalRead((uint16_t) inode * INODESIZE, INODESIZE, entry->data);
+    entry->tag = (uint8_t) (inode + 1);
+    entry->referenced = 1;
+    return entry->data;
+}
+
+//-------------------------------------------------------------------------
+void inodeCacheMarkDirty(int inode, int offset, int nBytes)
+{
+    inodecacheentry *entry;
+
+    entry = findEntry(inode);
+    if (entry == NULL)
+    {
+        return;
+    }
+    while (nBytes > 0)
+    {
+        entry->dirtymask |= (uint32_t) 1 << offset;
+        offset++;
+        nBytes--;
+    }
+}
+
+//-------------------------------------------------------------------------
+void inodeCacheSync()
+{
+    uint8_t i;
+
+    for (i = 0; i < INODE_CACHE_SIZE; i++)
+    {
+        if (inodecache[i].tag > 0)
+        {
+            writeBackEntry(&inodecache[i]);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+void inodeCacheInvalidate()
+{
+    uint8_t i;
+
+    for (i = 0; i < INODE_CACHE_SIZE; i++)
+    {
+        inodecache[i].tag = 0;
+        inodecache[i].dirtymask = 0;
+    }
+}
+
+//-------------------------------------------------------------------------
+void inodeCacheStatistics(uint16_t * hits, uint16_t * misses)
+{
+    *hits = cachehits;
+    *misses = cachemisses;
+}
@@ -0,0 +1,53 @@
+/** @file inodecache.h
+	 @brief This file declares the RAM-resident write-back cache for inodes.
+*/
+
+
+#ifndef INODECACHEH
+#define INODECACHEH
+#include "../../types/types.h"
+
+/** \addtogroup filesystem */
+
+/** @{ */
+
+/** @brief The number of inodes kept in RAM. Each entry costs INODESIZE plus 6 bytes. */
+#ifndef INODE_CACHE_SIZE
+#define INODE_CACHE_SIZE 4
+#endif
+
+/** @brief Get the cached copy of an inode, loading it from the byte storage on a miss.
+	The pointer stays valid until the next call into the cache.
+	@param inode The inode number.
+	@return The pointer to the INODESIZE bytes of the inode.
+*/
+uint8_t *inodeCacheLine(int inode);
+
+/** @brief Mark a range of a cached inode as modified.
+	@param inode The inode number, which must have just been returned by inodeCacheLine().
+	@param offset The offset.
+	@param nBytes The number of bytes.
+	@return Void.
+*/
+void inodeCacheMarkDirty(int inode, int offset, int nBytes);
+
+/** @brief Write all modified inode bytes back into the open journal transaction.
+	They reach the byte storage when the transaction is committed.
+	@return Void.
+*/
+void inodeCacheSync();
+
+/** @brief Drop all cached inodes without writing them back.
+	@return Void.
+*/
+void inodeCacheInvalidate();
+
+/** @brief Get the hit and miss counters of the cache.
+	@param hits The number of lookups served from RAM.
+	@param misses The number of lookups that went to the byte storage.
+	@return Void.
+*/
+void inodeCacheStatistics(uint16_t * hits, uint16_t * misses);
+
+/** @} */
+#endif
@@ -0,0 +1,248 @@
+/** @file journal.c
+	 @brief This file implements the redo journal for file system metadata.
+
+	 Inode and allocation bitmap updates are collected as records in a ring in the byte storage and written into
+	 place only after the whole transaction has been committed, so that a reset leaves the metadata either before or
+	 after a sync point. A transaction is laid out as a header followed by its records:
+
+	 [length lo][length hi][check][seq lo][seq hi] { [addr lo][addr hi][n][n bytes] }
+
+	 The header is written last. Transactions follow each other from the start of the ring, with consecutive sequence
+	 numbers, until one does not fit and the ring starts over with it. Because a transaction is written into place right
+	 after it commits, mounting only has to replay the last one in the chain.
+
+	 A transaction larger than the whole ring is committed in parts. The high bit of the length marks every part but
+	 the last, so that mounting can tell when a reset left the metadata between two parts.
+*/
+
+#include "journal.h"
+#include "storageconstants.h"
+#include "../bytestorage/bytestorage.h"
+
+#define JOURNAL_HEADER 5
+#define JOURNAL_CONTINUED 0x8000
+
+static uint16_t journalhead;    //offset of the header of the open transaction
+static uint16_t journalfill;    //bytes of records in the open transaction
+static uint16_t journalseq;     //sequence number of the last committed transaction
+static uint8_t journalcheck;    //check value of the records in the open transaction
+
+//-------------------------------------------------------------------------
+static uint8_t journalUpdateCheck(uint8_t check, uint8_t * data, int nBytes)
+{
+    while (nBytes > 0)
+    {
+        check = (uint8_t) ((check << 1) | (check >> 7)) ^ *data++;
+        nBytes--;
+    }
+    return check;
+}
+
+//-------------------------------------------------------------------------
+//write the records of the transaction at offset into place, or only compute their check value
+static uint8_t journalApply(uint16_t offset, uint16_t length, uint8_t write)
+{
+    uint8_t record[3 + JOURNAL_RECORD_MAX];
+    uint16_t pos;
+    uint8_t check;
+
+    check = 0;
+    pos = 0;
+    while (pos < length)
+    {
+        genericreadBytes(JOURNALSTART + offset + JOURNAL_HEADER + pos, 3,
+                         record);
+        if ((record[2] > JOURNAL_RECORD_MAX) || (pos + 3 + record[2] > length))
+        {
+            return ~check;
+        }
+        genericreadBytes(JOURNALSTART + offset + JOURNAL_HEADER + pos + 3,
+                         record[2], record + 3);
+        check = journalUpdateCheck(check, record, 3 + record[2]);
+        if (write)
+        {
+            genericwriteBytes(record[0] | ((uint16_t) record[1] << 8),
+                              record[2], record + 3);
+        }
+        pos += 3 + record[2];
+    }
+    return check;
+}
+
+//-------------------------------------------------------------------------
+static void journalClose(uint16_t flags)
+{
+    uint8_t header[JOURNAL_HEADER];
+
+    if (journalfill == 0)
+    {
+        return;
+    }
+    journalseq++;
+    header[0] = (uint8_t) journalfill;
+    header[1] = (uint8_t) ((journalfill | flags) >> 8);
+    header[2] = journalcheck;
+    header[3] = (uint8_t) journalseq;
+    header[4] = (uint8_t) (journalseq >> 8);
+    genericwriteBytes(JOURNALSTART + journalhead, JOURNAL_HEADER, header);
+    //the transaction is durable once its header is; writing it into place can finish in the background
+    genericflushBytes();
+    journalApply(journalhead, journalfill, 1);
+    journalhead += JOURNAL_HEADER + journalfill;
+    journalfill = 0;
+    journalcheck = 0;
+}
+
+//-------------------------------------------------------------------------
+//move the open transaction to the start of the ring; every earlier transaction is already in place
+static void journalRestart()
+{
+    uint8_t chunk[JOURNAL_RECORD_MAX];
+    uint16_t pos;
+    uint8_t count;
+
+    chunk[0] = 0xff;
+    chunk[1] = 0xff;
+    genericwriteBytes(JOURNALSTART, 2, chunk);
+    //the target lies below the source, so copying upwards never overwrites records not yet moved
+    for (pos = 0; pos < journalfill; pos += count)
+    {
+        count = journalfill - pos > sizeof(chunk) ? sizeof(chunk) :
+            journalfill - pos;
+        genericreadBytes(JOURNALSTART + journalhead + JOURNAL_HEADER + pos,
+                         count, chunk);
+        genericwriteBytes(JOURNALSTART + JOURNAL_HEADER + pos, count, chunk);
+    }
+    journalhead = 0;
+}
+
+//-------------------------------------------------------------------------
+void journalWrite(uint16_t addr, int nBytes, void *buffer)
+{
+    uint8_t record[3];
+    uint8_t count;
+    uint8_t *p;
+
+    p = (uint8_t *) buffer;
+    while (nBytes > 0)
+    {
+        count = nBytes > JOURNAL_RECORD_MAX ? JOURNAL_RECORD_MAX : nBytes;
+        if ((journalhead > 0)
+            && (journalhead + JOURNAL_HEADER + journalfill + 3 + count >
+                JOURNALSIZE))
+        {
+            journalRestart();
+        }
+        if (JOURNAL_HEADER + journalfill + 3 + count > JOURNALSIZE)
+        {
+            //only a transaction larger than the whole ring is committed in parts
+            journalClose(JOURNAL_CONTINUED);
+            journalReset();
+        }
+        record[0] = (uint8_t) addr;
+        record[1] = (uint8_t) (addr >> 8);
+        record[2] = count;
+        genericwriteBytes(JOURNALSTART + journalhead + JOURNAL_HEADER +
+                          journalfill, 3, record);
+        genericwriteBytes(JOURNALSTART + journalhead + JOURNAL_HEADER +
+                          journalfill + 3, count, p);
+        journalcheck = journalUpdateCheck(journalcheck, record, 3);
+        journalcheck = journalUpdateCheck(journalcheck, p, count);
+        journalfill += 3 + count;
+        addr += count;
+        p += count;
+        nBytes -= count;
+    }
+}
+
+//-------------------------------------------------------------------------
+void journalRead(uint16_t addr, int nBytes, void *buffer)
+{
+    uint8_t record[3];
+    uint16_t pos, start, end, from, to;
+
+    genericreadBytes(addr, nBytes, buffer);
+    //later records override earlier ones, as they will when written into place
+    pos = 0;
+    while (pos < journalfill)
+    {
+        genericreadBytes(JOURNALSTART + journalhead + JOURNAL_HEADER + pos, 3,
+                         record);
+        start = record[0] | ((uint16_t) record[1] << 8);
+        end = start + record[2];
+        from = start > addr ? start : addr;
+        to = end < addr + nBytes ? end : addr + nBytes;
+        if (from < to)
+        {
+            genericreadBytes(JOURNALSTART + journalhead + JOURNAL_HEADER +
+                             pos + 3 + (from - start), to - from,
+                             (uint8_t *) buffer + (from - addr));
+        }
+        pos += 3 + record[2];
+    }
+}
+
+//-------------------------------------------------------------------------
+void journalCommit()
+{
+    journalClose(0);
+}
+
+//-------------------------------------------------------------------------
+int journalRecover()
+{
+    uint8_t header[JOURNAL_HEADER];
+    uint16_t offset, length, seq, last;
+    uint8_t found, complete;
+
+    offset = 0;
+    found = 0;
+    complete = 0;
+    last = 0;
+    while (offset + JOURNAL_HEADER <= JOURNALSIZE)
+    {
+        genericreadBytes(JOURNALSTART + offset, JOURNAL_HEADER, header);
+        length = (header[0] | ((uint16_t) header[1] << 8)) & ~JOURNAL_CONTINUED;
+        seq = header[3] | ((uint16_t) header[4] << 8);
+        if ((length == 0) || (length > JOURNALSIZE - offset - JOURNAL_HEADER))
+        {
+            break;
+        }
+        if ((found) && (seq != (uint16_t) (journalseq + 1)))
+        {
+            break;
+        }
+        if (journalApply(offset, length, 0) != header[2])
+        {
+            break;
+        }
+        found = 1;
+        complete = (header[1] & (JOURNAL_CONTINUED >> 8)) == 0;
+        journalseq = seq;
+        last = offset;
+        offset += JOURNAL_HEADER + length;
+    }
+    if (found)
+    {
+        genericreadBytes(JOURNALSTART + last, JOURNAL_HEADER, header);
+        journalApply(last, (header[0] | ((uint16_t) header[1] << 8)) &
+                     ~JOURNAL_CONTINUED, 1);
+    }
+    journalhead = offset;
+    journalfill = 0;
+    journalcheck = 0;
+    return complete;
+}
+
+//-------------------------------------------------------------------------
+void journalReset()
+{
+    uint8_t header[2];
+
+    header[0] = 0xff;
+    header[1] = 0xff;
+    genericwriteBytes(JOURNALSTART, 2, header);
+    journalhead = 0;
+    journalfill = 0;
+    journalcheck = 0;
+}
@@ -0,0 +1,50 @@
+/** @file journal.h
+	 @brief This file declares the redo journal for file system metadata.
+*/
+
+
+#ifndef JOURNALH
+#define JOURNALH
+#include "../../types/types.h"
+
+/** \addtogroup filesystem */
+
+/** @{ */
+
+/** @brief The longest record. Longer writes are split into several records. */
+#define JOURNAL_RECORD_MAX 32
+
+/** @brief Add a byte storage write to the open transaction.
+	The write reaches its place only when the transaction commits. If the journal runs out of room, the records collected so far are committed first.
+	@param addr The byte storage address.
+	@param nBytes The number of bytes.
+	@param buffer The data.
+	@return Void.
+*/
+void journalWrite(uint16_t addr, int nBytes, void *buffer);
+
+/** @brief Read from the byte storage as the open transaction would leave it.
+	@param addr The byte storage address.
+	@param nBytes The number of bytes.
+	@param buffer The target buffer.
+	@return Void.
+*/
+void journalRead(uint16_t addr, int nBytes, void *buffer);
+
+/** @brief Commit the open transaction and write its records into place.
+	@return Void.
+*/
+void journalCommit();
+
+/** @brief Find the last committed transaction and write it into place again, in case a reset interrupted it. Called when the file system is mounted.
+	@return 1 if the last transaction was committed whole, 0 if the journal is empty or ends with part of a transaction that outgrew it.
+*/
+int journalRecover();
+
+/** @brief Drop all journal contents. Called when the file system is formatted or migrated.
+	@return Void.
+*/
+void journalReset();
+
+/** @} */
+#endif
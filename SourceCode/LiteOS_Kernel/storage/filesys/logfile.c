@@ -0,0 +1,514 @@
+/** @file logfile.c
+	 @brief This file implements the log-structured mode for append-only files.
+
+	 A file opened with mode "l" is an append-only log. Every write becomes a record of LOG_HEADER_SIZE bytes of framing
+	 followed by the data, appended behind the last record through the flash write buffers. The size field of the inode
+	 is only written at sync points; after a reset, mounting walks the records that follow the synced size and stops at
+	 the first one whose CRC does not match, which gives back every record that reached the flash.
+
+	 A log opened with mode "c" stores its records compressed. The data is taken as little-endian 16-bit samples, and
+	 each sample is stored as the zigzag varint of its difference from the previous one, so a slowly varying reading
+	 takes one byte instead of two. Every record starts from zero and carries its decoded length, so a record decodes
+	 on its own and seeking to any record still works.
+*/
+
+#include "logfile.h"
+#include "fsconfig.h"
+#include "stdfsa.h"
+#include "fs_structure.h"
+#include "fsapi.h"
+#include "inode.h"
+#include "storageconstants.h"
+#include "../bytestorage/bytestorage.h"
+#include "../../utilities/crc.h"
+
+extern fid fidtable[MAX_FILE_TABLE_SIZE];
+
+//encoded bytes of a compressed record on their way to the flash, with the CRC over them
+typedef struct
+{
+    int fid;
+    int32_t pos;
+    uint16_t crc;
+    uint8_t fill;
+    uint8_t chunk[16];
+} logsink;
+
+//-------------------------------------------------------------------------
+//The CRC covers where the record belongs as well as its data, so that stale records of other logs never match
+static uint16_t logRecordCrc(uint8_t addr, uint8_t epoch, int32_t pos,
+                             uint8_t length)
+{
+    uint8_t prefix[6];
+
+    prefix[0] = addr;
+    prefix[1] = epoch;
+    prefix[2] = (uint8_t) pos;
+    prefix[3] = (uint8_t) (pos >> 8);
+    prefix[4] = (uint8_t) (pos >> 16);
+    prefix[5] = length;
+    return crcCcittBlock(CRC_INIT, prefix, 6);
+}
+
+//-------------------------------------------------------------------------
+uint8_t newLogEpoch()
+{
+    uint8_t epoch;
+
+    genericreadBytes(LOGEPOCHOFFSET, 1, &epoch);
+    epoch++;
+    if (epoch == 0)
+    {
+        epoch = 1;
+    }
+    genericwriteBytes(LOGEPOCHOFFSET, 1, &epoch);
+    return epoch;
+}
+
+//-------------------------------------------------------------------------
+//make room for a record of length bytes at the end of a log
+static int logReserve(MYFILE * fp, uint8_t length)
+{
+    int32_t sectors;
+
+    //avoid flash overflow
+    if (fp->size + LOG_HEADER_SIZE + length > FILE_MAX_SIZE)
+    {
+        return 2;
+    }
+    sectors = (fp->size + 2047) / 2048;
+    if ((reserveFileSpace(fp->index, fp->size + LOG_HEADER_SIZE + length) <
+         0)
+        || (unshareFileSpace(fp->index, fp->size,
+                             fp->size + LOG_HEADER_SIZE + length) < 0))
+    {
+        return 2;
+    }
+    //a new sector is made durable right away, so that recovery can reach the records placed in it
+    if ((fp->size + LOG_HEADER_SIZE + length + 2047) / 2048 > sectors)
+    {
+        fscommit();
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+//write the header of the record at the end of a log and count the record in the size
+static void logSeal(MYFILE * fp, uint8_t length, uint16_t crc)
+{
+    uint8_t header[LOG_HEADER_SIZE];
+
+    header[0] = length;
+    header[1] = (uint8_t) crc;
+    header[2] = (uint8_t) (crc >> 8);
+    transferFileBytes(fp->index, fp->size, header, LOG_HEADER_SIZE, 1);
+    fp->size += LOG_HEADER_SIZE + length;
+}
+
+//-------------------------------------------------------------------------
+static uint16_t logZigzag(uint16_t sample, uint16_t previous)
+{
+    uint16_t delta;
+
+    delta = (sample - previous) & 0xffff;
+    if (delta & 0x8000)
+    {
+        return ~(delta << 1) & 0xffff;
+    }
+    return (delta << 1) & 0xffff;
+}
+
+//-------------------------------------------------------------------------
+static uint8_t logVarintSize(uint16_t value)
+{
+    if (value < 0x80)
+    {
+        return 1;
+    }
+    if (value < 0x4000)
+    {
+        return 2;
+    }
+    return 3;
+}
+
+//-------------------------------------------------------------------------
+static void logSinkFlush(logsink * sink)
+{
+    sink->crc = crcCcittBlock(sink->crc, sink->chunk, sink->fill);
+    transferFileBytes(sink->fid, sink->pos, sink->chunk, sink->fill, 1);
+    sink->pos += sink->fill;
+    sink->fill = 0;
+}
+
+//-------------------------------------------------------------------------
+static void logSinkPut(logsink * sink, uint8_t byte)
+{
+    sink->chunk[sink->fill++] = byte;
+    if (sink->fill == sizeof(sink->chunk))
+    {
+        logSinkFlush(sink);
+    }
+}
+
+//-------------------------------------------------------------------------
+static int logAppendCompressed(MYFILE * fp, uint8_t * p, int nBytes,
+                               uint8_t epoch)
+{
+    logsink sink;
+    uint16_t sample, previous, value;
+    uint8_t length, size;
+    int count, i;
+
+    while (nBytes > 0)
+    {
+        //first find how many bytes fit, so that the length is known before the CRC starts
+        length = 1;
+        count = 0;
+        previous = 0;
+        while ((count + 2 <= nBytes) && (count + 2 <= LOG_MAX_RECORD))
+        {
+            sample = p[count] | ((uint16_t) p[count + 1] << 8);
+            size = logVarintSize(logZigzag(sample, previous));
+            if (length + size > LOG_MAX_RECORD)
+            {
+                break;
+            }
+            length += size;
+            previous = sample;
+            count += 2;
+        }
+        //an odd byte at the end of a write is kept as it is
+        if ((count + 1 == nBytes) && (length < LOG_MAX_RECORD))
+        {
+            count++;
+            length++;
+        }
+        if (logReserve(fp, length) != 0)
+        {
+            return 2;
+        }
+        sink.fid = fp->index;
+        sink.pos = fp->size + LOG_HEADER_SIZE;
+        sink.crc = logRecordCrc(fp->addr, epoch, fp->size, length);
+        sink.fill = 0;
+        logSinkPut(&sink, (uint8_t) count);
+        previous = 0;
+        for (i = 0; i + 2 <= count; i += 2)
+        {
+            sample = p[i] | ((uint16_t) p[i + 1] << 8);
+            value = logZigzag(sample, previous);
+            previous = sample;
+            while (value >= 0x80)
+            {
+                logSinkPut(&sink, (uint8_t) (value | 0x80));
+                value >>= 7;
+            }
+            logSinkPut(&sink, (uint8_t) value);
+        }
+        if (i < count)
+        {
+            logSinkPut(&sink, p[i]);
+        }
+        logSinkFlush(&sink);
+        logSeal(fp, length, sink.crc);
+        p += count;
+        nBytes -= count;
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+int logAppend(MYFILE * fp, void *buffer, int nBytes)
+{
+    uint8_t length, epoch;
+    uint16_t crc;
+    uint8_t *p;
+
+    p = (uint8_t *) buffer;
+    epoch = fsread8uint(fp->addr, FILE_LOGOFFSET);
+    if (fsread8uint(fp->addr, FILE_FLAGSOFFSET) & FILE_FLAG_COMPRESSED)
+    {
+        return logAppendCompressed(fp, p, nBytes, epoch);
+    }
+    while (nBytes > 0)
+    {
+        if (nBytes > LOG_MAX_RECORD)
+        {
+            length = LOG_MAX_RECORD;
+        }
+        else
+        {
+            length = nBytes;
+        }
+        if (logReserve(fp, length) != 0)
+        {
+            return 2;
+        }
+        crc = logRecordCrc(fp->addr, epoch, fp->size, length);
+        crc = crcCcittBlock(crc, p, length);
+        transferFileBytes(fp->index, fp->size + LOG_HEADER_SIZE, p, length, 1);
+        logSeal(fp, length, crc);
+        p += length;
+        nBytes -= length;
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+//decode the compressed record at the file position into buffer, adding the stored bytes to the CRC
+static int logDecode(MYFILE * fp, uint8_t * buffer, int size, uint8_t length,
+                     uint16_t * crc)
+{
+    uint8_t chunk[16];
+    uint8_t done, count, i, byte, shift;
+    uint16_t value, previous;
+    int total, out;
+
+    total = -1;
+    out = 0;
+    value = 0;
+    shift = 0;
+    previous = 0;
+    for (done = 0; done < length; done += count)
+    {
+        count = length - done;
+        if (count > sizeof(chunk))
+        {
+            count = sizeof(chunk);
+        }
+        transferFileBytes(fp->index, fp->fpos + LOG_HEADER_SIZE + done, chunk,
+                          count, 0);
+        *crc = crcCcittBlock(*crc, chunk, count);
+        for (i = 0; i < count; i++)
+        {
+            byte = chunk[i];
+            if (total < 0)
+            {
+                total = byte;
+                if (total > size)
+                {
+                    return -1;
+                }
+            }
+            else if (out >= total)
+            {
+                return -1;
+            }
+            else if (total - out == 1)
+            {
+                buffer[out++] = byte;
+            }
+            else
+            {
+                value |= (uint16_t) (byte & 0x7f) << shift;
+                shift += 7;
+                if ((byte & 0x80) == 0)
+                {
+                    if (value & 1)
+                    {
+                        previous = (previous - (value >> 1) - 1) & 0xffff;
+                    }
+                    else
+                    {
+                        previous = (previous + (value >> 1)) & 0xffff;
+                    }
+                    buffer[out++] = (uint8_t) previous;
+                    buffer[out++] = (uint8_t) (previous >> 8);
+                    value = 0;
+                    shift = 0;
+                }
+                else if (shift > 14)
+                {
+                    return -1;
+                }
+            }
+        }
+    }
+    if (out != total)
+    {
+        return -1;
+    }
+    return total;
+}
+
+//-------------------------------------------------------------------------
+int freadrecord(MYFILE * fp, void *buffer, int size)
+{
+    uint8_t header[LOG_HEADER_SIZE];
+    uint8_t length, epoch;
+    uint16_t crc;
+    int decoded;
+
+    if (fp->fpos + LOG_HEADER_SIZE > fp->size)
+    {
+        return -1;
+    }
+    transferFileBytes(fp->index, fp->fpos, header, LOG_HEADER_SIZE, 0);
+    length = header[0];
+    //a compressed record is checked against the buffer once its decoded length is known
+    if ((length == 0)
+        || ((length > size)
+            && !(fsread8uint(fp->addr, FILE_FLAGSOFFSET) &
+                 FILE_FLAG_COMPRESSED))
+        || (fp->fpos + LOG_HEADER_SIZE + length > fp->size))
+    {
+        return -1;
+    }
+    epoch = fsread8uint(fp->addr, FILE_LOGOFFSET);
+    crc = logRecordCrc(fp->addr, epoch, fp->fpos, length);
+    if (fsread8uint(fp->addr, FILE_FLAGSOFFSET) & FILE_FLAG_COMPRESSED)
+    {
+        decoded = logDecode(fp, (uint8_t *) buffer, size, length, &crc);
+    }
+    else
+    {
+        transferFileBytes(fp->index, fp->fpos + LOG_HEADER_SIZE, buffer,
+                          length, 0);
+        crc = crcCcittBlock(crc, (uint8_t *) buffer, length);
+        decoded = length;
+    }
+    if ((decoded < 0) || (crc != (header[1] | ((uint16_t) header[2] << 8))))
+    {
+        return -1;
+    }
+    readAheadFileBytes(fp->index, fp->fpos, LOG_HEADER_SIZE + length);
+    fp->fpos += LOG_HEADER_SIZE + length;
+    return decoded;
+}
+
+//-------------------------------------------------------------------------
+void logSync()
+{
+    uint8_t i;
+
+    for (i = 0; i < MAX_FILE_TABLE_SIZE; i++)
+    {
+        if ((fidtable[i].valid == 1) && (fidtable[i].mode == 6))
+        {
+            fswriteFileSize(fidtable[i].addr, fidtable[i].size);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+void logRecover(int addr)
+{
+    uint8_t header[LOG_HEADER_SIZE];
+    uint8_t chunk[16];
+    uint8_t length, epoch, done, count;
+    uint16_t crc;
+    int32_t pos, end;
+    int fid;
+
+    fid = getFreeFid();
+    openFile(addr, fid, 1);
+    epoch = fsread8uint(addr, FILE_LOGOFFSET);
+    pos = fidtable[fid].size;
+    while (1)
+    {
+        //records only exist within the sectors the file already owns
+        if (getFileSector(fid, (pos + LOG_HEADER_SIZE - 1) / 2048) == 0)
+        {
+            break;
+        }
+        transferFileBytes(fid, pos, header, LOG_HEADER_SIZE, 0);
+        length = header[0];
+        end = pos + LOG_HEADER_SIZE + length;
+        if ((length == 0) || (end > FILE_MAX_SIZE)
+            || (getFileSector(fid, (end - 1) / 2048) == 0))
+        {
+            break;
+        }
+        crc = logRecordCrc(addr, epoch, pos, length);
+        for (done = 0; done < length; done += count)
+        {
+            count = length - done;
+            if (count > sizeof(chunk))
+            {
+                count = sizeof(chunk);
+            }
+            transferFileBytes(fid, pos + LOG_HEADER_SIZE + done, chunk, count,
+                              0);
+            crc = crcCcittBlock(crc, chunk, count);
+        }
+        if (crc != (header[1] | ((uint16_t) header[2] << 8)))
+        {
+            break;
+        }
+        pos = end;
+    }
+    if (pos != fidtable[fid].size)
+    {
+        fswriteFileSize(addr, pos);
+    }
+    releaseFid(fid);
+}
+
+//-------------------------------------------------------------------------
+void logMarkOpen(int addr, int open)
+{
+    uint8_t mark, updated;
+
+    genericreadBytes(OPENLOGSTART + addr / 8, 1, &mark);
+    if (open)
+    {
+        updated = mark | (1 << (addr % 8));
+    }
+    else
+    {
+        updated = mark & ~(1 << (addr % 8));
+    }
+    //logs are reopened far more often than they change state across a reset, so spare the EEPROM the rewrite
+    if (updated != mark)
+    {
+        genericwriteBytes(OPENLOGSTART + addr / 8, 1, &updated);
+    }
+}
+
+//-------------------------------------------------------------------------
+void logClose(MYFILE * fp)
+{
+    uint8_t i;
+
+    if (fp->mode != 6)
+    {
+        return;
+    }
+    for (i = 0; i < MAX_FILE_TABLE_SIZE; i++)
+    {
+        if ((i != fp->index) && (fidtable[i].valid == 1)
+            && (fidtable[i].mode == 6) && (fidtable[i].addr == fp->addr))
+        {
+            return;
+        }
+    }
+    logMarkOpen(fp->addr, 0);
+}
+
+//-------------------------------------------------------------------------
+void logRecoverOpen()
+{
+    uint8_t marks[(INODENUM + 8) / 8];
+    uint8_t i;
+    int addr;
+
+    genericreadBytes(OPENLOGSTART, sizeof(marks), marks);
+    for (addr = 1; addr <= INODENUM; addr++)
+    {
+        if ((marks[addr / 8] & (1 << (addr % 8)))
+            && (checkNodeValid(addr) == FILENODE)
+            && (fsread8uint(addr, FILE_LOGOFFSET) != 0))
+        {
+            logRecover(addr);
+        }
+    }
+    for (i = 0; i < sizeof(marks); i++)
+    {
+        if (marks[i] != 0)
+        {
+            marks[i] = 0;
+            genericwriteBytes(OPENLOGSTART + i, 1, &marks[i]);
+        }
+    }
+}
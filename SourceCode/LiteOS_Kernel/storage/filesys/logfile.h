@@ -0,0 +1,74 @@
+/** @file logfile.h
+	 @brief This file declares the log-structured mode for append-only files.
+*/
+
+
+#ifndef LOGFILEH
+#define LOGFILEH
+#include "../../types/types.h"
+#include "fsapi.h"
+
+/** \addtogroup filesystem */
+
+/** @{ */
+
+/** @brief Each record starts with its length and a CRC-CCITT over the record, its position and the log epoch. */
+#define LOG_HEADER_SIZE 3
+
+/** @brief The largest record. Longer writes are split into several records. */
+#define LOG_MAX_RECORD 255
+
+/** @brief Hand out a new nonzero log epoch, which keeps records left in reused sectors from being recovered as part of a new log.
+	@return The epoch.
+*/
+uint8_t newLogEpoch();
+
+/** @brief Append a write to a file opened in log mode as framed records.
+	The size is kept in the file handle and reaches the inode only at sync points, so appending costs no byte storage writes apart from sector allocation.
+	@param fp The file handle.
+	@param buffer The buffer.
+	@param nBytes The number of bytes.
+	@return 0 on success, 2 if the file or the flash is full.
+*/
+int logAppend(MYFILE * fp, void *buffer, int nBytes);
+
+/** @brief Read the record at the file position and advance to the next one.
+	The records of a compressed log are decoded, and fread2() still returns them as stored.
+	@param fp The file handle.
+	@param buffer The buffer.
+	@param size The size of the buffer.
+	@return The length of the record, or -1 at the end of the log, for a corrupted record, or if the record does not fit.
+*/
+int freadrecord(MYFILE * fp, void *buffer, int size);
+
+/** @brief Write the sizes of the open log files into their inodes.
+	@return Void.
+*/
+void logSync();
+
+/** @brief Recover the size of a log file after a reset by scanning the records past the size last synced.
+	@param addr The inode of the log file.
+	@return Void.
+*/
+void logRecover(int addr);
+
+/** @brief Record in the byte storage whether a log file is open for appending.
+	@param addr The inode of the log file.
+	@param open 1 when the log is opened, 0 when it is closed.
+	@return Void.
+*/
+void logMarkOpen(int addr, int open);
+
+/** @brief Clear the open mark of a log file when its last log handle is closed.
+	@param fp The handle being closed.
+	@return Void.
+*/
+void logClose(MYFILE * fp);
+
+/** @brief Recover the log files that were open for appending when the node was reset, and clear their open marks.
+	@return Void.
+*/
+void logRecoverOpen();
+
+/** @} */
+#endif
@@ -0,0 +1,192 @@
+/** @file ringfile.c
+	 @brief This file implements the ring files of fixed capacity for continuous recording.
+
+	 A ring file is created by fcreatering() with all of its sectors, and never allocates or frees any afterwards.
+	 Writes are appended at the head and wrap around to the start of the file, overwriting the oldest bytes once the
+	 ring is full. The inode keeps only the head, in the size field, and a flag set once the ring has wrapped, so
+	 the oldest byte is the head itself in a full ring and the start of the file otherwise.
+
+	 The head reaches the inode at sync points and whenever it moves into another sector, so a reset loses at most
+	 the bytes written since then, and recording costs one metadata commit per sector.
+*/
+
+#include "ringfile.h"
+#include "fsconfig.h"
+#include "stdfsa.h"
+#include "fs_structure.h"
+#include "fsapi.h"
+#include "vectorflash.h"
+
+extern fid fidtable[MAX_FILE_TABLE_SIZE];
+
+static int32_t ringcapacity[MAX_FILE_TABLE_SIZE];       //0 if the handle is not a ring
+static int32_t ringhead[MAX_FILE_TABLE_SIZE];   //offset of the next byte written
+static int32_t ringbase[MAX_FILE_TABLE_SIZE];   //offset of the oldest byte when the file was opened, where reads count from
+static uint8_t ringdirty[MAX_FILE_TABLE_SIZE];  //the head moved since the last sync point
+
+//-------------------------------------------------------------------------
+void ringOpen(int fid)
+{
+    uint8_t i, flags, currentaddr;
+    int32_t capacity;
+
+    ringcapacity[fid] = 0;
+    ringdirty[fid] = 0;
+    flags = fsread8uint(fidtable[fid].addr, FILE_FLAGSOFFSET);
+    if ((flags & FILE_FLAG_RING) == 0)
+    {
+        return;
+    }
+    //the capacity is every sector the file owns, as it was created with all of them
+    capacity = 0;
+    for (currentaddr = fidtable[fid].addr; currentaddr > 0;
+         currentaddr = fsread8uint(currentaddr, FILE_NEXTOFFSET))
+    {
+        for (i = 0; i < 8; i++)
+        {
+            if (fsreadFileSector(currentaddr, i) > 0)
+            {
+                capacity += 2048;
+            }
+        }
+    }
+    ringcapacity[fid] = capacity;
+    ringhead[fid] = fidtable[fid].size;
+    ringbase[fid] = 0;
+    if (flags & FILE_FLAG_WRAPPED)
+    {
+        fidtable[fid].size = capacity;
+        ringbase[fid] = ringhead[fid];
+    }
+    if (fidtable[fid].fpos > fidtable[fid].size)
+    {
+        fidtable[fid].fpos = fidtable[fid].size;
+    }
+}
+
+//-------------------------------------------------------------------------
+int ringAppend(MYFILE * fp, void *buffer, int nBytes)
+{
+    int32_t capacity;
+    uint8_t *p;
+    int count;
+
+    capacity = ringcapacity[fp->index];
+    if (capacity == 0)
+    {
+        return 2;
+    }
+    p = (uint8_t *) buffer;
+    //of a write longer than the ring, only the bytes the ring can hold would survive it
+    if (nBytes > capacity)
+    {
+        p += nBytes - capacity;
+        nBytes = capacity;
+    }
+    while (nBytes > 0)
+    {
+        count = 2048 - ringhead[fp->index] % 2048;
+        if (count > nBytes)
+        {
+            count = nBytes;
+        }
+        if (unshareFileSpace(fp->index, ringhead[fp->index],
+                             ringhead[fp->index] + count) < 0)
+        {
+            return 2;
+        }
+        //every pass of a full ring rewrites its sectors in place, and static wear leveling must see them as hot
+        if ((ringhead[fp->index] % 2048 == 0) && (fp->size == capacity))
+        {
+            wearFlashPage(getFileSector(fp->index, ringhead[fp->index] / 2048));
+        }
+        if (transferFileBytes(fp->index, ringhead[fp->index], p, count, 1) <
+            0)
+        {
+            return 2;
+        }
+        ringhead[fp->index] += count;
+        if (ringhead[fp->index] == capacity)
+        {
+            ringhead[fp->index] = 0;
+        }
+        fp->size += count;
+        if (fp->size > capacity)
+        {
+            fp->size = capacity;
+        }
+        ringdirty[fp->index] = 1;
+        p += count;
+        nBytes -= count;
+        if (ringhead[fp->index] % 2048 == 0)
+        {
+            fsync2();
+        }
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+int ringRead(MYFILE * fp, void *buffer, int nBytes)
+{
+    int32_t capacity, pos;
+    int count;
+
+    capacity = ringcapacity[fp->index];
+    if ((capacity == 0) || (fp->fpos + nBytes > fp->size))
+    {
+        return -1;
+    }
+    //the head moves with every append, so positions stay tied to where the ring started when it was opened
+    pos = fp->fpos + ringbase[fp->index];
+    while (nBytes > 0)
+    {
+        if (pos >= capacity)
+        {
+            pos -= capacity;
+        }
+        count = nBytes;
+        if (pos + count > capacity)
+        {
+            count = capacity - pos;
+        }
+        if (transferFileBytes(fp->index, pos, buffer, count, 0) < 0)
+        {
+            return -1;
+        }
+        readAheadFileBytes(fp->index, pos, count);
+        buffer = (void *)((char *)buffer + count);
+        pos += count;
+        nBytes -= count;
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+void ringEmpty(int addr)
+{
+    fswriteFileSize(addr, 0);
+    fswrite8uint(addr, FILE_FLAGSOFFSET,
+                 fsread8uint(addr, FILE_FLAGSOFFSET) & ~FILE_FLAG_WRAPPED);
+}
+
+//-------------------------------------------------------------------------
+void ringSync()
+{
+    uint8_t i, flags;
+
+    for (i = 0; i < MAX_FILE_TABLE_SIZE; i++)
+    {
+        if ((fidtable[i].valid == 1) && (ringdirty[i]))
+        {
+            fswriteFileSize(fidtable[i].addr, ringhead[i]);
+            flags = fsread8uint(fidtable[i].addr, FILE_FLAGSOFFSET);
+            if (fidtable[i].size == ringcapacity[i])
+            {
+                flags |= FILE_FLAG_WRAPPED;
+            }
+            fswrite8uint(fidtable[i].addr, FILE_FLAGSOFFSET, flags);
+            ringdirty[i] = 0;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/** @file ringfile.h
+	 @brief This file declares the ring files of fixed capacity for continuous recording.
+*/
+
+
+#ifndef RINGFILEH
+#define RINGFILEH
+#include "../../types/types.h"
+#include "fsapi.h"
+
+/** \addtogroup filesystem */
+
+/** @{ */
+
+/** @brief Load the ring state of a file that has just been opened.
+	The size of the handle becomes the number of bytes the ring holds, and positions count from the oldest of them.
+	@param fid The file handle index.
+	@return Void.
+*/
+void ringOpen(int fid);
+
+/** @brief Append a write to a ring file, overwriting its oldest bytes once it is full.
+	@param fp The file handle.
+	@param buffer The buffer.
+	@param nBytes The number of bytes.
+	@return 0 on success, 2 if the file is not a ring or a shared sector could not be copied.
+*/
+int ringAppend(MYFILE * fp, void *buffer, int nBytes);
+
+/** @brief Read bytes of a ring file at the file position, counted from the oldest byte when the file was opened.
+	@param fp The file handle.
+	@param buffer The buffer.
+	@param nBytes The number of bytes.
+	@return 0 on success, -1 if the bytes are not all in the ring.
+*/
+int ringRead(MYFILE * fp, void *buffer, int nBytes);
+
+/** @brief Empty a ring file, keeping its sectors.
+	@param addr The inode of the ring file.
+	@return Void.
+*/
+void ringEmpty(int addr);
+
+/** @brief Write the heads of the ring files appended to since the last sync point into their inodes.
+	@return Void.
+*/
+void ringSync();
+
+/** @} */
+#endif
@@ -14,12 +14,35 @@
 #include "fsstring.h"
 #include "vectorflash.h"
 #include "fsapi.h"
+#include "logfile.h"
+#include "ringfile.h"
+#include "../flash/pagestorage.h"
 #include "../../types/string.h"
 #include "../bytestorage/bytestorage.h"
 
 static int currentdirectory;
 extern fid fidtable[MAX_FILE_TABLE_SIZE];
 
+//the inodes that hold sectors 8k to 8k+7 of each open file, learned lazily as the file is accessed
+static uint8_t sectorchain[MAX_FILE_TABLE_SIZE][FILE_CHAIN_CACHE_SIZE];
+static uint8_t sectorchainlength[MAX_FILE_TABLE_SIZE];
+
+//where the next read of each open file starts if it is sequential, and how many sequential reads came in a row
+static int32_t readaheadnext[MAX_FILE_TABLE_SIZE];
+static uint8_t readaheadrun[MAX_FILE_TABLE_SIZE];
+
+//recently resolved path names, keyed by the path and the directory the lookup started from
+typedef struct
+{
+    uint8_t start;
+    uint8_t addr;
+    uint8_t state;
+    char path[PATH_CACHE_LENGTH];
+} pathcacheentry;
+
+static pathcacheentry pathcache[PATH_CACHE_SIZE];
+static uint8_t pathcachenext;
+
 //check whether the addr block has a file name as pointed to by filename
 //filename should be no more than 12 bytes and must end with \0
 //the checking goes as follows. It checks the bytes by bytes and make sure that 
@@ -63,23 +86,73 @@ int checkName(char *filename, int addr)
 }
 
 //if the directory is full return 1 else return 0
-uint8_t fullBlock(int directory)
+//a directory with no free slot can still grow by a continuation block, which takes an inode of its own
+uint8_t childNodeCost(int directory)
 {
     int i;
+    uint8_t block;
 
-    for (i = 0; i < 10; i++)
+    for (block = directory; ; block = fsread8uint(block, DIR_NEXTOFFSET))
     {
-        uint8_t subaddr;
+        for (i = 0; i < 10; i++)
+        {
+            uint8_t subaddr;
 
-        subaddr = fsread8uint(directory, DIR_ADDRSUBOFFSET + i);
-        if (subaddr == 0)
+            subaddr = fsread8uint(block, DIR_ADDRSUBOFFSET + i);
+            if (subaddr == 0)
+            {
+                return 0;
+            }
+        }
+        if (fsread8uint(block, DIR_NEXTOFFSET) == 0)
         {
-            return 0;
+            break;
         }
     }
     return 1;
 }
 
+//-------------------------------------------------------------------------
+uint8_t fullBlock(int directory)
+{
+    if (countVectorNode() < 1 + childNodeCost(directory))
+    {
+        return 1;
+    }
+    return 0;
+}
+
+//look up a single-level name among the children of a directory
+//the name hash of each child is compared first, so that only a likely match has its name read
+static int findChild(char *filename, int directory)
+{
+    int i;
+    uint8_t hash, subaddr, block;
+
+    if (mystrlen(filename) > 12)
+    {
+        return 0;
+    }
+    hash = nameHash(filename);
+    //the first block is the directory itself, the rest are chained through the next field
+    for (block = directory; ; block = fsread8uint(block, DIR_NEXTOFFSET))
+    {
+        for (i = 0; i < 10; i++)
+        {
+            subaddr = fsread8uint(block, DIR_ADDRSUBOFFSET + i);
+            if ((subaddr > 0) && (getNodeHash(subaddr) == hash)
+                && (checkName(filename, subaddr) == 0))
+            {
+                return subaddr;
+            }
+        }
+        if (fsread8uint(block, DIR_NEXTOFFSET) == 0)
+        {
+            return 0;
+        }
+    }
+}
+
 //-------------------------------------------------------------------------
 void getName(char *buffer, int addr)
 {
@@ -104,17 +177,12 @@ void getName(char *buffer, int addr)
 //in this one, the directory is checked to see if the file is out there if not return -1 
 int changeDirectory(char *filename, int directory)
 {
-    int i;
+    int subaddr;
 
-    for (i = 0; i < 10; i++)
+    subaddr = findChild(filename, directory);
+    if (subaddr > 0)
     {
-        uint8_t subaddr;
-
-        subaddr = fsread8uint(directory, DIR_ADDRSUBOFFSET + i);
-        if (checkName(filename, subaddr) == 0)
-        {
-            return subaddr;
-        }
+        return subaddr;
     }
     return -1;
 }
@@ -131,25 +199,12 @@ int getParentDirectory(int directory)
 //check wehther a block exists. the filename must be single level 
 int existBlock(char *filename, int directory)
 {
-    int i;
-    uint8_t temp;
+    int subaddr;
 
-    for (i = 0; i < 10; i++)
+    subaddr = findChild(filename, directory);
+    if (subaddr > 0)
     {
-        uint8_t subaddr;
-
-        subaddr = fsread8uint(directory, DIR_ADDRSUBOFFSET + i);
-        if (checkName(filename, subaddr) == 0)
-        {
-            if (((temp = checkNodeValid(subaddr)) > 0) && (subaddr > 0))
-            {
-                return temp;
-            }
-            else
-            {
-                continue;
-            }
-        }
+        return checkNodeValid(subaddr);
     }
     return 0;
 }
@@ -157,27 +212,7 @@ int existBlock(char *filename, int directory)
 //check wehther a block exists. the filename must be single level 
 int existBlockAddr(char *filename, int directory)
 {
-    int i;
-    uint8_t temp;
-
-    for (i = 0; i < 10; i++)
-    {
-        uint8_t subaddr;
-
-        subaddr = fsread8uint(directory, DIR_ADDRSUBOFFSET + i);
-        if (checkName(filename, subaddr) == 0)
-        {
-            if (((temp = checkNodeValid(subaddr)) > 0) && (subaddr > 0))
-            {
-                return subaddr;
-            }
-            else
-            {
-                continue;
-            }
-        }
-    }
-    return 0;
+    return findChild(filename, directory);
 }
 
 //return current directory
@@ -197,17 +232,9 @@ void setPwd(int directory)
 //returns 0 if it is empty. Returns 1 if otherwise 
 int emptyDirectory(int directory)
 {
-    int i;
-
-    for (i = 0; i < 10; i++)
+    if (firstChildNode(directory) > 0)
     {
-        uint8_t subaddr;
-
-        subaddr = fsread8uint(directory, DIR_ADDRSUBOFFSET + i);
-        if (subaddr > 0)
-        {
-            return 1;
-        }
+        return 1;
     }
     return 0;
 }
@@ -275,7 +302,7 @@ int isDirectory(int addr)
 //sovled
 //and the following are the functions this thing uses
 //
-int locateFileName(char *pathname, int *state)
+static int resolveFileName(char *pathname, int *state)
 {
     char p, q;
     char *relativestart;
@@ -307,7 +334,7 @@ int locateFileName(char *pathname, int *state)
         //this case is the "mnae" case, where there may or may not be further stuff behind 
         //buggy place 
         relativestart = extractString(relativestart, (char *)nextString);
-        if (relativestart == '\0')
+        if (*relativestart == '\0')
         {
             if ((ret = existBlock(nextString, addrTrack)) == 0)
             {
@@ -374,23 +401,72 @@ int locateFileName(char *pathname, int *state)
 }
 
 //-------------------------------------------------------------------------
-void freeBlocks(int addr)
+int locateFileName(char *pathname, int *state)
 {
-    int i;
-    uint8_t readpage;
+    uint8_t i, start;
+    int length, ret;
+    pathcacheentry *entry;
 
-    for (i = 0; i < 8; i++)
+    if (pathname[0] == '/')
+    {
+        start = FSROOTNODE;
+    }
+    else
+    {
+        start = (uint8_t) getPwd();
+    }
+    length = mystrlen(pathname);
+    if (length >= PATH_CACHE_LENGTH)
+    {
+        return resolveFileName(pathname, state);
+    }
+    for (i = 0; i < PATH_CACHE_SIZE; i++)
     {
-        readpage = fsread8uint(addr, FILE_ADDRPAGEOFFSET + i);
-        if (readpage == 0)
+        entry = &pathcache[i];
+        if ((entry->path[0] != '\0') && (entry->start == start)
+            && (mystrncmp(entry->path, 0, pathname, 0, length + 1) == 0))
         {
-            break;
+            *state = entry->state;
+            return entry->addr;
         }
-        else
+    }
+    ret = resolveFileName(pathname, state);
+    //only existing nodes are remembered, since a missing one is usually created next
+    if ((ret > 0) && (*state > 0))
+    {
+        entry = &pathcache[pathcachenext];
+        pathcachenext++;
+        if (pathcachenext == PATH_CACHE_SIZE)
         {
-            releaseFlashPage(readpage);
+            pathcachenext = 0;
         }
+        entry->start = start;
+        entry->addr = (uint8_t) ret;
+        entry->state = (uint8_t) (*state);
+        mystrncpy(entry->path, pathname, length + 1);
+    }
+    return ret;
+}
+
+//-------------------------------------------------------------------------
+void invalidatePathCache()
+{
+    uint8_t i;
+
+    for (i = 0; i < PATH_CACHE_SIZE; i++)
+    {
+        pathcache[i].path[0] = '\0';
     }
+}
+
+//-------------------------------------------------------------------------
+void freeBlocks(int addr)
+{
+    releaseFileChain(addr);
+    fswriteFileSize(addr, 0);
+    //a truncated log starts over with a new epoch when it is next opened as a log
+    fswrite8uint(addr, FILE_LOGOFFSET, 0);
+    fswrite8uint(addr, FILE_FLAGSOFFSET, 0);
     return;
 }
 
@@ -399,8 +475,11 @@ void openFile(int addr, int fid, int mode)
 {
     fidtable[fid].addr = (uint8_t) addr;
     fidtable[fid].mode = (uint8_t) mode;
-    fidtable[fid].size = fsread16uint(addr, 29);
-    //mode: 1 read 2 write 3 append 4 truncate 5 rw
+    fidtable[fid].size = fsreadFileSize(addr);
+    sectorchainlength[fid] = 0;
+    readaheadnext[fid] = 0;
+    readaheadrun[fid] = 0;
+    //mode: 1 read 2 write 3 append 4 truncate 5 rw 6 log 7 compressed log
     if (mode == 1)
     {
         fidtable[fid].fpos = 0;
@@ -415,17 +494,48 @@ void openFile(int addr, int fid, int mode)
     }
     if (mode == 4)
     {
-        freeBlocks(addr);
+        //a ring keeps its sectors, so that it never allocates while recording
+        if (fsread8uint(addr, FILE_FLAGSOFFSET) & FILE_FLAG_RING)
+        {
+            ringEmpty(addr);
+        }
+        else
+        {
+            freeBlocks(addr);
+        }
+        fidtable[fid].size = 0;
         fidtable[fid].fpos = 0;
     }
     if (mode == 5)
     {
         fidtable[fid].fpos = 0;
     }
+    if (mode == 7)
+    {
+        //all records of a log are stored the same way, so only an empty log starts compressing
+        if (fidtable[fid].size == 0)
+        {
+            fswrite8uint(addr, FILE_FLAGSOFFSET, FILE_FLAG_COMPRESSED);
+        }
+        mode = 6;
+        fidtable[fid].mode = 6;
+    }
+    if (mode == 6)
+    {
+        //records are always appended at the end, and read from the start
+        if (fsread8uint(addr, FILE_LOGOFFSET) == 0)
+        {
+            fswrite8uint(addr, FILE_LOGOFFSET, newLogEpoch());
+        }
+        //mounting only scans the logs that were open for appending
+        logMarkOpen(addr, 1);
+        fidtable[fid].fpos = 0;
+    }
+    ringOpen(fid);
 }
 
 //-------------------------------------------------------------------------
-uint8_t getRealSector(uint8_t addr, uint8_t sectornum)
+uint16_t getRealSector(uint8_t addr, int sectornum)
 {
     uint8_t currentaddr;
 
@@ -433,18 +543,199 @@ uint8_t getRealSector(uint8_t addr, uint8_t sectornum)
     while (sectornum >= 8)
     {
         currentaddr = fsread8uint(currentaddr, FILE_NEXTOFFSET);
+        //the end of the chain, rather than inode 0
+        if (currentaddr == 0)
+        {
+            return 0;
+        }
         sectornum -= 8;
     }
-    return fsread8uint(currentaddr, FILE_ADDRPAGEOFFSET + sectornum);
+    return fsreadFileSector(currentaddr, sectornum);
 }
 
 //-------------------------------------------------------------------------
-void newSector(int addr)
+uint16_t getFileSector(int fid, int sectornum)
 {
-    uint8_t i, readpage;
-    uint8_t next, currentaddr, getnode;
+    int group;
+    uint8_t length, currentaddr;
+    uint8_t *chain;
+
+    chain = sectorchain[fid];
+    group = sectornum / 8;
+    length = sectorchainlength[fid];
+    //the chain only grows while a file is open, so cached links never go stale
+    while ((length <= group) && (length < FILE_CHAIN_CACHE_SIZE))
+    {
+        if (length == 0)
+        {
+            currentaddr = fidtable[fid].addr;
+        }
+        else
+        {
+            currentaddr = fsread8uint(chain[length - 1], FILE_NEXTOFFSET);
+        }
+        if (currentaddr == 0)
+        {
+            sectorchainlength[fid] = length;
+            return 0;
+        }
+        chain[length] = currentaddr;
+        length++;
+    }
+    sectorchainlength[fid] = length;
+    if (group < FILE_CHAIN_CACHE_SIZE)
+    {
+        return fsreadFileSector(chain[group], sectornum % 8);
+    }
+    //files longer than the cache walk the rest of the chain from its last entry
+    return getRealSector(chain[FILE_CHAIN_CACHE_SIZE - 1],
+                         sectornum - (FILE_CHAIN_CACHE_SIZE - 1) * 8);
+}
+
+//-------------------------------------------------------------------------
+int reserveFileSpace(int fid, int32_t end)
+{
+    int lastsector;
+
+    if (end == 0)
+    {
+        return 0;
+    }
+    lastsector = (end - 1) / 2048;
+    while (getFileSector(fid, lastsector) == 0)
+    {
+        if (countVectorFlash() == 0)
+        {
+            return -1;
+        }
+        if (newSector(fidtable[fid].addr) < 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+int unshareFileSpace(int fid, int32_t start, int32_t end)
+{
+    int sectornum;
+    uint16_t oldsector, newsector;
+    uint8_t currentaddr;
+    int group;
+
+    if (end <= start)
+    {
+        return 0;
+    }
+    for (sectornum = start / 2048; sectornum <= (end - 1) / 2048;
+         sectornum++)
+    {
+        oldsector = getFileSector(fid, sectornum);
+        if ((oldsector == 0) || (isFlashPageShared(oldsector) == 0))
+        {
+            continue;
+        }
+        //copy on write: the other files keep the old sector
+        if (countVectorFlash() == 0)
+        {
+            return -1;
+        }
+        newsector = getFlashPageAfter(oldsector);
+        fmapmoved(oldsector);
+        copyVectorPage(oldsector, newsector);
+        currentaddr = fidtable[fid].addr;
+        for (group = sectornum / 8; group > 0; group--)
+        {
+            currentaddr = fsread8uint(currentaddr, FILE_NEXTOFFSET);
+        }
+        fswriteFileSector(currentaddr, sectornum % 8, newsector);
+        dropFlashPage(oldsector, fidtable[fid].addr);
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+int transferFileBytes(int fid, int32_t pos, void *buffer, int nBytes,
+                      uint8_t write)
+{
+    uint16_t realsector;
+    int count;
+    int pagenum, pageoffset;
+
+    while (nBytes > 0)
+    {
+        pageoffset = pos % 256;
+        pagenum = (pos % 2048) / 256;
+        count = 256 - pageoffset;
+        if (count > nBytes)
+        {
+            count = nBytes;
+        }
+        realsector = getFileSector(fid, pos / 2048);
+        if (realsector == 0)
+        {
+            return -1;
+        }
+        pagenum = pagenum + (realsector - 1) * 8;
+        if (write)
+        {
+            writepagestorage(pagenum, pageoffset, buffer, count);
+        }
+        else
+        {
+            readpagestorage(pagenum, pageoffset, buffer, count);
+        }
+        buffer = (void *)((char *)buffer + count);
+        pos += count;
+        nBytes -= count;
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+void readAheadFileBytes(int fid, int32_t pos, int nBytes)
+{
+    int32_t next;
+    uint16_t realsector;
+
+    if (pos != readaheadnext[fid])
+    {
+        //a seek: the reader is not streaming, so the buffers are left alone
+        readaheadrun[fid] = 0;
+    }
+    else if (readaheadrun[fid] < READ_AHEAD_TRIGGER)
+    {
+        readaheadrun[fid]++;
+    }
+    readaheadnext[fid] = pos + nBytes;
+    if (readaheadrun[fid] < READ_AHEAD_TRIGGER)
+    {
+        return;
+    }
+    //the page after the one the reader is in
+    next = (pos + nBytes) / 256 * 256 + 256;
+    if (next >= fidtable[fid].size)
+    {
+        return;
+    }
+    realsector = getFileSector(fid, next / 2048);
+    if (realsector > 0)
+    {
+        prefetchpagestorage((realsector - 1) * 8 + (next % 2048) / 256);
+    }
+}
+
+//-------------------------------------------------------------------------
+int newSector(int addr)
+{
+    uint8_t i;
+    uint16_t readpage, lastpage;
+    uint8_t next, currentaddr;
+    int getnode;
 
     currentaddr = addr;
+    lastpage = 0;
     //begin rounds of 
     // 1 check whether the current 8 pages are occupied or not
     // 2 check the next field is ok or not
@@ -453,66 +744,155 @@ void newSector(int addr)
     {
         for (i = 0; i < 8; i++)
         {
-            readpage = fsread8uint(currentaddr, FILE_ADDRPAGEOFFSET + i);
+            readpage = fsreadFileSector(currentaddr, i);
             if (readpage == 0)
             {
                 break;
             }
+            lastpage = readpage;
         }
+        //allocate after the last sector of the file, so that files stay contiguous for sequential access
         if (i < 8)
         {
-            readpage = getFlashPage();
-            fswrite8uint(currentaddr, FILE_ADDRPAGEOFFSET + i, readpage);
-            return;
+            readpage = getFlashPageAfter(lastpage);
+            fswriteFileSector(currentaddr, i, readpage);
+            return 0;
         }
         next = fsread8uint(currentaddr, FILE_NEXTOFFSET);
         if (next == 0)
         {
+            //the sector needs a continuation node, and the inodes may run out before the flash does
             getnode = getVectorNode();
+            if (getnode < 0)
+            {
+                return -1;
+            }
+            fsinitBytes(getnode, 0, INODESIZE, 0);
+            fswrite8uint(getnode, TYPEOFFSET, EXTNODE);
+            fswrite8uint(getnode, VALIDOFFSET, 1);
+            fswrite8uint(getnode, FILE_PARENTOFFSET, addr);
             fswrite8uint(currentaddr, FILE_NEXTOFFSET, getnode);
             currentaddr = getnode;
-            readpage = getFlashPage();
-            fswrite8uint(currentaddr, FILE_ADDRPAGEOFFSET, readpage);
-            return;
+            readpage = getFlashPageAfter(lastpage);
+            fswriteFileSector(currentaddr, 0, readpage);
+            return 0;
         }
         currentaddr = next;
     }
 }
 
 //-------------------------------------------------------------------------
-void addChildNode(uint8_t addr, uint8_t child)
+int addChildNode(uint8_t addr, uint8_t child)
 {
     uint8_t i;
+    uint8_t block, next;
+    int getnode;
 
-    for (i = 0; i < 10; i++)
+    block = addr;
+    while (1)
     {
-        uint8_t subaddr;
+        for (i = 0; i < 10; i++)
+        {
+            uint8_t subaddr;
 
-        subaddr = fsread8uint(addr, DIR_ADDRSUBOFFSET + i);
-        if (subaddr == 0)
+            subaddr = fsread8uint(block, DIR_ADDRSUBOFFSET + i);
+            if (subaddr == 0)
+            {
+                fswrite8uint(block, DIR_ADDRSUBOFFSET + i, child);
+                return 0;
+            }
+        }
+        next = fsread8uint(block, DIR_NEXTOFFSET);
+        if (next == 0)
         {
-            fswrite8uint(addr, DIR_ADDRSUBOFFSET + i, child);
-            return;
+            break;
         }
+        block = next;
     }
-    return;
+    //every block is full: chain a continuation block, the same way a file chains its sectors
+    getnode = getVectorNode();
+    if (getnode < 0)
+    {
+        return -1;
+    }
+    fsinitBytes(getnode, 0, INODESIZE, 0);
+    fswrite8uint(getnode, TYPEOFFSET, DIREXTNODE);
+    fswrite8uint(getnode, VALIDOFFSET, 1);
+    fswrite8uint(getnode, DIR_PARENTOFFSET, addr);
+    fswrite8uint(getnode, DIR_ADDRSUBOFFSET, child);
+    fswrite8uint(block, DIR_NEXTOFFSET, getnode);
+    return 0;
 }
 
 //-------------------------------------------------------------------------
 void removeChildNode(uint8_t addr, uint8_t child)
 {
     uint8_t i;
+    uint8_t block, previous, next;
 
-    for (i = 0; i < 10; i++)
+    block = addr;
+    previous = addr;
+    while (1)
     {
-        uint8_t subaddr;
+        for (i = 0; i < 10; i++)
+        {
+            uint8_t subaddr;
 
-        subaddr = fsread8uint(addr, DIR_ADDRSUBOFFSET + i);
-        if (subaddr == child)
+            subaddr = fsread8uint(block, DIR_ADDRSUBOFFSET + i);
+            if (subaddr == child)
+            {
+                fswrite8uint(block, DIR_ADDRSUBOFFSET + i, 0);
+                break;
+            }
+        }
+        next = fsread8uint(block, DIR_NEXTOFFSET);
+        if (i < 10)
+        {
+            break;
+        }
+        if (next == 0)
         {
-            fswrite8uint(addr, DIR_ADDRSUBOFFSET + i, 0);
             return;
         }
+        previous = block;
+        block = next;
+    }
+    //an emptied continuation block is unlinked and released, so that lookups no longer walk it
+    if (block == addr)
+    {
+        return;
+    }
+    for (i = 0; i < 10; i++)
+    {
+        if (fsread8uint(block, DIR_ADDRSUBOFFSET + i) > 0)
+        {
+            return;
+        }
+    }
+    fswrite8uint(previous, DIR_NEXTOFFSET, next);
+    fswrite8uint(block, VALIDOFFSET, 0);
+    releaseVectorNode(block);
+}
+
+//-------------------------------------------------------------------------
+int firstChildNode(int directory)
+{
+    uint8_t i;
+    uint8_t block, subaddr;
+
+    for (block = directory; ; block = fsread8uint(block, DIR_NEXTOFFSET))
+    {
+        for (i = 0; i < 10; i++)
+        {
+            subaddr = fsread8uint(block, DIR_ADDRSUBOFFSET + i);
+            if (subaddr > 0)
+            {
+                return subaddr;
+            }
+        }
+        if (fsread8uint(block, DIR_NEXTOFFSET) == 0)
+        {
+            return 0;
+        }
     }
-    return;
 }
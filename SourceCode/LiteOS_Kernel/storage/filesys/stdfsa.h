@@ -10,6 +10,16 @@
 
 #include "../../types/types.h"
 
+/** @brief The number of resolved path names remembered by locateFileName(). */
+#ifndef PATH_CACHE_SIZE
+#define PATH_CACHE_SIZE 4
+#endif
+
+/** @brief The longest path name, including the terminating zero, that the path cache holds. */
+#ifndef PATH_CACHE_LENGTH
+#define PATH_CACHE_LENGTH 24
+#endif
+
 
 /** @addtogroup filesystem
 */
@@ -23,7 +33,13 @@
 */
 int changeDirectory(char *filename, int directory);
 
-/** @brief Check if a directory is full block. 
+/** @brief Count the inodes a directory needs for its continuation blocks to take one more child. 
+	@param directory The directory id. 
+	@return 1 if every child slot is taken, 0 otherwise. 
+*/
+uint8_t childNodeCost(int directory);
+
+/** @brief Check if a directory is full block, that is, the inodes left cannot hold a new child and the block it needs. 
 	@param directory The directory id. 
 	@return Wehther it is a full block. 
 */
@@ -74,6 +90,7 @@ int existBlock(char *filename, int directory);
 int emptyDirectory(int directory);
 
 /** @brief Locate a file name.
+	Existing nodes are served from a small cache of recently resolved paths, which is cleared whenever a node is created, deleted or renamed.
 	@param pathname The path name. 
 	@param state The current state.
 	@return The located file id. 
@@ -81,6 +98,12 @@ int emptyDirectory(int directory);
 
 int locateFileName(char *pathname, int *state);
 
+/** @brief Forget all resolved path names. Must be called whenever a node is created, deleted, renamed or moved.
+	@return Void.
+*/
+
+void invalidatePathCache();
+
 /** @brief Open a file. 
 	@param addr The address. 
 	@param fid The file handle. 
@@ -106,20 +129,60 @@ void freeBlocks(int addr);
 
 /** @brief Build a new sector at addr. 
 	@param addr The address. 
+	@return 0 on success, -1 if no inode is left for the node the sector needs. 
+*/
+
+int newSector(int addr);
+
+/** @brief Make sure the sectors of an open file cover a given length. 
+	@param fid The index of the file handle. 
+	@param end The length in bytes the file must be able to hold. 
+	@return 0 on success, -1 if the flash or the inodes are full. 
+*/
+
+int reserveFileSpace(int fid, int32_t end);
+
+/** @brief Give an open file its own copy of the sectors in a byte range that it shares with copies of the file. 
+	@param fid The index of the file handle. 
+	@param start The first byte about to be written. 
+	@param end The byte after the last one about to be written. 
+	@return 0 on success, -1 if the flash is full. 
+*/
+
+int unshareFileSpace(int fid, int32_t start, int32_t end);
+
+/** @brief Read or write bytes of an open file, page by page. The sectors must have been reserved. 
+	@param fid The index of the file handle. 
+	@param pos The position in the file. 
+	@param buffer The buffer. 
+	@param nBytes The number of bytes. 
+	@param write 1 to write the buffer into the file, 0 to read from the file. 
+	@return 0 on success, -1 if a sector in the range is missing, in which case the bytes from there on are not transferred. 
+*/
+
+int transferFileBytes(int fid, int32_t pos, void *buffer, int nBytes,
+                      uint8_t write);
+
+/** @brief Track the reads of an open file and load the next page ahead of a sequential reader. 
+	Read-ahead starts once READ_AHEAD_TRIGGER reads in a row each began where the previous one ended, and stops at the first read that did not. 
+	@param fid The index of the file handle. 
+	@param pos The position the read started at. 
+	@param nBytes The number of bytes read. 
 	@return Void. 
 */
 
-void newSector(int addr);
+void readAheadFileBytes(int fid, int32_t pos, int nBytes);
 
 /** @brief Add child node at an address. 
+	A directory holds 10 children in its own inode; further children go into continuation blocks (DIREXTNODE) chained through the next field.
 	@param addr The address
 	@param child The child id. 
-	@return Void. 
+	@return 0 on success, -1 if no inode is left for the continuation block. 
 */
 
-void addChildNode(uint8_t addr, uint8_t child);
+int addChildNode(uint8_t addr, uint8_t child);
 
-/** @brief Remove child node at an address. 
+/** @brief Remove child node at an address. A continuation block left empty is released. 
 	@param addr The address. 
 	@param child The child id. 
 	@return Void. 
@@ -127,6 +190,13 @@ void addChildNode(uint8_t addr, uint8_t child);
 
 void removeChildNode(uint8_t addr, uint8_t child);
 
+/** @brief Get the first child of a directory, searching its continuation blocks as well. 
+	@param directory The directory id. 
+	@return The child id, or 0 if the directory is empty. 
+*/
+
+int firstChildNode(int directory);
+
 /** @brief Get name. 
 	@param buffer The buffer.
 	@param addr The address. 
@@ -149,7 +219,16 @@ int existBlockAddr(char *filename, int directory);
 	@return Returned sector number. 
 */
 
-uint8_t getRealSector(uint8_t addr, uint8_t sectornum);
+uint16_t getRealSector(uint8_t addr, int sectornum);
+
+/** @brief Get a real sector of an open file in constant time.
+	The inodes of the file's chain are cached per file handle when first reached, so sequential access no longer walks the chain from the head for every call.
+	@param fid The index of the file handle.
+	@param sectornum The sector number within the file.
+	@return Returned sector number, or 0 if the file has no such sector.
+*/
+
+uint16_t getFileSector(int fid, int sectornum);
 
 /**@}*/
 #endif
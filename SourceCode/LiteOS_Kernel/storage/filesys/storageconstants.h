@@ -33,6 +33,39 @@
 /** flash vector contains 32 bytes. */
 #define FLASHVECTORSTART  3180
 
+/** The last log epoch handed out, 1 byte. */
+#define LOGEPOCHOFFSET 3212
+
+/** The file system format revision, 1 byte. */
+#define FSREVISIONOFFSET 3213
+
+/** Flash sector erase counters, 1 byte per sector, FLASH_SECTOR_NUM (256) bytes. */
+#define WEARCOUNTSTART 3216
+
+/** The name hash of every inode, 1 byte per inode, INODENUM + 1 (97) bytes. */
+#define NAMEHASHSTART 3472
+
+/** Log files open for appending, 1 bit per inode, 13 bytes. */
+#define OPENLOGSTART 3570
+
+/** The metadata redo journal (see journal.h). */
+#define JOURNALSTART 3584
+
+/** The size of the journal in bytes. */
+#define JOURNALSIZE 256
+
+/** Flash sectors shared by copied files, 1 bit per sector, 32 bytes. */
+#define SHAREDVECTORSTART 3840
+
+/** The key-value store (see kvstore.h), two banks over the rest of the byte storage. */
+#define KVSTORESTART 3872
+
+/** The size of the key-value store in bytes. */
+#define KVSTORESIZE 224
+
+/** The end of the byte storage the kernel owns, which raw writes of applications may not overlap. */
+#define KERNELBYTESEND (KVSTORESTART + KVSTORESIZE)
+
 /** @} */
 
 #endif 
@@ -9,70 +9,201 @@
 #include "../bytestorage/bytestorage.h"
 #include "fsconfig.h"
 #include "storageconstants.h"
+#include "bitvector.h"
+#include "journal.h"
 
-static char vectorflash[32];
+static char vectorflash[FLASH_SECTOR_NUM / 8];
+//sectors that more than one file points to since fcopy(); they are copied before being written
+static char vectorshared[FLASH_SECTOR_NUM / 8];
+static int freeflash;
+static int flashhint;
+static uint8_t flashchanged;
 
+//The stored vector has room for 256 sectors; larger configurations rebuild it from the inodes at every mount
 void writeVectorFlashToExternalStorage()
 {
-#ifdef PLATFORM_AVR
-    genericwriteBytes(FLASHVECTORSTART, 32, vectorflash);
+#if FLASH_SECTOR_NUM <= 256
+    if (flashchanged)
+    {
+        journalWrite(FLASHVECTORSTART, FLASH_SECTOR_NUM / 8, vectorflash);
+        journalWrite(SHAREDVECTORSTART, FLASH_SECTOR_NUM / 8, vectorshared);
+        flashchanged = 0;
+    }
 #endif
 }
 
 //-------------------------------------------------------------------------
 void readVectorFlashFromExternalStorage()
 {
-#ifdef PLATFORM_AVR
-    genericreadBytes(FLASHVECTORSTART, 32, vectorflash);
+#if FLASH_SECTOR_NUM <= 256
+    genericreadBytes(FLASHVECTORSTART, FLASH_SECTOR_NUM / 8, vectorflash);
+    genericreadBytes(SHAREDVECTORSTART, FLASH_SECTOR_NUM / 8, vectorshared);
+    freeflash = FLASH_SECTOR_NUM - bitvectorCount(vectorflash, FLASH_SECTOR_NUM);
+    flashhint = 0;
+    flashchanged = 0;
+#else
+    initVectorFlash();
+    scanVectorFlash();
 #endif
 }
 
 //-------------------------------------------------------------------------
-static int getbit(char *set, int number)
+void initVectorFlash()
+{
+    int i;
+
+    for (i = 0; i < FLASH_SECTOR_NUM / 8; i++)
+    {
+        vectorflash[i] = 0;
+        vectorshared[i] = 0;
+    }
+    freeflash = FLASH_SECTOR_NUM;
+    flashhint = 0;
+    flashchanged = 1;
+}
+
+//-------------------------------------------------------------------------
+//The erase counters are stored inverted, so that never written EEPROM reads as unworn
+static void readWear(int num, uint8_t * wear, int count)
+{
+    int i;
+
+    genericreadBytes(WEARCOUNTSTART + num - 1, count, wear);
+    for (i = 0; i < count; i++)
+    {
+        wear[i] = 255 - wear[i];
+    }
+}
+
+//-------------------------------------------------------------------------
+static void writeWear(int num, uint8_t wear)
+{
+    wear = 255 - wear;
+    genericwriteBytes(WEARCOUNTSTART + num - 1, 1, &wear);
+}
+
+//-------------------------------------------------------------------------
+uint8_t getFlashPageWear(int num)
 {
-    set += number / 8;
-    return (*set & (1 << (number % 8))) != 0;   /* 0 or 1       */
+    uint8_t wear;
+
+    readWear(num, &wear, 1);
+    return wear;
 }
 
 //-------------------------------------------------------------------------
-static void setbit(char *set, int number, int value)
+//Counters are relative: once one saturates, the wear all sectors share is taken off
+static void rebaseWear()
 {
-    set += number / 8;
-    if (value)
+    int num;
+    uint8_t wear, minimum;
+
+    minimum = 255;
+    for (num = 1; num <= FLASH_SECTOR_NUM; num++)
+    {
+        wear = getFlashPageWear(num);
+        if (wear < minimum)
+        {
+            minimum = wear;
+        }
+    }
+    if (minimum == 0)
     {
-        *set |= 1 << (number % 8);
-    }                           /* set bit      */
-    else
+        return;
+    }
+    for (num = 1; num <= FLASH_SECTOR_NUM; num++)
     {
-        *set &= ~(1 << (number % 8));
-    }                           /* clear bit    */
+        writeWear(num, getFlashPageWear(num) - minimum);
+    }
 }
 
 //-------------------------------------------------------------------------
-void initVectorFlash()
+void claimFlashPage(int num)
 {
-    int i;
+    if (bitvectorSet(vectorflash, num - 1, 1))
+    {
+        freeflash--;
+        flashchanged = 1;
+    }
+    wearFlashPage(num);
+}
+
+//-------------------------------------------------------------------------
+void wearFlashPage(int num)
+{
+    uint8_t wear;
 
-    for (i = 0; i < 32; i++)
+    //the sector is about to be erased and programmed again
+    wear = getFlashPageWear(num);
+    if (wear == 255)
     {
-        vectorflash[i] = 0;
+        rebaseWear();
+        wear = getFlashPageWear(num);
+    }
+    if (wear < 255)
+    {
+        writeWear(num, wear + 1);
     }
 }
 
 //-------------------------------------------------------------------------
 int getFlashPage()
 {
-    int num;
+    //rotate through equally worn pages instead of always favouring the front of the flash
+    return getFlashPageAfter(flashhint);
+}
 
-    for (num = 0; num < 256; num++)
+//-------------------------------------------------------------------------
+int getFlashPageAfter(int num)
+{
+    int group, bit, next, best;
+    uint16_t used;
+    uint8_t wear[16];
+    uint8_t bestwear;
+    int distance, bestdistance;
+
+    if (freeflash == 0)
+    {
+        return -1;
+    }
+    //take the least worn free page; among equally worn ones the nearest after num, so that files stay contiguous
+    best = -1;
+    bestwear = 255;
+    bestdistance = FLASH_SECTOR_NUM;
+    //walk the bitmap 16 pages at a time, which is also how the counters are read
+    for (group = 0; group < FLASH_SECTOR_NUM / 16; group++)
     {
-        if (getbit(vectorflash, num) == 0)
+        used = (uint8_t) vectorflash[group * 2] |
+            ((uint16_t) (uint8_t) vectorflash[group * 2 + 1] << 8);
+        if (used == 0xffff)
         {
-            setbit(vectorflash, num, 1);
-            return num + 1;
+            continue;
+        }
+        readWear(group * 16 + 1, wear, 16);
+        while ((bit = bitvectorFirstZero(used)) >= 0)
+        {
+            used |= (uint16_t) 1 << bit;
+            next = group * 16 + bit;
+            //page ids start from 1, so num is also the bit of the page that follows it
+            distance = (next - num + FLASH_SECTOR_NUM) % FLASH_SECTOR_NUM;
+            if ((best == -1) || (wear[bit] < bestwear)
+                || ((wear[bit] == bestwear) && (distance < bestdistance)))
+            {
+                best = next;
+                bestwear = wear[bit];
+                bestdistance = distance;
+            }
         }
     }
-    return -1;
+    claimFlashPage(best + 1);
+    flashhint = (best + 1) % FLASH_SECTOR_NUM;
+    return best + 1;
+}
+
+//-------------------------------------------------------------------------
+int isFlashPageFree(int num)
+{
+    return bitvectorGet(vectorflash, num - 1) == 0;
 }
 
 //-------------------------------------------------------------------------
@@ -81,49 +212,116 @@ void scanVectorFlash()
     int num, addr;
     uint8_t valid;
     uint8_t type;
-    uint8_t readpage;
+    uint16_t readpage;
 
-    for (num = 0; num < 96; num++)
+    for (num = 0; num < INODENUM; num++)
     {
         addr = num + 1;
         valid = fsread8uint(addr, VALIDOFFSET);
         type = fsread8uint(addr, TYPEOFFSET);
-        if ((valid == 1) && (type == FILENODE))
+        if ((valid == 1) && ((type == FILENODE) || (type == EXTNODE)))
         {
             char i;
 
             for (i = 0; i < 8; i++)
             {
-                readpage = fsread8uint(addr, FILE_ADDRPAGEOFFSET + i);
-                if (readpage > 0)
+                readpage = fsreadFileSector(addr, i);
+                if ((readpage > 0)
+                    && (bitvectorSet(vectorflash, readpage - 1, 1) == 0))
                 {
-                    setbit(vectorflash, readpage - 1, 1);
+                    //a second file points to the sector
+                    bitvectorSet(vectorshared, readpage - 1, 1);
                 }
             }
         }
     }
+    freeflash = FLASH_SECTOR_NUM - bitvectorCount(vectorflash, FLASH_SECTOR_NUM);
+    flashchanged = 1;
 }
 
 //-------------------------------------------------------------------------
 void releaseFlashPage(int num)
 {
-    setbit(vectorflash, num - 1, 0);
+    if (bitvectorSet(vectorflash, num - 1, 0))
+    {
+        freeflash++;
+        flashchanged = 1;
+    }
+}
+
+//-------------------------------------------------------------------------
+int isFlashPageShared(int num)
+{
+    return bitvectorGet(vectorshared, num - 1);
 }
 
 //-------------------------------------------------------------------------
-int countVectorFlash()
+void shareFlashPage(int num)
+{
+    if (bitvectorSet(vectorshared, num - 1, 1))
+    {
+        flashchanged = 1;
+    }
+}
+
+//-------------------------------------------------------------------------
+//Count the files other than one that point to a sector. Only needed for shared sectors, so a scan is cheap enough.
+static int countFlashPageUsers(int num, int file)
 {
-    int count, num;
+    int addr, owner, users;
+    uint8_t type, i;
 
-    count = 0;
-    for (num = 0; num < 256; num++)
+    users = 0;
+    for (addr = 1; addr <= INODENUM; addr++)
     {
-        if (getbit(vectorflash, num) == 1)
+        type = fsread8uint(addr, TYPEOFFSET);
+        if ((fsread8uint(addr, VALIDOFFSET) != 1)
+            || ((type != FILENODE) && (type != EXTNODE)))
+        {
+            continue;
+        }
+        owner = type == EXTNODE ? fsread8uint(addr, FILE_PARENTOFFSET) : addr;
+        if (owner == file)
         {
-            count++;
+            continue;
+        }
+        for (i = 0; i < 8; i++)
+        {
+            if (fsreadFileSector(addr, i) == num)
+            {
+                users++;
+                break;
+            }
         }
     }
-    return 256 - count;
+    return users;
+}
+
+//-------------------------------------------------------------------------
+void dropFlashPage(int num, int file)
+{
+    int users;
+
+    if (isFlashPageShared(num))
+    {
+        users = countFlashPageUsers(num, file);
+        if (users < 2)
+        {
+            bitvectorSet(vectorshared, num - 1, 0);
+            flashchanged = 1;
+        }
+        if (users > 0)
+        {
+            return;
+        }
+    }
+    releaseFlashPage(num);
+}
+
+//-------------------------------------------------------------------------
+int countVectorFlash()
+{
+    return freeflash;
 }
 
 //-------------------------------------------------------------------------
@@ -134,7 +332,7 @@ void printVectorFlash()
 
     for (i = 0; i < 256; i++)
     {
-        if (getbit(vectorflash, i) == 0)
+        if (bitvectorGet(vectorflash, i) == 0)
         {
             data[i] = 0;
         }
@@ -7,6 +7,7 @@
 
 #ifndef VECTORFLASHH
 #define VECTORFLASHH
+#include "../../types/types.h"
 
 /** @addtogroup filesystem */
 
@@ -23,27 +24,79 @@ void initVectorFlash();
 void scanVectorFlash();
 
 /** @brief Return a flash page. 
+	Pages are handed out least worn first, and every allocation counts as one erase of the page.
 	@return The flash page id. 
 */
 int getFlashPage();
 
+/** @brief Return the first free flash page after a given one, so that a growing file stays contiguous. 
+	@param num The page id to continue from, 0 to start from the beginning. 
+	@return The flash page id. 
+*/
+int getFlashPageAfter(int num);
+
+/** @brief Mark a given flash page as allocated and count its erase. 
+	@param num The page id. 
+	@return Void. 
+*/
+void claimFlashPage(int num);
+
+/** @brief Count an erase of a flash page that is rewritten in place, without being allocated again. 
+	@param num The page id. 
+	@return Void. 
+*/
+void wearFlashPage(int num);
+
+/** @brief Check whether a flash page is free. 
+	@param num The page id. 
+	@return 1 if free, 0 otherwise. 
+*/
+int isFlashPageFree(int num);
+
+/** @brief Get the erase counter of a flash page, relative to the least worn page once the counters have been rebased. 
+	@param num The page id. 
+	@return The erase count. 
+*/
+uint8_t getFlashPageWear(int num);
+
 /**	@brief Release a flash page. 
 	@param num The page number. 
 	@return Void. 
 */
 void releaseFlashPage(int num);
 
+/** @brief Check whether more than one file points to a flash page. 
+	@param num The page id. 
+	@return 1 if shared, 0 otherwise. 
+*/
+int isFlashPageShared(int num);
+
+/** @brief Mark a flash page as shared by a copy of the file that owns it. 
+	@param num The page id. 
+	@return Void. 
+*/
+void shareFlashPage(int num);
+
+/** @brief Drop the reference of a file to a flash page, releasing the page if no other file points to it. 
+	@param num The page id. 
+	@param file The inode of the file, whose continuation inodes do not count as other users either. 
+	@return Void. 
+*/
+void dropFlashPage(int num, int file);
+
 /** @brief Count how many flash pages there are. 
 	@return The counted vector flash page. 
 */
 int countVectorFlash();
 
 /** @brief Write vector flash into external storage. 
+	The write goes through the journal and only happens if the vector changed since it was last written or read.
 	@return Void. 
 */
 void writeVectorFlashToExternalStorage();
 
 /** @brief Read the vector flash from external storage. 
+	Used instead of scanVectorFlash() when the stored vector was committed with the inodes.
 	@return Void. 
 */
 void readVectorFlashFromExternalStorage();
@@ -11,38 +11,31 @@
 #include "fsapi.h"
 #include "../bytestorage/bytestorage.h"
 #include "storageconstants.h"
+#include "bitvector.h"
+#include "journal.h"
 
 char vectornode[12];
+static uint8_t freenodes;
+static uint8_t nodehint;
+static uint8_t nodechanged;
+
 void writeVectorNodeToExternalStorage()
 {
-    genericreadBytes(EEPROMVECTORSTART, 12, vectornode);
+    //the bitmap is committed together with the inodes it was derived from
+    if (nodechanged)
+    {
+        journalWrite(EEPROMVECTORSTART, 12, vectornode);
+        nodechanged = 0;
+    }
 }
 
 //-------------------------------------------------------------------------
 void readVectorNodeFromExternalStorage()
 {
-    genericwriteBytes(EEPROMVECTORSTART, 12, vectornode);
-}
-
-//-------------------------------------------------------------------------
-int getbit(char *set, int number)
-{
-    set += number / 8;
-    return (*set & (1 << (number % 8))) != 0;   /* 0 or 1       */
-}
-
-//-------------------------------------------------------------------------
-void setbit(char *set, int number, int value)
-{
-    set += number / 8;
-    if (value)
-    {
-        *set |= 1 << (number % 8);
-    }                           /* set bit      */
-    else
-    {
-        *set &= ~(1 << (number % 8));
-    }                           /* clear bit    */
+    genericreadBytes(EEPROMVECTORSTART, 12, vectornode);
+    freenodes = 96 - bitvectorCount(vectornode, 96);
+    nodehint = 0;
+    nodechanged = 0;
 }
 
 //-------------------------------------------------------------------------
@@ -54,6 +47,9 @@ void initVectorNode()
     {
         vectornode[i] = 0;
     }
+    freenodes = 96;
+    nodehint = 0;
+    nodechanged = 1;
 }
 
 //-------------------------------------------------------------------------
@@ -61,15 +57,17 @@ int getVectorNode()
 {
     int num;
 
-    for (num = 0; num < 96; num++)
+    if (freenodes == 0)
     {
-        if (getbit(vectornode, num) == 0)
-        {
-            setbit(vectornode, num, 1);
-            return num + 1;
-        }
+        return -1;
     }
-    return -1;
+    //start where the last search ended, so that the used front of the table is not probed again
+    num = bitvectorFindZero(vectornode, 96, nodehint);
+    bitvectorSet(vectornode, num, 1);
+    freenodes--;
+    nodechanged = 1;
+    nodehint = (num + 1) % 96;
+    return num + 1;
 }
 
 //-------------------------------------------------------------------------
@@ -82,36 +80,25 @@ void scanVectorNode()
     {
         addr = num + 1;
         valid = fsread8uint(addr, VALIDOFFSET);
-        if (valid == 0)
-        {
-            setbit(vectornode, num, 0);
-        }
-        else
-        {
-            setbit(vectornode, num, 1);
-        }
+        bitvectorSet(vectornode, num, valid != 0);
     }
+    freenodes = 96 - bitvectorCount(vectornode, 96);
+    nodechanged = 1;
 }
 
 //-------------------------------------------------------------------------
 void releaseVectorNode(int num)
 {
-    setbit(vectornode, num - 1, 0);
+    if (bitvectorSet(vectornode, num - 1, 0))
+    {
+        freenodes++;
+        nodechanged = 1;
+    }
 }
 
 //-------------------------------------------------------------------------
 int countVectorNode()
 {
-    int num, count;
-
-    count = 0;
-    for (num = 0; num < 96; num++)
-    {
-        if (getbit(vectornode, num) == 1)
-        {
-            count++;
-        }
-    }
-    return 96 - count;
+    return freenodes;
 }
 
@@ -39,11 +39,13 @@ void releaseVectorNode(int num);
 int countVectorNode();
 
 /** @brief Write vector node into external storage. 
+	The write goes through the journal and only happens if the vector changed since it was last written or read.
 	@return Void.
 */
 void writeVectorNodeToExternalStorage();
 
 /** @brief Read vector node from external storage. 
+	Used instead of scanVectorNode() when the stored vector was committed with the inodes.
 	@return Void. 
 */
 void readVectorNodeFromExternalStorage();
@@ -0,0 +1,70 @@
+/** @file wearlevel.c
+	 @brief This file implements the background static wear leveling of the flash.
+*/
+
+#include "wearlevel.h"
+#include "fsconfig.h"
+#include "fsapi.h"
+#include "inode.h"
+#include "vectorflash.h"
+
+//-------------------------------------------------------------------------
+void wearLevelTask()
+{
+    int num, addr;
+    uint16_t hot, cold;
+    uint8_t wear, hotwear, coldwear;
+    uint8_t i, type;
+
+    hot = cold = 0;
+    hotwear = 0;
+    coldwear = 255;
+    for (num = 1; num <= FLASH_SECTOR_NUM; num++)
+    {
+        wear = getFlashPageWear(num);
+        if (isFlashPageFree(num))
+        {
+            if ((hot == 0) || (wear > hotwear))
+            {
+                hot = num;
+                hotwear = wear;
+            }
+        }
+        else if (isFlashPageShared(num))
+        {
+            //moving a shared page would have to update every file pointing to it
+            continue;
+        }
+        else if ((cold == 0) || (wear < coldwear))
+        {
+            cold = num;
+            coldwear = wear;
+        }
+    }
+    if ((hot == 0) || (cold == 0) || (hotwear < coldwear + WEAR_LEVEL_THRESHOLD))
+    {
+        return;
+    }
+    //find the inode that points to the cold page
+    for (addr = 1; addr <= INODENUM; addr++)
+    {
+        type = checkNodeValid(addr);
+        if ((type != FILENODE) && (type != EXTNODE))
+        {
+            continue;
+        }
+        for (i = 0; i < 8; i++)
+        {
+            if (fsreadFileSector(addr, i) == cold)
+            {
+                fmapmoved(cold);
+                claimFlashPage(hot);
+                copyVectorPage(cold, hot);
+                fswriteFileSector(addr, i, hot);
+                releaseFlashPage(cold);
+                fsync2();
+                return;
+            }
+        }
+    }
+}
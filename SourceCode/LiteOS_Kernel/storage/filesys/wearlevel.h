@@ -0,0 +1,34 @@
+/** @file wearlevel.h
+	 @brief This file declares the background static wear leveling of the flash.
+*/
+
+
+#ifndef WEARLEVELH
+#define WEARLEVELH
+#include "../../types/types.h"
+
+/** \addtogroup filesystem */
+
+/** @{ */
+
+/** @brief The generic timer that triggers wear leveling. */
+#define WEAR_LEVEL_TIMER 15
+
+/** @brief The wear leveling period in milliseconds. */
+#ifndef WEAR_LEVEL_INTERVAL
+#define WEAR_LEVEL_INTERVAL 60000
+#endif
+
+/** @brief The difference in erase counts between the most worn free page and the least worn allocated page that triggers a migration. */
+#ifndef WEAR_LEVEL_THRESHOLD
+#define WEAR_LEVEL_THRESHOLD 16
+#endif
+
+/** @brief Move the data of the least worn allocated flash page onto the most worn free page.
+	Data that is never rewritten otherwise pins the pages under it, so that all the wear goes to the remaining pages. At most one page is moved per call.
+	@return Void.
+*/
+void wearLevelTask();
+
+/** @} */
+#endif
@@ -11,11 +11,21 @@
 #include "../../types/types.h"
 #include "atmelflash.h"
 #include "../../hardware/avrhardware.h"
+#include "../../utilities/crc.h"
 
 static uint32_t atmel_flash_addr;
+//the buffer receiving writes; the other one is either idle or being programmed
 static uint8_t cur_buff;
-static uint16_t cur_page;
-static uint8_t dirty;           // This will never be set in unbuffered mode
+//the page held by each SRAM buffer and whether it has writes not yet programmed
+static uint16_t buff_page[2];
+static uint8_t buff_dirty[2];
+//the buffer the chip may still be programming into main memory or filling from it, 0 for none
+static uint8_t programming;
+//the buffer that served the last read, 0 if it came from main memory
+static uint8_t read_buff;
+//the buffer pinned to a page for mapped reads, 0 for none
+static uint8_t pinned;
+static atmelflashstats flashstats;
 
 
 #define ATMEL_FLASH_PORT PORTD
@@ -31,6 +41,10 @@ static uint8_t dirty;           // This will never be set in unbuffered mode
 #define ATMEL_FLASH_BUFFER_1 0x1
 #define ATMEL_FLASH_BUFFER_2 0x2
 #define ATMEL_FLASH_DEFAULT_BUFFER ATMEL_FLASH_BUFFER_1
+#define ATMEL_FLASH_OTHER_BUFFER(b) ((b) == ATMEL_FLASH_BUFFER_1 ? ATMEL_FLASH_BUFFER_2 : ATMEL_FLASH_BUFFER_1)
+// Pages hold 256 data bytes; the CRC of the data and its complement are kept in the spare bytes after them
+#define ATMEL_FLASH_DATA_SIZE 256
+#define ATMEL_FLASH_STAMP_SIZE 4
 
 /** opcodes for the device */
 enum
@@ -48,15 +62,18 @@ static uint8_t atmel_flash_send_byte(uint8_t spiOut);
 static uint8_t atmel_flash_get_byte();
 static void atmel_flash_read_memory(uint16_t page, uint16_t offset,
                                     void *reqData, uint16_t len);
+static void atmel_flash_read_buffer(uint8_t selected, uint16_t offset,
+                                    void *reqData, uint16_t len);
 static uint16_t atmel_flash_crc_memory(uint16_t page, uint16_t offset,
-                                       uint32_t len);
+                                       uint32_t len, uint16_t crc);
+static uint16_t atmel_flash_crc_buffer(uint8_t selected, uint16_t offset,
+                                       uint16_t len, uint16_t crc);
 static uint8_t atmel_flash_busy();
 static uint8_t atmel_flash_write_buffer(uint8_t selected, uint16_t offset,
                                         void *reqdata, uint16_t len);
 static uint8_t atmel_flash_flush_buffer(uint8_t selected, uint16_t page);
 static uint8_t atmel_flash_compare_buffer(uint8_t selected, uint16_t page);
 static uint8_t atmel_flash_fill_buffer(uint8_t selected, uint16_t page);
-static uint8_t atmel_flash_erase_page(uint16_t page);
 void copyFlash(int sourcepage, int targetpage);
 static uint16_t dev_read_atmel_flash(void *p, uint16_t count);
 static uint16_t dev_write_atmel_flash(const void *p, uint16_t count);
@@ -86,8 +103,11 @@ void atmel_flash_init(void)
     SREG = sreg;
     atmel_flash_addr = 0;
     cur_buff = ATMEL_FLASH_BUFFER_1;
-    cur_page = ATMEL_FLASH_MAX_PAGES;
-    dirty = 0;
+    buff_page[0] = buff_page[1] = ATMEL_FLASH_MAX_PAGES;
+    buff_dirty[0] = buff_dirty[1] = 0;
+    programming = 0;
+    read_buff = 0;
+    pinned = 0;
     
     _delay_ms(20);
 }
@@ -97,7 +117,7 @@ void readFlash(int pagenum, uint8_t offset, void *buffer, int NumOfBytes)
 {
     uint16_t count;
 
-    atmel_flash_addr = pagenum * 264 + offset;
+    atmel_flash_addr = (uint32_t) pagenum * 264 + offset;
     if (offset + NumOfBytes > 256)
     {
         count = 256 - offset;
@@ -106,21 +126,13 @@ void readFlash(int pagenum, uint8_t offset, void *buffer, int NumOfBytes)
     {
         count = NumOfBytes;
     }
-    while (atmel_flash_busy())
-        ;
     dev_read_atmel_flash(buffer, count);
-    while (atmel_flash_busy())
-        ;
     buffer = (void *)((char *)buffer + count);
     if (count < NumOfBytes)
     {
-        atmel_flash_addr = (pagenum + 1) * 264;
+        atmel_flash_addr = (uint32_t) (pagenum + 1) * 264;
         count = NumOfBytes - count;
-        while (atmel_flash_busy())
-            ;
         dev_read_atmel_flash(buffer, count);
-        while (atmel_flash_busy())
-            ;
     }
     return;
 }
@@ -130,7 +142,9 @@ void writeFlash(int pagenum, uint8_t offset, void *buffer, int NumOfBytes)
 {
     uint16_t count;
 
-    atmel_flash_addr = pagenum * 264 + offset;
+    flashstats.bufferwrites++;
+    flashstats.byteswritten += NumOfBytes;
+    atmel_flash_addr = (uint32_t) pagenum * 264 + offset;
     if (offset + NumOfBytes > 256)
     {
         count = 256 - offset;
@@ -139,60 +153,369 @@ void writeFlash(int pagenum, uint8_t offset, void *buffer, int NumOfBytes)
     {
         count = NumOfBytes;
     }
-    while (atmel_flash_busy())
-        ;
     dev_write_atmel_flash(buffer, count);
-    while (atmel_flash_busy())
-        ;
     buffer = (void *)((char *)buffer + count);
     if (count < NumOfBytes)
     {
-        atmel_flash_addr = (pagenum + 1) * 264;
+        atmel_flash_addr = (uint32_t) (pagenum + 1) * 264;
         count = NumOfBytes - count;
-        while (atmel_flash_busy())
-            ;
         dev_write_atmel_flash(buffer, count);
-        while (atmel_flash_busy())
-            ;
     }
     return;
 }
 
-//-------------------------------------------------------------------------
-void copyFlash(int sourcepage, int targetpage)
+/** @brief Wait until the chip is idle, which also ends any background programming.
+*/
+static void atmel_flash_wait(void)
 {
     while (atmel_flash_busy())
         ;
-    atmel_flash_fill_buffer(1, sourcepage);
-    while (atmel_flash_busy())
-        ;
-    atmel_flash_flush_buffer(1, targetpage);
-    while (atmel_flash_busy())
-        ;
+    programming = 0;
+}
+
+/** @brief Write the CRC of the data in a buffer into its spare bytes, so that it is programmed with the page.
+*/
+static void atmel_flash_stamp(uint8_t selected)
+{
+    uint16_t crc;
+    uint8_t stamp[ATMEL_FLASH_STAMP_SIZE];
+
+    crc = atmel_flash_crc_buffer(selected, 0, ATMEL_FLASH_DATA_SIZE,
+                                 CRC_INIT);
+    stamp[0] = (uint8_t) crc;
+    stamp[1] = (uint8_t) (crc >> 8);
+    stamp[2] = ~stamp[0];
+    stamp[3] = ~stamp[1];
+    atmel_flash_write_buffer(selected, ATMEL_FLASH_DATA_SIZE, stamp,
+                             ATMEL_FLASH_STAMP_SIZE);
+}
+
+/** @brief Start programming a dirty buffer into its page without waiting for it to complete.
+*/
+static void atmel_flash_program(uint8_t selected)
+{
+    if (buff_dirty[selected - 1] == 0)
+    {
+        return;
+    }
+    atmel_flash_wait();
+    atmel_flash_stamp(selected);
+    // The flush command erases the page as part of programming it
+    atmel_flash_flush_buffer(selected, buff_page[selected - 1]);
+    buff_dirty[selected - 1] = 0;
+    programming = selected;
+    flashstats.pageprograms++;
+}
+
+/** @brief Return the buffer holding page, or 0 if neither does.
+*/
+static uint8_t atmel_flash_resident(uint16_t page)
+{
+    if (buff_page[0] == page)
+    {
+        return ATMEL_FLASH_BUFFER_1;
+    }
+    if (buff_page[1] == page)
+    {
+        return ATMEL_FLASH_BUFFER_2;
+    }
+    return 0;
+}
+
+/** @brief Make page the write buffer, loading it into the idle buffer on a miss.
+* The buffer being left is handed to the chip for programming, so that it is
+* programmed while the caller fills the new one.
+* @param whole Whether the caller overwrites the whole page, so no fill is needed
+*/
+static uint8_t atmel_flash_load(uint16_t page, uint8_t whole)
+{
+    uint8_t selected;
+
+    selected = atmel_flash_resident(page);
+    if (selected == 0)
+    {
+        selected = ATMEL_FLASH_OTHER_BUFFER(cur_buff);
+        // A pinned buffer keeps its page, so writes take turns in the other one
+        if (selected == pinned)
+        {
+            selected = cur_buff;
+        }
+        atmel_flash_program(selected);
+        atmel_flash_wait();
+        if (!whole)
+        {
+            atmel_flash_fill_buffer(selected, page);
+            atmel_flash_wait();
+        }
+        buff_page[selected - 1] = page;
+    }
+    if (selected != cur_buff)
+    {
+        atmel_flash_program(cur_buff);
+        cur_buff = selected;
+    }
+    if (programming == selected)
+    {
+        atmel_flash_wait();
+    }
+    return selected;
+}
+
+//-------------------------------------------------------------------------
+uint8_t atmel_flash_page_crc(uint16_t page, uint16_t * crc)
+{
+    uint8_t selected;
+    uint8_t stamp[ATMEL_FLASH_STAMP_SIZE];
+
+    selected = atmel_flash_resident(page);
+    if (selected && buff_dirty[selected - 1])
+    {
+        // The stamp is only written when the page is programmed
+        if (programming == selected)
+        {
+            atmel_flash_wait();
+        }
+        *crc = atmel_flash_crc_buffer(selected, 0, ATMEL_FLASH_DATA_SIZE,
+                                 CRC_INIT);
+        return TRUE;
+    }
+    atmel_flash_addr =
+        (uint32_t) page * ATMEL_FLASH_PAGE_SIZE + ATMEL_FLASH_DATA_SIZE;
+    dev_read_atmel_flash(stamp, ATMEL_FLASH_STAMP_SIZE);
+    if (((uint8_t) ~stamp[0] != stamp[2]) || ((uint8_t) ~stamp[1] != stamp[3]))
+    {
+        // Erased, or programmed before pages were stamped
+        return FALSE;
+    }
+    *crc = stamp[0] | ((uint16_t) stamp[1] << 8);
+    return TRUE;
+}
+
+//-------------------------------------------------------------------------
+uint8_t atmel_flash_verify_page(uint16_t page)
+{
+    uint8_t selected;
+    uint16_t crc, stored;
+
+    if (atmel_flash_page_crc(page, &stored) == FALSE)
+    {
+        return ATMEL_FLASH_UNSTAMPED;
+    }
+    selected = atmel_flash_resident(page);
+    if (selected)
+    {
+        if (programming == selected)
+        {
+            atmel_flash_wait();
+        }
+        crc = atmel_flash_crc_buffer(selected, 0, ATMEL_FLASH_DATA_SIZE,
+                                 CRC_INIT);
+    }
+    else
+    {
+        atmel_flash_wait();
+        crc = atmel_flash_crc_memory(page, 0, ATMEL_FLASH_DATA_SIZE,
+                                     CRC_INIT);
+    }
+    return crc == stored ? ATMEL_FLASH_VERIFIED : ATMEL_FLASH_CORRUPTED;
+}
+
+//-------------------------------------------------------------------------
+void prefetchFlash(int pagenum)
+{
+    uint8_t selected;
+
+    if (atmel_flash_resident(pagenum))
+    {
+        return;
+    }
+    // Keep the page being consumed and fill the other buffer
+    if (read_buff)
+    {
+        selected = ATMEL_FLASH_OTHER_BUFFER(read_buff);
+    }
+    else
+    {
+        selected = ATMEL_FLASH_OTHER_BUFFER(cur_buff);
+    }
+    if ((selected == pinned) || buff_dirty[selected - 1]
+        || (atmel_flash_ready() == FALSE))
+    {
+        return;
+    }
+    atmel_flash_fill_buffer(selected, pagenum);
+    buff_page[selected - 1] = pagenum;
+    programming = selected;
+    flashstats.prefetches++;
+}
+
+//-------------------------------------------------------------------------
+void atmel_flash_pin(uint16_t page)
+{
+    uint8_t selected;
+
+    selected = atmel_flash_resident(page);
+    if (selected == 0)
+    {
+        // The buffer receiving writes is left to them
+        selected = ATMEL_FLASH_OTHER_BUFFER(cur_buff);
+        atmel_flash_program(selected);
+        atmel_flash_wait();
+        atmel_flash_fill_buffer(selected, page);
+        buff_page[selected - 1] = page;
+        programming = selected;
+    }
+    if (programming == selected)
+    {
+        atmel_flash_wait();
+    }
+    pinned = selected;
+}
+
+//-------------------------------------------------------------------------
+uint8_t atmel_flash_read_pinned(uint16_t page, uint8_t offset, void *buffer,
+                                uint16_t NumOfBytes)
+{
+    if ((pinned == 0) || (buff_page[pinned - 1] != page))
+    {
+        return FALSE;
+    }
+    // The buffer is programmed when the page it holds was written, and cannot be read until that completes
+    if ((programming == pinned) && (atmel_flash_ready() == FALSE))
+    {
+        return FALSE;
+    }
+    atmel_flash_read_buffer(pinned, offset, buffer, NumOfBytes);
+    flashstats.mappedreads++;
+    return TRUE;
+}
+
+//-------------------------------------------------------------------------
+void atmel_flash_unpin(void)
+{
+    pinned = 0;
+}
+
+//-------------------------------------------------------------------------
+uint8_t atmel_flash_ready(void)
+{
+    if (atmel_flash_busy())
+    {
+        return FALSE;
+    }
+    programming = 0;
+    return TRUE;
+}
+
+//-------------------------------------------------------------------------
+void atmel_flash_sync(void)
+{
+    atmel_flash_program(ATMEL_FLASH_BUFFER_1);
+    atmel_flash_program(ATMEL_FLASH_BUFFER_2);
+    atmel_flash_wait();
+}
+
+//-------------------------------------------------------------------------
+void atmel_flash_statistics(atmelflashstats * stats)
+{
+    *stats = flashstats;
+}
+
+//-------------------------------------------------------------------------
+void copyFlash(int sourcepage, int targetpage)
+{
+    uint8_t selected;
+
+    // The copy goes through main memory, so the source must be programmed first
+    selected = atmel_flash_resident(sourcepage);
+    if (selected)
+    {
+        atmel_flash_program(selected);
+    }
+    // A buffered copy of the target is overwritten by the copy
+    selected = atmel_flash_resident(targetpage);
+    if (selected)
+    {
+        if (programming == selected)
+        {
+            atmel_flash_wait();
+        }
+        buff_page[selected - 1] = ATMEL_FLASH_MAX_PAGES;
+        buff_dirty[selected - 1] = 0;
+        if (selected == pinned)
+        {
+            pinned = 0;
+        }
+    }
+    // Reuse the buffer of the source if it is resident, otherwise fill the idle one
+    selected = atmel_flash_resident(sourcepage);
+    if (selected == 0)
+    {
+        selected = ATMEL_FLASH_OTHER_BUFFER(cur_buff);
+        if (selected == pinned)
+        {
+            selected = cur_buff;
+        }
+        atmel_flash_program(selected);
+        atmel_flash_wait();
+        atmel_flash_fill_buffer(selected, sourcepage);
+    }
+    atmel_flash_wait();
+    atmel_flash_flush_buffer(selected, targetpage);
+    // A pinned buffer holds the same data as the source, and stays with it
+    if (selected != pinned)
+    {
+        buff_page[selected - 1] = targetpage;
+    }
+    programming = selected;
+    flashstats.pageprograms++;
 }
 
 /** @brief Read from the current flash address into p, for count bytes
 */
 static uint16_t dev_read_atmel_flash(void *p, uint16_t count)
 {
-    uint16_t page, offset;
+    uint16_t page, offset, num_bytes;
+    uint16_t index = 0;
     uint8_t *buf = (uint8_t *) p;
+    uint8_t selected;
 
     page = atmel_flash_addr / ATMEL_FLASH_PAGE_SIZE;
     offset = atmel_flash_addr % ATMEL_FLASH_PAGE_SIZE;
-    if (dirty && page <= cur_page && page + (offset + count) /
-        ATMEL_FLASH_PAGE_SIZE >= cur_page)
+    while (count > 0)
     {
-        while (atmel_flash_busy())
-            ;
-        atmel_flash_flush_buffer(cur_buff, cur_page);
-        dirty = 0;
+        if (count + offset > ATMEL_FLASH_PAGE_SIZE)
+        {
+            num_bytes = ATMEL_FLASH_PAGE_SIZE - offset;
+        }
+        else
+        {
+            num_bytes = count;
+        }
+        // Pages held in a buffer are read from it, even if not yet programmed
+        selected = atmel_flash_resident(page);
+        if (selected)
+        {
+            if (programming == selected)
+            {
+                atmel_flash_wait();
+            }
+            atmel_flash_read_buffer(selected, offset, &buf[index], num_bytes);
+            flashstats.readhits++;
+        }
+        else
+        {
+            atmel_flash_wait();
+            atmel_flash_read_memory(page, offset, &buf[index], num_bytes);
+        }
+        read_buff = selected;
+        index += num_bytes;
+        atmel_flash_addr += num_bytes;
+        count -= num_bytes;
+        page++;
+        offset = 0;
     }
-    // Wait for any previous actions to complete
-    while (atmel_flash_busy())
-        ;
-    atmel_flash_read_memory(page, offset, buf, count);
-    return count;
+    return index;
 }
 
 /** @brief Write p into the current flash address, for count bytes
@@ -202,11 +525,10 @@ static uint16_t dev_write_atmel_flash(const void *p, uint16_t count)
     uint16_t page, offset, num_bytes;
     uint16_t index = 0;
     uint8_t *buf = (uint8_t *) p;
+    uint8_t selected;
 
     page = atmel_flash_addr / ATMEL_FLASH_PAGE_SIZE;
     offset = atmel_flash_addr % ATMEL_FLASH_PAGE_SIZE;
-    while (atmel_flash_busy())
-        ;
     while (count > 0)
     {
         if (count + offset > ATMEL_FLASH_PAGE_SIZE)
@@ -217,33 +539,11 @@ static uint16_t dev_write_atmel_flash(const void *p, uint16_t count)
         {
             num_bytes = count;
         }
-        if (page != cur_page)
-        {
-            if (dirty)
-            {
-                while (atmel_flash_busy())
-                    ;
-                atmel_flash_flush_buffer(cur_buff, cur_page);
-                dirty = 0;
-            }
-            cur_buff =
-                (cur_buff ==
-                 ATMEL_FLASH_BUFFER_1 ? ATMEL_FLASH_BUFFER_2 :
-                 ATMEL_FLASH_BUFFER_1);
-            cur_page = page;
-            if (num_bytes < ATMEL_FLASH_PAGE_SIZE)
-            {
-                while (atmel_flash_busy())
-                    ;
-                atmel_flash_fill_buffer(cur_buff, page);
-            }
-            // Erase next page right now
-            while (atmel_flash_busy())
-                ;
-            atmel_flash_erase_page(page);
-        }
-        atmel_flash_write_buffer(cur_buff, offset, &buf[index], num_bytes);
-        dirty = 1;
+        // Writing into the SRAM buffer is allowed while the other one is programmed
+        selected =
+            atmel_flash_load(page, num_bytes == ATMEL_FLASH_PAGE_SIZE);
+        atmel_flash_write_buffer(selected, offset, &buf[index], num_bytes);
+        buff_dirty[selected - 1] = 1;
         index += num_bytes;
         atmel_flash_addr += num_bytes;
         count -= num_bytes;
@@ -259,16 +559,17 @@ uint8_t atmel_flash_compare(uint8_t * buf, uint16_t count)
     uint16_t index = 0;
     uint8_t compare = 0;
 
-    if (dirty)
+    // The comparison runs against main memory and uses the default buffer
+    atmel_flash_sync();
+    if (cur_buff == ATMEL_FLASH_DEFAULT_BUFFER)
     {
-        while (atmel_flash_busy())
-            ;
-        atmel_flash_flush_buffer(cur_buff, cur_page);
-        dirty = 0;
+        cur_buff = ATMEL_FLASH_OTHER_BUFFER(ATMEL_FLASH_DEFAULT_BUFFER);
+    }
+    buff_page[ATMEL_FLASH_DEFAULT_BUFFER - 1] = ATMEL_FLASH_MAX_PAGES;
+    if (pinned == ATMEL_FLASH_DEFAULT_BUFFER)
+    {
+        pinned = 0;
     }
-    // Wait for any previous actions to complete
-    while (atmel_flash_busy())
-        ;
     while (count > 0)
     {
         page = atmel_flash_addr / ATMEL_FLASH_PAGE_SIZE;
@@ -313,18 +614,9 @@ uint16_t atmel_flash_crc(uint32_t count)
 
     page = atmel_flash_addr / ATMEL_FLASH_PAGE_SIZE;
     offset = atmel_flash_addr % ATMEL_FLASH_PAGE_SIZE;
-    if (dirty && page <= cur_page && page + (offset + count) /
-        ATMEL_FLASH_PAGE_SIZE >= cur_page)
-    {
-        while (atmel_flash_busy())
-            ;
-        atmel_flash_flush_buffer(cur_buff, cur_page);
-        dirty = 0;
-    }
-    // Wait for any previous actions to complete
-    while (atmel_flash_busy())
-        ;
-    crc = atmel_flash_crc_memory(page, offset, count);
+    // The crc is computed over main memory
+    atmel_flash_sync();
+    crc = atmel_flash_crc_memory(page, offset, count, CRC_AUGMENTED_INIT);
     return crc;
 }
 
@@ -495,13 +787,45 @@ static void atmel_flash_read_memory(uint16_t page, uint16_t offset,
     atmel_flash_high();
 }
 
-/** @brief Compute crc on main memory without using a buffer.
+/** @brief Read from an SRAM buffer without touching main memory.
+*/
+static void atmel_flash_read_buffer(uint8_t selected, uint16_t offset,
+                                    void *reqData, uint16_t len)
+{
+    uint8_t cmd[5], *reqPtr;
+    uint16_t i;
+
+    if (selected == 1)
+    {
+        cmd[0] = C_READ_BUFFER1;
+    }                           // 8 bit of op code
+    else
+    {
+        cmd[0] = C_READ_BUFFER2;
+    }                           // 8 bit of op code
+    cmd[1] = 0x00;              // 8 bit don't care code
+    cmd[2] = offset >> 8;       // 7 bit don't care code with 1 bit address
+    cmd[3] = offset;            // low-order 8 address bits
+    cmd[4] = 0x00;              // 8 bit don't care code
+    reqPtr = (uint8_t *) reqData;
+    atmel_flash_low();
+    for (i = 0; i < sizeof(cmd); i++)
+    {
+        atmel_flash_send_byte(cmd[i]);
+    }
+    for (i = 0; i < len; i++)
+    {
+        reqPtr[i] = atmel_flash_get_byte();
+    }
+    atmel_flash_high();
+}
+
+/** @brief Compute crc on main memory without using a buffer, continuing from crc.
 */
 static uint16_t atmel_flash_crc_memory(uint16_t page, uint16_t offset,
-                                       uint32_t len)
+                                       uint32_t len, uint16_t crc)
 {
     uint8_t cmd[8];
-    uint16_t crc;
     uint32_t i;
 
     cmd[0] = C_READ_THROUGH_MEMORY;     // 8 bit of op code
@@ -517,58 +841,42 @@ static uint16_t atmel_flash_crc_memory(uint16_t page, uint16_t offset,
     {
         atmel_flash_send_byte(cmd[i]);
     }
-    // The following code was adapted directly from crc.c
+    for (i = 0; i < len; i++)
     {
-        uint8_t v, xor_flag, byte, bit;
+        crc = crcXmodemUpdate(crc, atmel_flash_get_byte());
+    }
+    atmel_flash_high();
+    return crc;
+}
 
-        crc = 0xFFFF /*INITIAL_VALUE */ ;
-        for (i = 0; i < len; i++)
-        {
-            // Read the current byte from flash
-            byte = atmel_flash_get_byte();
-            v = 0x80;
-            for (bit = 0; bit < 8; bit++)
-            {
-                if (crc & 0x8000)
-                {
-                    xor_flag = 1;
-                }
-                else
-                {
-                    xor_flag = 0;
-                }
-
-                crc = crc << 1;
-                if (byte & v)
-                {
-                    crc = crc + 1;
-                }
-
-                if (xor_flag)
-                {
-                    crc = crc ^ 0x1021 /*POLY*/;
-                }
-
-                v = v >> 1;
-            }
-        }
-        for (bit = 0; bit < 16; bit++)
-        {
-            if (crc & 0x8000)
-            {
-                xor_flag = 1;
-            }
-            else
-            {
-                xor_flag = 0;
-            }
+/** @brief Compute crc on the data in an SRAM buffer.
+*/
+static uint16_t atmel_flash_crc_buffer(uint8_t selected, uint16_t offset,
+                                       uint16_t len, uint16_t crc)
+{
+    uint8_t cmd[5];
+    uint16_t i;
 
-            crc = crc << 1;
-            if (xor_flag)
-            {
-                crc = crc ^ 0x1021 /*POLY*/;
-            }
-        }
+    if (selected == 1)
+    {
+        cmd[0] = C_READ_BUFFER1;
+    }                           // 8 bit of op code
+    else
+    {
+        cmd[0] = C_READ_BUFFER2;
+    }                           // 8 bit of op code
+    cmd[1] = 0x00;              // 8 bit don't care code
+    cmd[2] = offset >> 8;       // 7 bit don't care code with 1 bit address
+    cmd[3] = offset;            // low-order 8 address bits
+    cmd[4] = 0x00;              // 8 bit don't care code
+    atmel_flash_low();
+    for (i = 0; i < sizeof(cmd); i++)
+    {
+        atmel_flash_send_byte(cmd[i]);
+    }
+    for (i = 0; i < len; i++)
+    {
+        crc = crcXmodemUpdate(crc, atmel_flash_get_byte());
     }
     atmel_flash_high();
     return crc;
@@ -733,11 +1041,6 @@ static uint8_t atmel_flash_fill_buffer(uint8_t selected, uint16_t page)
 {
     uint8_t i, cmd[4];
 
-    while (atmel_flash_busy())
-        ;
-    atmel_flash_flush_buffer(cur_buff, cur_page);
-    while (atmel_flash_busy())
-        ;
     if (selected == 1)
     {
         cmd[0] = C_FILL_BUFFER1;
@@ -759,28 +1062,6 @@ static uint8_t atmel_flash_fill_buffer(uint8_t selected, uint16_t page)
     return TRUE;
 }
 
-/** @brief Erase a whole page in the memory. 
-* @param page Page to erase 
-* @return TRUE if success, else return FALSE
-*/
-static uint8_t atmel_flash_erase_page(uint16_t page)
-{
-    uint8_t i, cmd[4];
-
-    cmd[0] = C_ERASE_PAGE;      // 8 bit of op code
-    cmd[1] = page >> 7;         // 4 bit reserve and high 4 MSB
-    cmd[2] = page << 1;         // 7 bit page and 1 bit don't care MSB
-    cmd[3] = 0x00;              // 8 bit don't care code
-    // put the cs to low in order to begin writing
-    atmel_flash_low();
-    for (i = 0; i < sizeof(cmd); i++)
-    {
-        atmel_flash_send_byte(cmd[i]);
-    }
-    atmel_flash_high();
-    return TRUE;
-}
-
 //-------------------------------------------------------------------------
 inline uint16_t atmel_flash_pagesize()
 {
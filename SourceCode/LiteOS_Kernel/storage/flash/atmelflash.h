@@ -14,6 +14,22 @@
  */
 /** @{ */
 
+/** @brief Counters kept by the buffered write path. */
+typedef struct
+{
+    uint32_t byteswritten;      //bytes passed to writeFlash
+    uint16_t bufferwrites;      //writeFlash calls, each served by an SRAM buffer
+    uint16_t pageprograms;      //buffer-to-page programs, the operations that wear the flash
+    uint16_t readhits;          //page reads served from an SRAM buffer
+    uint16_t prefetches;        //pages loaded into an SRAM buffer ahead of a sequential reader
+    uint16_t mappedreads;       //reads served from the pinned SRAM buffer by atmel_flash_read_pinned
+} atmelflashstats;
+
+/** @brief The results of atmel_flash_verify_page(). */
+#define ATMEL_FLASH_VERIFIED 0
+#define ATMEL_FLASH_CORRUPTED 1
+#define ATMEL_FLASH_UNSTAMPED 2
+
 /** @brief Initialize the flash.
 	@return Void.
 */
@@ -50,6 +66,54 @@ inline uint16_t atmel_flash_pagesize();
 inline uint16_t atmel_flash_pagenumber();
 
 
+/** @brief Start loading a page into an SRAM buffer, so that a later read of it is served from the buffer.
+	The load runs in the background, and the buffer that served the last read is kept for the rest of that page. Nothing is done if the chip is busy or no clean buffer is free, since a read-ahead must never stall its caller.
+	@param pagenum The page number.
+	@return Void.
+*/
+void prefetchFlash(int pagenum);
+
+/** @brief Pin an SRAM buffer to a page, loading the page into it, so that atmel_flash_read_pinned() reads it without touching main memory.
+	One buffer at most is pinned, and the other is left to writes, which lose their overlap with page programs while the pin lasts. Pinning another page moves the pin.
+	@param page The page number.
+	@return Void.
+*/
+void atmel_flash_pin(uint16_t page);
+
+/** @brief Read from the pinned SRAM buffer without waiting.
+	@param page The page the caller expects to be pinned.
+	@param offset The offset.
+	@param buffer The buffer pointer.
+	@param NumOfBytes The number of bytes.
+	@return TRUE if the bytes were read, FALSE if the buffer no longer holds the page or is being programmed, in which case the page must be pinned again.
+*/
+uint8_t atmel_flash_read_pinned(uint16_t page, uint8_t offset, void *buffer,
+                                uint16_t NumOfBytes);
+
+/** @brief Release the pinned SRAM buffer.
+	@return Void.
+*/
+void atmel_flash_unpin();
+
+/** @brief Check whether the flash can accept a command without waiting.
+	Page programs started by the write path run in the background for milliseconds. Callers that must not stall poll this function instead of issuing a command that would wait.
+	@return TRUE if the flash is idle, else FALSE.
+*/
+uint8_t atmel_flash_ready();
+
+/** @brief Program the buffered pages into main memory and wait for completion.
+	Writes are kept in the chip's two SRAM buffers and programmed only when the written page changes, so this must be called before the data is expected to survive a reset.
+	@return Void.
+*/
+void atmel_flash_sync();
+
+/** @brief Get the counters of the buffered write path.
+	The difference between bufferwrites and pageprograms is the number of page programs saved by buffering.
+	@param stats The destination of the counters.
+	@return Void.
+*/
+void atmel_flash_statistics(atmelflashstats * stats);
+
 /** @brief Copy one page to another.
 	@param sourcepage The source of the page.
 	@param targetpage The target of the page.
@@ -57,6 +121,20 @@ inline uint16_t atmel_flash_pagenumber();
 */
 void copyFlash(int sourcepage, int targetpage);
 
+/** @brief Get the CRC of the 256 data bytes of a page.
+	The CRC (crcXmodemUpdate() from CRC_INIT) is stamped into the spare bytes of a page whenever it is programmed, so getting it costs a 4-byte read. A page with unprogrammed writes has its CRC computed from the buffer instead.
+	@param page The page number.
+	@param crc The destination of the CRC.
+	@return TRUE if the page has a stamp, FALSE if it was never programmed through the stamping write path.
+*/
+uint8_t atmel_flash_page_crc(uint16_t page, uint16_t * crc);
+
+/** @brief Check the data of a page against the CRC stamped with it.
+	@param page The page number.
+	@return ATMEL_FLASH_VERIFIED, ATMEL_FLASH_CORRUPTED, or ATMEL_FLASH_UNSTAMPED if there is nothing to check against.
+*/
+uint8_t atmel_flash_verify_page(uint16_t page);
+
 /** @brief Compare the contents of the page. 
 	@param p The comparison pointer.
 	@param count The number of bytes.
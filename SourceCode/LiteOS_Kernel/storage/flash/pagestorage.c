@@ -39,6 +39,31 @@ void readpagestorage(int pagenum, uint8_t offset, void *buffer, int NumOfBytes)
     readFlash(pagenum, offset, buffer, NumOfBytes);
 }
 
+//Start loading a page that a sequential reader will reach next
+void prefetchpagestorage(int pagenum)
+{
+    prefetchFlash(pagenum);
+}
+
+//Keep a page in an SRAM buffer of the flash for mapped reads
+void mappagestorage(int pagenum)
+{
+    atmel_flash_pin(pagenum);
+}
+
+//Read the mapped page, unless that would wait on the flash
+uint8_t readmappedpagestorage(int pagenum, uint8_t offset, void *buffer,
+                              int NumOfBytes)
+{
+    return atmel_flash_read_pinned(pagenum, offset, buffer, NumOfBytes);
+}
+
+//Release the mapped page
+void unmappagestorage()
+{
+    atmel_flash_unpin();
+}
+
 //Write to a page.  Intra-page only. 
 void writepagestorage(int pagenum, uint8_t offset, void *buffer, int
                       NumOfBytes)
@@ -51,5 +76,23 @@ void copyPage(int sourcepage, int targetpage)
 	   copyFlash(sourcepage, targetpage); 
 }
 
+//Check a page against its stamped CRC; the driver results match the PAGE_ constants
+uint8_t verifypagestorage(int pagenum)
+{
+    return atmel_flash_verify_page(pagenum);
+}
+
+//Check whether the storage is idle, so that an operation will not wait on it
+uint8_t pagestorageready()
+{
+    return atmel_flash_ready();
+}
+
+//Make buffered page writes durable
+void syncpagestorage()
+{
+    atmel_flash_sync();
+}
+
 //-------------------------------------------------------------------------
 #endif
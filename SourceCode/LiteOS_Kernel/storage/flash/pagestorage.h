@@ -12,6 +12,13 @@
 
 #include "../../types/types.h"
 
+/** @ingroup pagestorage 
+	@brief The results of verifypagestorage(). 
+*/
+#define PAGE_VERIFIED 0
+#define PAGE_CORRUPTED 1
+#define PAGE_UNSTAMPED 2
+
 /** @ingroup pagestorage 
 	@brief Get the size of a storage page.
 	@return The size of the storage page. 
@@ -40,6 +47,37 @@ void pagestorageinit();
 void readpagestorage(int pagenum, uint8_t offset, void *buffer,
                      int NumOfBytes);
 
+/** @ingroup pagestorage 
+	@brief Hint that a page is about to be read, so that the storage may start loading it. 
+	@param pagenum The page number.
+	@return Void. 
+*/
+void prefetchpagestorage(int pagenum);
+
+/** @ingroup pagestorage 
+	@brief Keep a page where readmappedpagestorage() reads it without waiting on the storage, until another page is mapped or unmappagestorage() is called.
+	@param pagenum The page number.
+	@return Void. 
+*/
+void mappagestorage(int pagenum);
+
+/** @ingroup pagestorage 
+	@brief Read from the mapped page without waiting. Intra-page only.
+	@param pagenum The page the caller expects to be mapped.
+	@param offset The offset in the page.
+	@param buffer The destination buffer.
+	@param NumOfBytes The number of bytes.
+	@return TRUE if the bytes were read, FALSE if the page is no longer mapped or the storage is busy with it.
+*/
+uint8_t readmappedpagestorage(int pagenum, uint8_t offset, void *buffer,
+                              int NumOfBytes);
+
+/** @ingroup pagestorage 
+	@brief Release the mapped page.
+	@return Void. 
+*/
+void unmappagestorage();
+
 /** @ingroup pagestorage 
 	@brief Write to a page. 
 	@param pagenum The page number.
@@ -57,4 +95,24 @@ void writepagestorage(int pagenum, uint8_t offset, void *buffer, int
 	@return Void. 
 */					 
 void copyPage(int sourcepage, int targetpage);                     
+
+/** @ingroup pagestorage 
+	@brief Check the data of a page against the CRC the storage keeps with it. 
+	@param pagenum The page number. 
+	@return PAGE_VERIFIED, PAGE_CORRUPTED, or PAGE_UNSTAMPED if the storage has no CRC for the page. 
+*/
+uint8_t verifypagestorage(int pagenum);
+
+/** @ingroup pagestorage 
+	@brief Check whether the storage is idle. 
+	@return TRUE if an operation can start without waiting for a page program. 
+*/
+uint8_t pagestorageready();
+
+/** @ingroup pagestorage 
+	@brief Write buffered page contents into the storage. 
+	Page writes may be held in a write-back buffer until the written page changes. 
+	@return Void. 
+*/
+void syncpagestorage();
 #endif
@@ -7,6 +7,8 @@
 
 #include "socketeeprom.h"
 #include "../storage/bytestorage/bytestorage.h"
+#include "../storage/bytestorage/kvstore.h"
+#include "../storage/filesys/storageconstants.h"
 
 
 static genericByteStorageTaskNode storageTask;
@@ -26,6 +28,38 @@ void genericReadTask()
 //-------------------------------------------------------------------------
 void genericWriteTask()
 {
+    //the kernel owns the byte storage from address 0, so a raw write overlaps it unless it starts past the end
+    if ((storageTask.nBytes > 0) && (storageTask.addr < KERNELBYTESEND))
+    {
+        storageTask.nBytes = 0xffff;
+        return;
+    }
     genericwriteBytes(storageTask.addr, storageTask.nBytes, (void *)
                       storageTask.buffer);
+    storageTask.nBytes = 0;
+}
+
+//-------------------------------------------------------------------------
+void genericReadKeyTask()
+{
+    uint8_t size;
+
+    size = storageTask.nBytes > 255 ? 255 : (uint8_t) storageTask.nBytes;
+    storageTask.nBytes =
+        (uint16_t) kvGet((uint8_t) storageTask.addr, storageTask.buffer, size);
+}
+
+//-------------------------------------------------------------------------
+void genericWriteKeyTask()
+{
+    //the keys below KV_KEY_USER hold the node configuration, which applications may read but not change
+    if ((storageTask.addr < KV_KEY_USER) || (storageTask.addr >= KV_KEYS)
+        || (storageTask.nBytes > KV_MAX_VALUE))
+    {
+        storageTask.nBytes = 0xffff;
+        return;
+    }
+    storageTask.nBytes =
+        (uint16_t) kvPut((uint8_t) storageTask.addr, storageTask.buffer,
+                         (uint8_t) storageTask.nBytes);
 }
@@ -37,11 +37,21 @@ void *getGenericStorageNodeAddress();
 void genericReadTask();
 
 //-------------------------------------------------------------------------
-/** @brief Generic write task.
-	@return Void. 
+/** @brief Generic write task. Writes that overlap the byte storage the kernel owns are refused, and as the kernel owns all of it on the current platforms, every raw write is.
+	@return Void. The number of bytes becomes 0 on success, or 0xffff if the write is refused.
 */
 void genericWriteTask();
 
+/** @brief Read the value of a key of the key-value store. The key is taken from the address and the buffer size from the number of bytes.
+	@return Void. The number of bytes becomes the length of the value, or 0xffff if the key has no value that fits.
+*/
+void genericReadKeyTask();
+
+/** @brief Write the value of a key of the key-value store. The key is taken from the address and the length from the number of bytes. Keys below KV_KEY_USER hold the node configuration and are refused.
+	@return Void. The number of bytes becomes 0 on success, or 0xffff on failure.
+*/
+void genericWriteKeyTask();
+
 
 /** @} */
 #endif 
@@ -12,24 +12,38 @@
 #include "../kernel/threaddata.h"
 
 #include "../storage/filesys/fsapi.h"
+#include "../storage/filesys/logfile.h"
 
 #include "../kernel/scheduling.h"
+#include "../storage/flash/pagestorage.h"
+#include "../timer/generictimer.h"
 
 
 char filepathaddr[20];
 char filemodeaddr[5];
 
 extern volatile thread *current_thread;
-  
-volatile thread *openthread;
+extern thread thread_table[LITE_MAX_THREADS];
 
-uint8_t threadindex;
 MYFILE *filehandle;
-uint8_t *databuffer;
-uint16_t nBytes;
 int offset, position;
 
+//the pending request of each thread, which is blocked on the file barrier until it is served
+//the request codes are the barrier ids the library blocks on
+enum
+{
+    FILE_REQUEST_NONE = 0, FILE_REQUEST_OPEN = 1, FILE_REQUEST_CLOSE = 2,
+    FILE_REQUEST_READ = 3, FILE_REQUEST_WRITE = 4, FILE_REQUEST_READRECORD = 5,
+    FILE_REQUEST_MAP = 6, FILE_REQUEST_VERIFY = 7, FILE_REQUEST_CREATERING = 8
+};
+static uint8_t filerequests[LITE_MAX_THREADS];
+//the path and mode of a pending open or ring creation, copied out of the shared buffers when it is requested
+static char openpaths[LITE_MAX_THREADS][20];
+static char openmodes[LITE_MAX_THREADS][5];
+static uint8_t nextrequest;
+static volatile uint8_t servicescheduled;
 
+static void fileservice_task();
 
 //-------------------------------------------------------------------------
 //Get the file path address
@@ -46,71 +60,222 @@ void *getFileModeAddress()
 }
 
 //-------------------------------------------------------------------------
-void openfile_task()
+static void scheduleFileService()
 {
-    MYFILE *temp = fsopen(filepathaddr, filemodeaddr);
+    _atomic_t currentatomic;
+
+    currentatomic = _atomic_start();
+    if (servicescheduled == 0)
+    {
+        servicescheduled = 1;
+        if (postTask(fileservice_task, 5) == FALSE)
+        {
+            GenericTimerStart(FILE_REQUEST_TIMER, TIMER_ONE_SHOT,
+                              FILE_REQUEST_POLL_INTERVAL);
+        }
+    }
+    _atomic_end(currentatomic);
+}
 
-    openthread->filedata.filestate.fileptr = (uint8_t *) temp;
-    
-	 barrier_unblock(7, 1);
+//-------------------------------------------------------------------------
+//Serve one pending request per run, rotating among the threads, so that other tasks such as radio reception run between requests
+static void fileservice_task()
+{
+    uint8_t i, index, request;
+    volatile thread *requester;
 
-     return;
+    for (i = 0; i < LITE_MAX_THREADS; i++)
+    {
+        index = (nextrequest + i) % LITE_MAX_THREADS;
+        if (filerequests[index] != FILE_REQUEST_NONE)
+        {
+            break;
+        }
+    }
+    if (i == LITE_MAX_THREADS)
+    {
+        servicescheduled = 0;
+        return;
+    }
+    //a page is still being programmed: come back later instead of spinning on the flash status
+    if (!pagestorageready())
+    {
+        GenericTimerStart(FILE_REQUEST_TIMER, TIMER_ONE_SHOT,
+                          FILE_REQUEST_POLL_INTERVAL);
+        return;
+    }
+    request = filerequests[index];
+    filerequests[index] = FILE_REQUEST_NONE;
+    nextrequest = (index + 1) % LITE_MAX_THREADS;
+    requester = &thread_table[index];
+    switch (request)
+    {
+    case FILE_REQUEST_OPEN:
+        requester->filedata.filestate.fileptr =
+            (uint8_t *) fsopen(openpaths[index], openmodes[index]);
+        break;
+    case FILE_REQUEST_CLOSE:
+        fclose2((MYFILE *) requester->filedata.filestate.fileptr);
+        break;
+    case FILE_REQUEST_READ:
+        fread2((MYFILE *) requester->filedata.filestate.fileptr,
+               requester->filedata.filestate.bufferptr,
+               requester->filedata.filestate.bytes);
+        break;
+    case FILE_REQUEST_WRITE:
+        fwrite2((MYFILE *) requester->filedata.filestate.fileptr,
+                requester->filedata.filestate.bufferptr,
+                requester->filedata.filestate.bytes);
+        break;
+    case FILE_REQUEST_READRECORD:
+        //the length of the record goes back through the byte count
+        requester->filedata.filestate.bytes =
+            (uint16_t) freadrecord((MYFILE *) requester->filedata.filestate.
+                                   fileptr,
+                                   requester->filedata.filestate.bufferptr,
+                                   requester->filedata.filestate.bytes);
+        break;
+    case FILE_REQUEST_MAP:
+        requester->filedata.filestate.bytes =
+            (uint16_t) fmap((MYFILE *) requester->filedata.filestate.fileptr);
+        break;
+    case FILE_REQUEST_VERIFY:
+        requester->filedata.filestate.bytes =
+            (uint16_t) fverify((MYFILE *) requester->filedata.filestate.
+                               fileptr);
+        break;
+    case FILE_REQUEST_CREATERING:
+        //the capacity does not fit the byte count, so the buffer points at it
+        requester->filedata.filestate.bytes =
+            (uint16_t) fcreatering(openpaths[index],
+                                   *(int32_t *) requester->filedata.
+                                   filestate.bufferptr);
+        break;
+    }
+    barrier_unblock_thread(index, 7, request);
+    servicescheduled = 0;
+    for (i = 0; i < LITE_MAX_THREADS; i++)
+    {
+        if (filerequests[i] != FILE_REQUEST_NONE)
+        {
+            scheduleFileService();
+            break;
+        }
+    }
+}
 
+//-------------------------------------------------------------------------
+static void postFileRequest(uint8_t request)
+{
+    filerequests[current_thread - thread_table] = request;
+    scheduleFileService();
+}
+
+//-------------------------------------------------------------------------
+void fileRequestTimerFired()
+{
+    if (postTask(fileservice_task, 5) == FALSE)
+    {
+        GenericTimerStart(FILE_REQUEST_TIMER, TIMER_ONE_SHOT,
+                          FILE_REQUEST_POLL_INTERVAL);
+    }
+}
+
+//-------------------------------------------------------------------------
+static void copyFilePath(uint8_t index)
+{
+    uint8_t i;
+
+    for (i = 0; i < sizeof(filepathaddr) - 1 && filepathaddr[i] != 0; i++)
+    {
+        openpaths[index][i] = filepathaddr[i];
+    }
+    openpaths[index][i] = 0;
 }
 
 //-------------------------------------------------------------------------
 void openFileTask()
 {
-    openthread = current_thread;
-    postTask(openfile_task, 5);
+    uint8_t index, i;
+
+    //another thread may fill the shared buffers before this open is served
+    index = current_thread - thread_table;
+    copyFilePath(index);
+    for (i = 0; i < sizeof(filemodeaddr) - 1 && filemodeaddr[i] != 0; i++)
+    {
+        openmodes[index][i] = filemodeaddr[i];
+    }
+    openmodes[index][i] = 0;
+    postFileRequest(FILE_REQUEST_OPEN);
     return;
 }
 
 //-------------------------------------------------------------------------
-void closefile_task()
+void closeFileTask()
+{
+    postFileRequest(FILE_REQUEST_CLOSE);
+}
+
+//-------------------------------------------------------------------------
+void readFileTask()
 {
-    fclose2(filehandle);
-	barrier_unblock(7, 2);
+    postFileRequest(FILE_REQUEST_READ);
 }
 
 //-------------------------------------------------------------------------
-void closeFileTask()
+void writeFileTask()
 {
-    filehandle = (MYFILE *) current_thread->filedata.filestate.fileptr;
-    postTask(closefile_task, 5);
+    postFileRequest(FILE_REQUEST_WRITE);
 }
 
 //-------------------------------------------------------------------------
-void readfile_task()
+void readRecordFileTask()
 {
-    fread2(filehandle, databuffer, nBytes);
-	barrier_unblock(7, 3);
+    postFileRequest(FILE_REQUEST_READRECORD);
 }
 
 //-------------------------------------------------------------------------
-void readFileTask()
+void mapFileTask()
 {
-    filehandle = (MYFILE *) current_thread->filedata.filestate.fileptr;
-    databuffer = current_thread->filedata.filestate.bufferptr;
-    nBytes = current_thread->filedata.filestate.bytes;
-    postTask(readfile_task, 5);
+    postFileRequest(FILE_REQUEST_MAP);
 }
 
 //-------------------------------------------------------------------------
-void writefile_task()
+void verifyFileTask()
 {
-    fwrite2(filehandle, databuffer, nBytes);
-	barrier_unblock(7, 4);
-     
+    postFileRequest(FILE_REQUEST_VERIFY);
 }
 
 //-------------------------------------------------------------------------
-void writeFileTask()
+void createRingFileTask()
 {
-    filehandle = (MYFILE *) current_thread->filedata.filestate.fileptr;
-    databuffer = current_thread->filedata.filestate.bufferptr;
-    nBytes = current_thread->filedata.filestate.bytes;
-    postTask(writefile_task, 5);
+    copyFilePath(current_thread - thread_table);
+    postFileRequest(FILE_REQUEST_CREATERING);
+}
+
+//-------------------------------------------------------------------------
+//Served in the calling thread instead of being queued, as a mapped read never waits on the flash
+void readMappedFileTask()
+{
+    _atomic_t currentatomic;
+
+    //no task may touch the flash in the middle of the read
+    currentatomic = _atomic_start();
+    current_thread->filedata.filestate.bytes =
+        (uint16_t) fmapread((MYFILE *) current_thread->filedata.filestate.
+                            fileptr, current_thread->filedata.filestate.bufferptr,
+                            current_thread->filedata.filestate.bytes);
+    _atomic_end(currentatomic);
+}
+
+//-------------------------------------------------------------------------
+void unmapFileTask()
+{
+    _atomic_t currentatomic;
+
+    currentatomic = _atomic_start();
+    funmap((MYFILE *) current_thread->filedata.filestate.fileptr);
+    _atomic_end(currentatomic);
 }
 
 //-------------------------------------------------------------------------
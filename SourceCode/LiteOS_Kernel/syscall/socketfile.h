@@ -1,6 +1,8 @@
 /** @file socketfile.h
 	@brief The functional prototypes for socket file.
 
+	File requests from user threads are queued per thread and served by a kernel task. The task never waits for a page program to finish: it polls the flash with a timer, so that radio and other tasks keep running, and only the requesting thread stays blocked on its barrier.
+
 	@author Qing Cao (cao@utk.edu)
 */
 
@@ -30,6 +32,14 @@ complicated support such as copy will be added in the future versions if found n
 /** @addtogroup socket */
 /** @{ */
 
+/** @brief The generic timer used to poll the flash while a page is being programmed. */
+#define FILE_REQUEST_TIMER 8
+
+/** @brief The polling interval in milliseconds. A page program takes up to 20 ms. */
+#ifndef FILE_REQUEST_POLL_INTERVAL
+#define FILE_REQUEST_POLL_INTERVAL 2
+#endif
+
 /** @brief Open the file task.
 	@return Void. 
 */
@@ -50,6 +60,41 @@ void readFileTask();
 */
 void writeFileTask();
 
+/** @brief Read the next record of a log file task.
+	@return Void.
+*/
+void readRecordFileTask();
+
+/** @brief Map the flash page at the position of a file task. The number of bytes left in the page goes back through the byte count.
+	@return Void.
+*/
+void mapFileTask();
+
+/** @brief Read from the mapped page of a file task. It is served at once, and the byte count becomes 0 on success or 0xffff if the page has to be mapped again.
+	@return Void.
+*/
+void readMappedFileTask();
+
+/** @brief End the mapping of a file task.
+	@return Void.
+*/
+void unmapFileTask();
+
+/** @brief Check the pages of a file against their CRCs task. The number of corrupted pages goes back through the byte count.
+	@return Void.
+*/
+void verifyFileTask();
+
+/** @brief Create a ring file task. The path comes from the shared path buffer and the buffer pointer points at the capacity, and the byte count becomes 0 on success or 0xffff on failure.
+	@return Void.
+*/
+void createRingFileTask();
+
+/** @brief Resume serving file requests once the flash may be idle again.
+	@return Void.
+*/
+void fileRequestTimerFired();
+
 /** @brief Seek the file task.
 	@return Void.
 */
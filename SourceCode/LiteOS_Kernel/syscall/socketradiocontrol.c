@@ -10,6 +10,10 @@
 #include "../kernel/threadkernel.h"
 #include "../io/radio/amradio.h"
 
+#if defined(PLATFORM_AVR) && defined(RADIO_CC2420)
+#include "../io/cc2420/cc2420lplm.h"
+#endif
+
 
  
 radio_receiving_buffer radio_buf;
@@ -89,3 +93,67 @@ void registerReceiverHandle_syscall()
                   radio_buf.data, radio_buf.packetinfo,
                   radio_buf.handlefunc);
 }
+
+//system call interface for removing the handle in the receiving buffer from its port
+void deRegisterReceiverHandle_syscall()
+{
+    deRegisterEvent(radio_buf.port, radio_buf.dataReady);
+}
+
+//-------------------------------------------------------------------------
+void takeReceivedPacketTask()
+{
+    Radio_MsgPtr packet;
+
+    packet = takeReceivedPacket(radio_buf.port, radio_buf.dataReady);
+    asm volatile ("mov r20, %A0" "\n\t" "mov r21, %B0" "\n\t"::"r" (packet));
+}
+
+//-------------------------------------------------------------------------
+void releaseReceivedPacketTask()
+{
+    Radio_MsgPtr volatile packet;
+
+    asm volatile ("mov  %A0, r20" "\n\t" "mov  %B0, r21" "\n\t":"=r" (packet):);
+    releaseReceivedPacket(packet);
+}
+
+//-------------------------------------------------------------------------
+void *getRadioReceiveStatsAddr()
+{
+    return (void *)getRadioReceiveStats();
+}
+
+//-------------------------------------------------------------------------
+void setRadioLplIntervalTask()
+{
+    volatile uint16_t interval;
+    asm volatile ("mov  %A0, r20" "\n\t" "mov  %B0, r21" "\n\t":"=r" (interval):);
+    
+	#if defined(PLATFORM_AVR) && defined(RADIO_CC2420)
+    cc2420lplm_setInterval(interval);
+	#endif
+	
+    return;
+}
+
+//-------------------------------------------------------------------------
+void *getRadioLplStatsAddr()
+{
+	#if defined(PLATFORM_AVR) && defined(RADIO_CC2420)
+    return (void *)cc2420lplm_getStats();
+	#else
+    return NULL;
+	#endif
+}
+
+//-------------------------------------------------------------------------
+void getRadioPortStatsTask()
+{
+    volatile uint16_t port;
+    void *addr;
+
+    asm volatile ("mov  %A0, r20" "\n\t" "mov  %B0, r21" "\n\t":"=r" (port):);
+    addr = (void *)getRadioPortStats(port);
+    asm volatile ("mov r20, %A0" "\n\t" "mov r21, %B0" "\n\t"::"r" (addr));
+}
@@ -80,4 +80,53 @@ void *getRadioReceivingBufferAddr();
 
 void registerReceiverHandle_syscall();
 
+/** @ingroup socket
+	@brief Remove the handle with the port and dataReady of the receiving buffer, and the packets queued for it. 
+	@return Void.
+*/
+
+void deRegisterReceiverHandle_syscall();
+
+/** @ingroup socket
+	@brief Take the oldest packet queued for the handle in the receiving buffer, and return it in r20 and r21.
+	@return Void.
+*/
+
+void takeReceivedPacketTask();
+
+/** @ingroup socket
+	@brief Give the packet in r20 and r21 back to the receive buffer pool.
+	@return Void.
+*/
+
+void releaseReceivedPacketTask();
+
+/** @ingroup socket
+	@brief Get the address of the receive statistics. 
+	@return Void pointer. 
+*/
+
+void *getRadioReceiveStatsAddr();
+
+/** @ingroup socket
+	@brief Return the address of the counters of the port in r20 and r21 in the same registers, or 0.
+	@return Void.
+*/
+
+void getRadioPortStatsTask();
+
+/** @ingroup socket
+	@brief Set the low-power listening check interval in milliseconds, stored in r20 and r21. 0 keeps the receiver on.
+	@return Void.
+*/
+
+void setRadioLplIntervalTask();
+
+/** @ingroup socket
+	@brief Get the address of the low-power listening counters. 
+	@return Void pointer, NULL if the radio has no low-power listening. 
+*/
+
+void *getRadioLplStatsAddr();
+
 #endif
@@ -20,9 +20,13 @@
 
 //defined as global variables so that these variables are visible to the rest components 
 //These are for external usage, like system calls 
-//for radio used by user threads
+//for radio used by user threads, delivered locally without being queued
 Radio_Msg currentMsg;
 
+//the messages of thread sends to other nodes, one per slot of the send queue, each owned by the radio until its send completes
+Radio_Msg socketMsgs[AM_TX_QUEUE_SIZE];
+volatile uint8_t socketMsgBusy[AM_TX_QUEUE_SIZE];
+
 //In this part, socket_port, socket_addr specifies the next hop node information 
 //msg_len specifices the message length to be broadcast over the air
 //msg is the content of the data message to be broadcast 
@@ -31,38 +35,63 @@ Radio_Msg currentMsg;
 /** \ingroup radio */
 radiosockettype radiosocketdata;
 
+//-------------------------------------------------------------------------
+//the radio is done with a message, which can take the next send
+void socketSendDone(Radio_MsgPtr msg, result_t success)
+{
+    socketMsgBusy[msg - socketMsgs] = 0;
+}
+
 //-------------------------------------------------------------------------
 //If the destination is another node, send the packet through radio. 
-//If the destination is the current node, then send the packet locally by calling Standard_Receive_Packet 
+//If the destination is the current node, then send the packet locally by calling Standard_Receive_LocalPacket 
 
 void send_task()
 {
     struct msgData *dataPayloadPtr_currentMsg;
+    uint8_t i;
 
   
 	 
-    dataPayloadPtr_currentMsg = (struct msgData *)currentMsg.data;
     if (radiosocketdata.socket_msg_len == 0)
     {
         radiosocketdata.socket_msg_len = mystrlen((char *)radiosocketdata.socket_msg);
     }
-    mystrncpy((char *)dataPayloadPtr_currentMsg, (char *)radiosocketdata.socket_msg,
-              radiosocketdata.socket_msg_len);
-
 
   
     if (radiosocketdata.socket_addr != 0)
     {
-        AMStandard_SendMsg_send(radiosocketdata.socket_port, radiosocketdata.socket_addr, radiosocketdata.socket_msg_len, &currentMsg);
+        //a message still queued keeps its payload, so the send takes a free one, and is dropped if every one is queued
+        for (i = 0; i < AM_TX_QUEUE_SIZE; i++)
+        {
+            if (socketMsgBusy[i] == 0)
+            {
+                break;
+            }
+        }
+        if (i == AM_TX_QUEUE_SIZE)
+        {
+            return;
+        }
+        socketMsgBusy[i] = 1;
+        mystrncpy((char *)socketMsgs[i].data, (char *)radiosocketdata.socket_msg,
+                  radiosocketdata.socket_msg_len);
+        if (AMStandard_SendMsg_sendWithDone(radiosocketdata.socket_port, radiosocketdata.socket_addr, radiosocketdata.socket_msg_len, &socketMsgs[i], socketSendDone) == FAIL)
+        {
+            socketMsgBusy[i] = 0;
+        }
     }
     else
     {
+        dataPayloadPtr_currentMsg = (struct msgData *)currentMsg.data;
+        mystrncpy((char *)dataPayloadPtr_currentMsg, (char *)radiosocketdata.socket_msg,
+                  radiosocketdata.socket_msg_len);
         currentMsg.length = radiosocketdata.socket_msg_len;
         currentMsg.addr = radiosocketdata.socket_addr;
         currentMsg.port = radiosocketdata.socket_port;
         currentMsg.strength = 0;
         currentMsg.lqi = 0; 
-        Standard_Receive_Packet(radiosocketdata.socket_port, &currentMsg);
+        Standard_Receive_LocalPacket(radiosocketdata.socket_port, &currentMsg);
     }
 //#endif
 }
@@ -20,7 +20,7 @@ LiteOS provides simple radio initilization, by calling the SocketInit() function
 \par Send Operations
 To send a packet, use the StandardSocketSend() function. To invoke it, it must be served with port number and next hop address. If the parameter 
 msglength is set as 0, then the msg will be read to find the exact number of bytes, ending with 0. If the address parameter is set as 0, then this packet is assumed 
-to be local, and will be directly sent to the Standard_Receive_Packet() function for processing. 
+to be local, and will be directly sent to the Standard_Receive_LocalPacket() function for processing. 
 While the kernel may directly invoke StandardSocketSend(), for the user application, it must use a different function, SocketRadioSend(). To invoke this, however, it
 must first use getRadioInfo() to get the internal RadioInfoType data structure address, then populate this piece of memory, then call SocketRadioSend(). It is suggested that, 
 after each send operation, the function disableSocketRadioState() should be called (this function is already called in StandardSocketSend()). 
@@ -28,6 +28,8 @@ after each send operation, the function disableSocketRadioState() should be call
 The LiteOS radio module implements a registering based receive structure. The following functions are provided to achieve this goal. To receive a packet, the function
 initRadioHandle() must first be called to initilize the radio handle for receiving. Then, the registerEvent() function is called to reigster. The application may also call
 deRegisterEvent() to stop registering for a particular packet. 
+A handle registered without a data buffer does not copy packets. They are queued in a pool of receive buffers instead, taken with takeReceivedPacket() and 
+given back with releaseReceivedPacket(). 
 If the user application runs outside the kernel, then the function getHandleInfo() is provided to return the internal address of the receive function handle. Furthermore, 
 the function registerReceiverHandle_syscall() is provided to register the handle for user side applications. 
 \note the function Standard_Receive_Packet is not intended to be used by user. It is called by the radio stack to initiate a packet scheduling procedure to deliver packet to 
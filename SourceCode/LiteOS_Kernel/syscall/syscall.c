@@ -889,6 +889,262 @@ void releaseCurrentRadioLock()
 }
 
 
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void takeRadioPacket_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_TAKERADIOPACKET, currentindex);
+    takeReceivedPacketTask();
+}
+#endif 
+
+/**\ingroup syscall
+Take the oldest packet queued for the handle in the receiving buffer. 
+*/
+ 
+
+void takeRadioPacket() __attribute__ ((section(".systemcall.5")))
+    __attribute__ ((naked));
+void takeRadioPacket()
+
+{
+#ifdef TRACE_ENABLE
+    takeRadioPacket_Logger();
+#else
+    takeReceivedPacketTask();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
+
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void releaseRadioPacket_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_RELEASERADIOPACKET, currentindex);
+    releaseReceivedPacketTask();
+}
+#endif 
+
+/**\ingroup syscall
+Give the packet in the registers back to the receive buffer pool. 
+*/
+ 
+
+void releaseRadioPacket() __attribute__ ((section(".systemcall.5")))
+    __attribute__ ((naked));
+void releaseRadioPacket()
+
+{
+#ifdef TRACE_ENABLE
+    releaseRadioPacket_Logger();
+#else
+    releaseReceivedPacketTask();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
+
+//-------------------------------------------------------------------------
+void getRadioReceiveStats_avr()
+{
+    void *addr;
+
+    addr = getRadioReceiveStatsAddr();
+    asm volatile ("mov r20, %A0" "\n\t" "mov r21, %B0" "\n\t"::"r" (addr));
+}
+
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void getRadioReceiveStats_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_GETRADIORECEIVESTATS, currentindex);
+    getRadioReceiveStats_avr();
+}
+#endif 
+
+/**\ingroup syscall
+Get the address of the statistics of the packets delivered by pointer. 
+*/
+ 
+
+void getRadioReceiveStatsAddress() __attribute__ ((section(".systemcall.5")))
+    __attribute__ ((naked));
+void getRadioReceiveStatsAddress()
+
+{
+#ifdef TRACE_ENABLE
+    getRadioReceiveStats_Logger();
+#else
+    getRadioReceiveStats_avr();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
+
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void getRadioPortStats_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_GETRADIOPORTSTATS, currentindex);
+    getRadioPortStatsTask();
+}
+#endif 
+
+/**\ingroup syscall
+Get the address of the counters of the port in the registers. 
+*/
+ 
+
+void getRadioPortStatsAddress() __attribute__ ((section(".systemcall.5")))
+    __attribute__ ((naked));
+void getRadioPortStatsAddress()
+
+{
+#ifdef TRACE_ENABLE
+    getRadioPortStats_Logger();
+#else
+    getRadioPortStatsTask();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
+
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void setRadioLplIntervalTask_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_SETRADIOLPLINTERVAL, currentindex);
+    setRadioLplIntervalTask();
+}
+#endif 
+
+/**\ingroup syscall 
+Set the low-power listening check interval, stored in the registers. 
+*/
+ 
+
+void setRadioLplInterval() __attribute__ ((section(".systemcall.5")))
+    __attribute__ ((naked));
+void setRadioLplInterval()
+
+{
+#ifdef TRACE_ENABLE
+    setRadioLplIntervalTask_Logger();
+#else
+    setRadioLplIntervalTask();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
+
+//-------------------------------------------------------------------------
+void getRadioLplStats_avr()
+{
+    void *addr;
+
+    addr = getRadioLplStatsAddr();
+    asm volatile ("mov r20, %A0" "\n\t" "mov r21, %B0" "\n\t"::"r" (addr));
+}
+
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void getRadioLplStats_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_GETRADIOLPLSTATS, currentindex);
+    getRadioLplStats_avr();
+}
+#endif 
+
+/**\ingroup syscall
+Get the address of the low-power listening counters. 
+*/
+ 
+
+void getRadioLplStatsAddress() __attribute__ ((section(".systemcall.5")))
+    __attribute__ ((naked));
+void getRadioLplStatsAddress()
+
+{
+#ifdef TRACE_ENABLE
+    getRadioLplStats_Logger();
+#else
+    getRadioLplStats_avr();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
+
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void deRegisterReceiverHandle_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_DEREGISTERRECEIVERHANDLE, currentindex);
+    deRegisterReceiverHandle_syscall();
+}
+#endif 
+
+/**\ingroup syscall
+Remove the handle in the receiving buffer from its port. 
+*/
+ 
+
+void deRegisterReceiverHandle() __attribute__ ((section(".systemcall.5")))
+    __attribute__ ((naked));
+void deRegisterReceiverHandle()
+
+{
+#ifdef TRACE_ENABLE
+    deRegisterReceiverHandle_Logger();
+#else
+    deRegisterReceiverHandle_syscall();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
+
 
 //-----------------------------------------------------------------------------
 //Boundary EC80 Device: LED Operations
@@ -1546,6 +1802,78 @@ void writeToEEPROM()
     asm volatile ("ret"::);
 }
 
+//-------------------------------------------------------------------------
+void readKeyEEPROMTask()
+{
+    genericReadKeyTask();
+}
+
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void readKeyEEPROMTask_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_READKEYFROMEEPROM, currentindex);
+    readKeyEEPROMTask();
+}
+#endif 
+
+/**\ingroup syscall 
+Read the value of a key from the key-value store in EEPROM. 
+*/
+void readKeyFromEEPROM() __attribute__ ((section(".systemcall.8")))
+    __attribute__ ((naked));
+void readKeyFromEEPROM()
+{
+#ifdef TRACE_ENABLE
+    readKeyEEPROMTask_Logger();
+#else
+    readKeyEEPROMTask();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
+//-------------------------------------------------------------------------
+void writeKeyEEPROMTask()
+{
+    genericWriteKeyTask();
+}
+
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void writeKeyEEPROMTask_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_WRITEKEYTOEEPROM, currentindex);
+    writeKeyEEPROMTask();
+}
+#endif 
+
+/**\ingroup syscall 
+Write the value of a key to the key-value store in EEPROM. 
+*/
+void writeKeyToEEPROM() __attribute__ ((section(".systemcall.8")))
+    __attribute__ ((naked));
+void writeKeyToEEPROM()
+{
+#ifdef TRACE_ENABLE
+    writeKeyEEPROMTask_Logger();
+#else
+    writeKeyEEPROMTask();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
 
 
 
@@ -1792,6 +2120,186 @@ void seekFileSysCall()
     asm volatile ("ret"::);
 }
 
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void readRecordFileTask_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_READRECORDFILESYSCALL, currentindex);
+    readRecordFileTask();
+}
+#endif 
+
+/**\ingroup syscall 
+Read the next record from a file opened in log mode. 
+*/
+void readRecordFileSysCall() __attribute__ ((section(".systemcall.9")))
+    __attribute__ ((naked));
+void readRecordFileSysCall()
+{
+#ifdef TRACE_ENABLE
+    readRecordFileTask_Logger();
+#else
+    readRecordFileTask();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void mapFileTask_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_MAPFILESYSCALL, currentindex);
+    mapFileTask();
+}
+#endif 
+
+/**\ingroup syscall 
+Map the flash page at the position of a file. 
+*/
+void mapFileSysCall() __attribute__ ((section(".systemcall.9")))
+    __attribute__ ((naked));
+void mapFileSysCall()
+{
+#ifdef TRACE_ENABLE
+    mapFileTask_Logger();
+#else
+    mapFileTask();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void readMappedFileTask_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_READMAPPEDFILESYSCALL, currentindex);
+    readMappedFileTask();
+}
+#endif 
+
+/**\ingroup syscall 
+Read from the mapped page of a file. 
+*/
+void readMappedFileSysCall() __attribute__ ((section(".systemcall.9")))
+    __attribute__ ((naked));
+void readMappedFileSysCall()
+{
+#ifdef TRACE_ENABLE
+    readMappedFileTask_Logger();
+#else
+    readMappedFileTask();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void unmapFileTask_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_UNMAPFILESYSCALL, currentindex);
+    unmapFileTask();
+}
+#endif 
+
+/**\ingroup syscall 
+End the mapping of a file. 
+*/
+void unmapFileSysCall() __attribute__ ((section(".systemcall.9")))
+    __attribute__ ((naked));
+void unmapFileSysCall()
+{
+#ifdef TRACE_ENABLE
+    unmapFileTask_Logger();
+#else
+    unmapFileTask();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void verifyFileTask_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_VERIFYFILESYSCALL, currentindex);
+    verifyFileTask();
+}
+#endif 
+
+/**\ingroup syscall 
+Check the pages of a file against their CRCs. 
+*/
+void verifyFileSysCall() __attribute__ ((section(".systemcall.9")))
+    __attribute__ ((naked));
+void verifyFileSysCall()
+{
+#ifdef TRACE_ENABLE
+    verifyFileTask_Logger();
+#else
+    verifyFileTask();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
+//-------------------------------------------------------------------------
+#ifdef TRACE_ENABLE
+void createRingFileTask_Logger()
+{
+    uint8_t currentindex;
+    _atomic_t _atomic = _atomic_start();
+
+    currentindex = getThreadIndexAddress();
+    _atomic_end(_atomic);
+    addTrace(TRACE_SYSCALL_CREATERINGFILESYSCALL, currentindex);
+    createRingFileTask();
+}
+#endif 
+
+/**\ingroup syscall 
+Create a ring file that takes all its sectors up front. 
+*/
+void createRingFileSysCall() __attribute__ ((section(".systemcall.9")))
+    __attribute__ ((naked));
+void createRingFileSysCall()
+{
+#ifdef TRACE_ENABLE
+    createRingFileTask_Logger();
+#else
+    createRingFileTask();
+#endif
+    asm volatile ("nop"::);
+    asm volatile ("ret"::);
+}
+
 
 //Defintition group 10
 
@@ -19,8 +19,11 @@
 #include "../io/radio/amcommon.h"
 #include "../io/radio/amradio.h"
 #include "../io/cc2420/cc2420controlm.h"
+#include "../io/cc2420/cc2420lplm.h"
 
 #include "../kernel/threadmodel.h"
+#include "../syscall/socketfile.h"
+#include "../storage/filesys/wearlevel.h"
 
 
 #ifdef PLATFORM_CPU_MEASURE 
@@ -141,6 +144,9 @@ inline result_t GenericTimerFired(uint8_t id)
     case 7:
         ServiceTimerFired(7);
         break;
+    case FILE_REQUEST_TIMER:
+        fileRequestTimerFired();
+        break;
     case 9:
 
 #ifdef PLATFORM_CPU_MEASURE
@@ -162,6 +168,9 @@ inline result_t GenericTimerFired(uint8_t id)
     case 11:
         hplcc2420interruptm_CCATimer_fired();
         break;
+    case CC2420_LPL_TIMER:
+        cc2420lplm_timerFired();
+        break;
 #endif
    case 12:
         #ifdef ENERGY_SHARE_SCHEDULING
@@ -193,7 +202,8 @@ inline result_t GenericTimerFired(uint8_t id)
 	    
 		break; 
 		
-	case 15:
+	case WEAR_LEVEL_TIMER:
+	    postTask(wearLevelTask, 2);
 	
 		
 		break; 	
@@ -0,0 +1,75 @@
+/** @file crc.c
+	@brief The detailed implementation of the shared CRC-16 routines.
+*/
+
+#include "crc.h"
+
+#ifdef PLATFORM_AVR
+#include <avr/pgmspace.h>
+#define CRC_TABLE(name) static const uint16_t name[16] PROGMEM
+#define CRC_LOOKUP(table, index) pgm_read_word(&table[index])
+#else
+#define CRC_TABLE(name) static const uint16_t name[16]
+#define CRC_LOOKUP(table, index) (table[index])
+#endif
+
+//the CRC of each nibble value, least significant bit first
+CRC_TABLE(crcccitttable) =
+{
+    0x0000, 0x1081, 0x2102, 0x3183, 0x4204, 0x5285, 0x6306, 0x7387,
+    0x8408, 0x9489, 0xa50a, 0xb58b, 0xc60c, 0xd68d, 0xe70e, 0xf78f
+};
+
+//the CRC of each nibble value in the top four bits, most significant bit first
+CRC_TABLE(crcxmodemtable) =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef
+};
+
+//-------------------------------------------------------------------------
+uint16_t crcCcittUpdate(uint16_t crc, uint8_t data)
+{
+    crc ^= data;
+    crc = (crc >> 4) ^ CRC_LOOKUP(crcccitttable, crc & 0x0f);
+    crc = (crc >> 4) ^ CRC_LOOKUP(crcccitttable, crc & 0x0f);
+    return crc;
+}
+
+//-------------------------------------------------------------------------
+uint16_t crcCcittBlock(uint16_t crc, const void *data, uint16_t length)
+{
+    const uint8_t *p;
+
+    p = (const uint8_t *)data;
+    while (length > 0)
+    {
+        crc = crcCcittUpdate(crc, *p++);
+        length--;
+    }
+    return crc;
+}
+
+//-------------------------------------------------------------------------
+uint16_t crcXmodemUpdate(uint16_t crc, uint8_t data)
+{
+    crc = (crc << 4) ^ CRC_LOOKUP(crcxmodemtable,
+                                  ((crc >> 12) ^ (data >> 4)) & 0x0f);
+    crc = (crc << 4) ^ CRC_LOOKUP(crcxmodemtable,
+                                  ((crc >> 12) ^ data) & 0x0f);
+    return crc;
+}
+
+//-------------------------------------------------------------------------
+uint16_t crcXmodemBlock(uint16_t crc, const void *data, uint16_t length)
+{
+    const uint8_t *p;
+
+    p = (const uint8_t *)data;
+    while (length > 0)
+    {
+        crc = crcXmodemUpdate(crc, *p++);
+        length--;
+    }
+    return crc;
+}
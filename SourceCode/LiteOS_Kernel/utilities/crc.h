@@ -0,0 +1,59 @@
+/** @file crc.h
+	@brief The functional prototypes of the shared CRC-16 routines.
+
+	Both CCITT polynomial bit orders used in the kernel are computed with 16-entry tables, one lookup per nibble.
+	The tables take 64 bytes of program memory, a quarter of what a byte-wide table would take for one of them.
+*/
+
+#ifndef CRCH
+#define CRCH
+#include "../types/types.h"
+
+/**\defgroup crc CRC-16 routines.*/
+
+/** \ingroup crc
+	@brief The usual initial value of a CRC.
+*/
+#define CRC_INIT 0xffff
+
+/** \ingroup crc
+	@brief The initial value for crcXmodemUpdate() that gives the CRC the flash driver has always computed, which shifted 16 zero bits through the CRC after the data.
+*/
+#define CRC_AUGMENTED_INIT 0x1d0f
+
+/** \ingroup crc
+	@brief Add a byte to a CCITT CRC computed least significant bit first (polynomial 0x8408).
+	This is the CRC of IEEE 802.15.4 frames and gives the same results as _crc_ccitt_update() of avr-libc.
+	@param crc The CRC so far.
+	@param data The byte.
+	@return The updated CRC.
+*/
+uint16_t crcCcittUpdate(uint16_t crc, uint8_t data);
+
+/** \ingroup crc
+	@brief Add a block of bytes to a CCITT CRC computed least significant bit first.
+	@param crc The CRC so far.
+	@param data The bytes.
+	@param length The number of bytes.
+	@return The updated CRC.
+*/
+uint16_t crcCcittBlock(uint16_t crc, const void *data, uint16_t length);
+
+/** \ingroup crc
+	@brief Add a byte to a CCITT CRC computed most significant bit first (polynomial 0x1021).
+	This gives the same results as _crc_xmodem_update() of avr-libc.
+	@param crc The CRC so far.
+	@param data The byte.
+	@return The updated CRC.
+*/
+uint16_t crcXmodemUpdate(uint16_t crc, uint8_t data);
+
+/** \ingroup crc
+	@brief Add a block of bytes to a CCITT CRC computed most significant bit first.
+	@param crc The CRC so far.
+	@param data The bytes.
+	@param length The number of bytes.
+	@return The updated CRC.
+*/
+uint16_t crcXmodemBlock(uint16_t crc, const void *data, uint16_t length);
+#endif
@@ -86,6 +86,13 @@
 #define TRACE_SYSCALL_GETRADIOLOCK											508
 #define TRACE_SYSCALL_SETRADIOLOCK											509
 #define TRACE_SYSCALL_RELEASERADIOLOCK										510
+#define TRACE_SYSCALL_TAKERADIOPACKET										511
+#define TRACE_SYSCALL_RELEASERADIOPACKET									512
+#define TRACE_SYSCALL_GETRADIORECEIVESTATS									513
+#define TRACE_SYSCALL_GETRADIOPORTSTATS										514
+#define TRACE_SYSCALL_SETRADIOLPLINTERVAL									515
+#define TRACE_SYSCALL_GETRADIOLPLSTATS										516
+#define TRACE_SYSCALL_DEREGISTERRECEIVERHANDLE								517
  
 
 
@@ -112,6 +119,8 @@
 #define TRACE_SYSCALL_GETCURRENTEEPROMHANDLEADDRESS   			            709
 #define TRACE_SYSCALL_READFROMEEPROM   										710
 #define TRACE_SYSCALL_WRITETOEEPROM    										711
+#define TRACE_SYSCALL_READKEYFROMEEPROM   									712
+#define TRACE_SYSCALL_WRITEKEYTOEEPROM    									713
 
 #define TRACE_SYSCALL_GETFILEPATHADDR        								801
 #define TRACE_SYSCALL_GETFILEMODEADDR        								802
@@ -120,6 +129,12 @@
 #define TRACE_SYSCALL_READFILESYSCALL        								805
 #define TRACE_SYSCALL_WRITEFILESYSCALL       								806
 #define TRACE_SYSCALL_SEEKFILESYSCALL      								    807
+#define TRACE_SYSCALL_READRECORDFILESYSCALL  								808
+#define TRACE_SYSCALL_MAPFILESYSCALL         								809
+#define TRACE_SYSCALL_READMAPPEDFILESYSCALL  								810
+#define TRACE_SYSCALL_UNMAPFILESYSCALL       								811
+#define TRACE_SYSCALL_VERIFYFILESYSCALL      								812
+#define TRACE_SYSCALL_CREATERINGFILESYSCALL  								813
 
 #define TRACE_SYSCALL_GETCPUCOUNTSYSCALL                                    901
 
@@ -0,0 +1,121 @@
+/** @file crctest.c
+	@brief Check the table-driven CRC routines of the kernel against the published check values of the CRC-16 variants
+	they implement, and against the bitwise CRCs this tool uses on images.
+
+	The check value of a CRC variant is its CRC of the nine ASCII bytes "123456789".
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../SourceCode/LiteOS_Kernel/utilities/crc.h"
+
+static int failures;
+
+//-------------------------------------------------------------------------
+static void expect(const char *name, uint16_t got, uint16_t want)
+{
+    if (got != want)
+    {
+        printf("FAIL %s: 0x%04x, expected 0x%04x\n", name, got, want);
+        failures++;
+    }
+    else
+    {
+        printf("ok   %s: 0x%04x\n", name, got);
+    }
+}
+
+//-------------------------------------------------------------------------
+//bitwise references, the same loops as crcCcitt() and crcXmodem() in fsimage.c
+static uint16_t bitCcitt(uint16_t crc, const uint8_t * data, long length)
+{
+    int i;
+
+    while (length-- > 0)
+    {
+        crc ^= *data++;
+        for (i = 0; i < 8; i++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+//-------------------------------------------------------------------------
+static uint16_t bitXmodem(uint16_t crc, const uint8_t * data, long length)
+{
+    int i;
+
+    while (length-- > 0)
+    {
+        crc ^= (uint16_t) (*data++ << 8);
+        for (i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) :
+                (uint16_t) (crc << 1);
+        }
+    }
+    return crc;
+}
+
+//-------------------------------------------------------------------------
+int main()
+{
+    static const uint8_t check[] = "123456789";
+    uint8_t page[256];
+    uint16_t crc;
+    int i, trial, mismatches;
+
+    //most significant bit first: XMODEM, CCITT-FALSE and AUG-CCITT, the last being what the flash driver stamps
+    expect("CRC-16/XMODEM", crcXmodemBlock(0x0000, check, 9), 0x31c3);
+    expect("CRC-16/CCITT-FALSE", crcXmodemBlock(CRC_INIT, check, 9), 0x29b1);
+    expect("CRC-16/AUG-CCITT", crcXmodemBlock(CRC_AUGMENTED_INIT, check, 9),
+           0xe5cc);
+    //least significant bit first: KERMIT, MCRF4XX as the log records use it, and X-25, which inverts the result
+    expect("CRC-16/KERMIT", crcCcittBlock(0x0000, check, 9), 0x2189);
+    expect("CRC-16/MCRF4XX", crcCcittBlock(CRC_INIT, check, 9), 0x6f91);
+    expect("CRC-16/X-25", (uint16_t) ~crcCcittBlock(CRC_INIT, check, 9),
+           0x906e);
+    //the byte routines give what the block routines give
+    crc = CRC_INIT;
+    for (i = 0; i < 9; i++)
+    {
+        crc = crcXmodemUpdate(crc, check[i]);
+    }
+    expect("crcXmodemUpdate", crc, 0x29b1);
+    crc = CRC_INIT;
+    for (i = 0; i < 9; i++)
+    {
+        crc = crcCcittUpdate(crc, check[i]);
+    }
+    expect("crcCcittUpdate", crc, 0x6f91);
+    //the tables agree with the bit loops of this tool on whole pages of random data
+    srand(1);
+    mismatches = 0;
+    for (trial = 0; trial < 1000; trial++)
+    {
+        for (i = 0; i < 256; i++)
+        {
+            page[i] = (uint8_t) rand();
+        }
+        if ((crcXmodemBlock(CRC_INIT, page, 256) !=
+             bitXmodem(CRC_INIT, page, 256))
+            || (crcCcittBlock(CRC_INIT, page, 256) !=
+                bitCcitt(CRC_INIT, page, 256)))
+        {
+            mismatches++;
+        }
+    }
+    expect("random pages differing from the bit loops", (uint16_t) mismatches,
+           0);
+    if (failures > 0)
+    {
+        printf("%d failed\n", failures);
+        return 1;
+    }
+    printf("all passed\n");
+    return 0;
+}
@@ -0,0 +1,1516 @@
+/** @file fsimage.c
+	@brief A host tool to build, inspect and check LiteOS file system images.
+
+	An image is a pair of files: the 4KB EEPROM of a node, which holds the inodes, the allocation bitmaps and the
+	metadata journal, and the 2048 pages of the AT45DB041 data flash at 264 bytes each, which hold the file contents.
+	Images are read whole into memory, so every command runs in a few linear passes over the inodes and sectors.
+
+	Commands that read an image first replay the committed journal transaction, the way mountSystem() does, and
+	commands that change an image write it back with the journal empty, so that the node rebuilds its bitmaps from
+	the inodes when it mounts the image.
+
+	A ring file, which fcreatering() makes on a node, can be made ahead of time with the ring command; it only
+	touches the EEPROM, since a new ring owns its sectors but has not written any of their pages.
+*/
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "fslayout.h"
+
+static uint8_t eeprom[EEPROM_SIZE];
+static uint8_t *flash;
+
+//the state the journal was left in, as mountSystem() sees it
+enum
+{
+    JOURNAL_EMPTY,
+    JOURNAL_PARTIAL,
+    JOURNAL_COMPLETE
+};
+
+static int journalstate;
+static int errors;
+static int warnings;
+
+//what the check found each sector and inode to be used by
+static uint8_t sectorowner[FLASH_SECTOR_NUM + 1];
+static uint8_t sectorusers[FLASH_SECTOR_NUM + 1];
+static uint8_t nodeseen[INODENUM + 1];
+
+//-------------------------------------------------------------------------
+static void problem(int severe, const char *format, ...)
+{
+    va_list args;
+
+    if (severe)
+    {
+        errors++;
+        fprintf(stdout, "error: ");
+    }
+    else
+    {
+        warnings++;
+        fprintf(stdout, "warning: ");
+    }
+    va_start(args, format);
+    vfprintf(stdout, format, args);
+    va_end(args);
+    fprintf(stdout, "\n");
+}
+
+//-------------------------------------------------------------------------
+static void fatal(const char *format, ...)
+{
+    va_list args;
+
+    fprintf(stderr, "fsimage: ");
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    exit(2);
+}
+
+//-------------------------------------------------------------------------
+//CRC-CCITT least significant bit first, as crcCcittUpdate() in utilities/crc.c
+static uint16_t crcCcitt(uint16_t crc, const uint8_t * data, long length)
+{
+    int i;
+
+    while (length-- > 0)
+    {
+        crc ^= *data++;
+        for (i = 0; i < 8; i++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+//-------------------------------------------------------------------------
+//CRC-CCITT most significant bit first, as crcXmodemUpdate() in utilities/crc.c
+static uint16_t crcXmodem(uint16_t crc, const uint8_t * data, long length)
+{
+    int i;
+
+    while (length-- > 0)
+    {
+        crc ^= (uint16_t) (*data++ << 8);
+        for (i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) :
+                (uint16_t) (crc << 1);
+        }
+    }
+    return crc;
+}
+
+//-------------------------------------------------------------------------
+static uint8_t nameHash(const char *name)
+{
+    uint8_t hash;
+    int i;
+
+    hash = 0;
+    for (i = 0; (i < NAMELENGTH) && (name[i] != '\0'); i++)
+    {
+        hash = hash * 31 + (uint8_t) name[i];
+    }
+    return hash;
+}
+
+//-------------------------------------------------------------------------
+static uint8_t *node(int addr)
+{
+    return eeprom + addr * INODESIZE;
+}
+
+//-------------------------------------------------------------------------
+static int bitGet(int start, int number)
+{
+    return (eeprom[start + (number >> 3)] & (1 << (number & 7))) != 0;
+}
+
+//-------------------------------------------------------------------------
+static void bitSet(int start, int number, int value)
+{
+    if (value)
+    {
+        eeprom[start + (number >> 3)] |= 1 << (number & 7);
+    }
+    else
+    {
+        eeprom[start + (number >> 3)] &= ~(1 << (number & 7));
+    }
+}
+
+//-------------------------------------------------------------------------
+//the type of a valid inode, or 0
+static int nodeType(int addr)
+{
+    if ((addr < 0) || (addr > INODENUM) || (node(addr)[VALIDOFFSET] == 0))
+    {
+        return 0;
+    }
+    return node(addr)[TYPEOFFSET];
+}
+
+//-------------------------------------------------------------------------
+static void nodeName(int addr, char *name)
+{
+    memcpy(name, node(addr) + FILENAMEOFFSET, NAMELENGTH);
+    name[NAMELENGTH] = '\0';
+}
+
+//-------------------------------------------------------------------------
+static void nodePath(int addr, char *path, int size)
+{
+    char name[NAMELENGTH + 1];
+    char rest[256];
+    int depth;
+
+    path[0] = '\0';
+    for (depth = 0; (addr != FSROOTNODE) && (depth <= INODENUM); depth++)
+    {
+        nodeName(addr, name);
+        snprintf(rest, sizeof(rest), "/%s%s", name, path);
+        snprintf(path, size, "%s", rest);
+        addr = node(addr)[FILE_PARENTOFFSET];
+        if ((addr < 0) || (addr > INODENUM))
+        {
+            break;
+        }
+    }
+    if (path[0] == '\0')
+    {
+        snprintf(path, size, "/");
+    }
+}
+
+//-------------------------------------------------------------------------
+static int fileSector(int addr, int slot)
+{
+    int sector;
+
+    sector = node(addr)[FILE_ADDRPAGEOFFSET + slot];
+    if (node(addr)[FILE_SECTORHIGHOFFSET] & (1 << slot))
+    {
+        sector += 256;
+    }
+    return sector;
+}
+
+//-------------------------------------------------------------------------
+static void setFileSector(int addr, int slot, int sector)
+{
+    node(addr)[FILE_ADDRPAGEOFFSET + slot] = (uint8_t) sector;
+    if (sector & 0x100)
+    {
+        node(addr)[FILE_SECTORHIGHOFFSET] |= 1 << slot;
+    }
+    else
+    {
+        node(addr)[FILE_SECTORHIGHOFFSET] &= ~(1 << slot);
+    }
+}
+
+//-------------------------------------------------------------------------
+static long fileSize(int addr)
+{
+    uint8_t *p;
+
+    p = node(addr);
+    return p[FILE_SIZEOFFSET] | (p[FILE_SIZEOFFSET + 1] << 8) |
+        ((long) p[FILE_SIZEHIGHOFFSET] << 16) |
+        ((long) p[FILE_SIZEHIGHOFFSET + 1] << 24);
+}
+
+//-------------------------------------------------------------------------
+static void setFileSize(int addr, long size)
+{
+    uint8_t *p;
+
+    p = node(addr);
+    p[FILE_SIZEOFFSET] = (uint8_t) size;
+    p[FILE_SIZEOFFSET + 1] = (uint8_t) (size >> 8);
+    p[FILE_SIZEHIGHOFFSET] = (uint8_t) (size >> 16);
+    p[FILE_SIZEHIGHOFFSET + 1] = (uint8_t) (size >> 24);
+}
+
+//-------------------------------------------------------------------------
+//the sector holding a position of a file, following its chain of continuation inodes, or 0
+static int fileSectorAt(int addr, long pos)
+{
+    int group, current, depth;
+
+    group = pos / SECTOR_SIZE / FILE_SLOTS;
+    current = addr;
+    for (depth = 0; depth < group; depth++)
+    {
+        current = node(current)[FILE_NEXTOFFSET];
+        if ((current == 0) || (current > INODENUM))
+        {
+            return 0;
+        }
+    }
+    return fileSector(current, pos / SECTOR_SIZE % FILE_SLOTS);
+}
+
+//-------------------------------------------------------------------------
+//the bytes held by the sectors a file owns
+static long fileCapacity(int addr)
+{
+    int current, slot, depth;
+    long capacity;
+
+    capacity = 0;
+    current = addr;
+    for (depth = 0; (current > 0) && (current <= INODENUM) && (depth <= INODENUM);
+         depth++)
+    {
+        for (slot = 0; slot < FILE_SLOTS; slot++)
+        {
+            if (fileSector(current, slot) > 0)
+            {
+                capacity += SECTOR_SIZE;
+            }
+        }
+        current = node(current)[FILE_NEXTOFFSET];
+    }
+    return capacity;
+}
+
+//-------------------------------------------------------------------------
+static uint8_t *pageData(int page)
+{
+    return flash + (long) page * FLASH_PAGE_SIZE;
+}
+
+//-------------------------------------------------------------------------
+static void stampPage(int page)
+{
+    uint8_t *p;
+    uint16_t crc;
+
+    p = pageData(page);
+    crc = crcXmodem(0xffff, p, FLASH_DATA_SIZE);
+    p[FLASH_DATA_SIZE] = (uint8_t) crc;
+    p[FLASH_DATA_SIZE + 1] = (uint8_t) (crc >> 8);
+    p[FLASH_DATA_SIZE + 2] = (uint8_t) ~crc;
+    p[FLASH_DATA_SIZE + 3] = (uint8_t) (~crc >> 8);
+}
+
+//-------------------------------------------------------------------------
+//0 if a page matches its stamp, 1 if it does not, 2 if it was never stamped
+static int verifyPage(int page)
+{
+    uint8_t *p;
+    uint16_t crc;
+
+    p = pageData(page);
+    if (((p[FLASH_DATA_SIZE] ^ p[FLASH_DATA_SIZE + 2]) != 0xff) ||
+        ((p[FLASH_DATA_SIZE + 1] ^ p[FLASH_DATA_SIZE + 3]) != 0xff))
+    {
+        return 2;
+    }
+    crc = crcXmodem(0xffff, p, FLASH_DATA_SIZE);
+    return crc == (p[FLASH_DATA_SIZE] | (p[FLASH_DATA_SIZE + 1] << 8)) ? 0 : 1;
+}
+
+//-------------------------------------------------------------------------
+//copy bytes of a file out of the flash image; -1 if they lie in a sector the file does not own
+static int readFileBytes(int addr, long pos, uint8_t * buffer, long nBytes)
+{
+    int sector, count;
+
+    while (nBytes > 0)
+    {
+        sector = fileSectorAt(addr, pos);
+        if ((sector < 1) || (sector > FLASH_SECTOR_NUM))
+        {
+            return -1;
+        }
+        count = FLASH_DATA_SIZE - pos % FLASH_DATA_SIZE;
+        if (count > nBytes)
+        {
+            count = nBytes;
+        }
+        memcpy(buffer, pageData((sector - 1) * PAGES_PER_SECTOR +
+                                pos % SECTOR_SIZE / FLASH_DATA_SIZE) +
+               pos % FLASH_DATA_SIZE, count);
+        buffer += count;
+        pos += count;
+        nBytes -= count;
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+//check the records of one transaction, or write them into place
+static int journalApply(int offset, int length, uint8_t * check, int write)
+{
+    uint8_t *record;
+    int pos, i;
+
+    *check = 0;
+    for (pos = 0; pos < length; pos += 3 + record[2])
+    {
+        record = eeprom + JOURNALSTART + offset + JOURNAL_HEADER + pos;
+        if ((record[2] > JOURNAL_RECORD_MAX) || (pos + 3 + record[2] > length))
+        {
+            return -1;
+        }
+        for (i = 0; i < 3 + record[2]; i++)
+        {
+            *check = (uint8_t) ((*check << 1) | (*check >> 7)) ^ record[i];
+        }
+        if ((write) && ((record[0] | (record[1] << 8)) + record[2] <=
+                        JOURNALSTART))
+        {
+            memcpy(eeprom + (record[0] | (record[1] << 8)), record + 3,
+                   record[2]);
+        }
+    }
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+//replay the last committed transaction, as journalRecover() does at mount time
+static void journalReplay()
+{
+    uint8_t *header;
+    uint8_t check;
+    int offset, length, last, found;
+    uint16_t seq, lastseq;
+
+    offset = 0;
+    found = 0;
+    last = 0;
+    lastseq = 0;
+    journalstate = JOURNAL_EMPTY;
+    while (offset + JOURNAL_HEADER <= JOURNALSIZE)
+    {
+        header = eeprom + JOURNALSTART + offset;
+        length = (header[0] | (header[1] << 8)) & ~JOURNAL_CONTINUED;
+        seq = header[3] | (header[4] << 8);
+        if ((length == 0) || (length > JOURNALSIZE - offset - JOURNAL_HEADER))
+        {
+            break;
+        }
+        if ((found) && (seq != (uint16_t) (lastseq + 1)))
+        {
+            break;
+        }
+        if ((journalApply(offset, length, &check, 0) < 0)
+            || (check != header[2]))
+        {
+            break;
+        }
+        found = 1;
+        journalstate = (header[1] & (JOURNAL_CONTINUED >> 8)) ?
+            JOURNAL_PARTIAL : JOURNAL_COMPLETE;
+        lastseq = seq;
+        last = offset;
+        offset += JOURNAL_HEADER + length;
+    }
+    if (found)
+    {
+        header = eeprom + JOURNALSTART + last;
+        journalApply(last, (header[0] | (header[1] << 8)) & ~JOURNAL_CONTINUED,
+                     &check, 1);
+    }
+}
+
+//-------------------------------------------------------------------------
+static void journalReset()
+{
+    eeprom[JOURNALSTART] = 0xff;
+    eeprom[JOURNALSTART + 1] = 0xff;
+}
+
+//-------------------------------------------------------------------------
+static void loadImage(const char *path, uint8_t * buffer, long size)
+{
+    FILE *fp;
+    long count;
+
+    fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        fatal("cannot open %s: %s", path, strerror(errno));
+    }
+    count = fread(buffer, 1, size, fp);
+    fclose(fp);
+    if (count != size)
+    {
+        fatal("%s holds %ld bytes, an image holds %ld", path, count, size);
+    }
+}
+
+//-------------------------------------------------------------------------
+static void saveImage(const char *path, const uint8_t * buffer, long size)
+{
+    FILE *fp;
+
+    fp = fopen(path, "wb");
+    if ((fp == NULL) || (fwrite(buffer, 1, size, fp) != (size_t) size))
+    {
+        fatal("cannot write %s: %s", path, strerror(errno));
+    }
+    if (fclose(fp) != 0)
+    {
+        fatal("cannot write %s: %s", path, strerror(errno));
+    }
+}
+
+//-------------------------------------------------------------------------
+static void allocFlash()
+{
+    flash = malloc(FLASH_SIZE);
+    if (flash == NULL)
+    {
+        fatal("out of memory");
+    }
+}
+
+//-------------------------------------------------------------------------
+static void loadFlash(const char *path)
+{
+    allocFlash();
+    loadImage(path, flash, FLASH_SIZE);
+}
+
+//-------------------------------------------------------------------------
+//rebuild the allocation bitmaps from the inodes, as mountSystem() does after a partial or empty journal
+static void rebuildVectors()
+{
+    int addr, slot, sector;
+
+    memset(eeprom + EEPROMVECTORSTART, 0, (INODENUM + 7) / 8);
+    memset(eeprom + FLASHVECTORSTART, 0, FLASH_SECTOR_NUM / 8);
+    memset(eeprom + SHAREDVECTORSTART, 0, FLASH_SECTOR_NUM / 8);
+    for (addr = 1; addr <= INODENUM; addr++)
+    {
+        bitSet(EEPROMVECTORSTART, addr - 1, node(addr)[VALIDOFFSET] != 0);
+        if ((nodeType(addr) != FILENODE) && (nodeType(addr) != EXTNODE))
+        {
+            continue;
+        }
+        for (slot = 0; slot < FILE_SLOTS; slot++)
+        {
+            sector = fileSector(addr, slot);
+            if ((sector < 1) || (sector > FLASH_SECTOR_NUM))
+            {
+                continue;
+            }
+            if (bitGet(FLASHVECTORSTART, sector - 1))
+            {
+                bitSet(SHAREDVECTORSTART, sector - 1, 1);
+            }
+            bitSet(FLASHVECTORSTART, sector - 1, 1);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+//read an image the way a node mounts it
+static void mountImage(const char *path)
+{
+    loadImage(path, eeprom, EEPROM_SIZE);
+    journalReplay();
+    if (eeprom[FSREVISIONOFFSET] != FS_REVISION)
+    {
+        fatal("%s is not a revision %d file system (found %d), run check",
+              path, FS_REVISION, eeprom[FSREVISIONOFFSET]);
+    }
+    if (journalstate != JOURNAL_COMPLETE)
+    {
+        rebuildVectors();
+    }
+}
+
+//-------------------------------------------------------------------------
+static void formatImage()
+{
+    memset(eeprom, 0xff, EEPROM_SIZE);
+    memset(eeprom, 0, (INODENUM + 1) * INODESIZE);
+    memset(eeprom + EEPROMVECTORSTART, 0, (INODENUM + 7) / 8);
+    memset(eeprom + FLASHVECTORSTART, 0, FLASH_SECTOR_NUM / 8);
+    memset(eeprom + SHAREDVECTORSTART, 0, FLASH_SECTOR_NUM / 8);
+    memset(eeprom + WEARCOUNTSTART, 0, FLASH_SECTOR_NUM);
+    memset(eeprom + NAMEHASHSTART, 0, INODENUM + 1);
+    memset(eeprom + OPENLOGSTART, 0, (INODENUM + 8) / 8);
+    eeprom[LOGEPOCHOFFSET] = 0;
+    eeprom[FSREVISIONOFFSET] = FS_REVISION;
+    journalReset();
+    strcpy((char *)node(FSROOTNODE) + FILENAMEOFFSET, "root");
+    node(FSROOTNODE)[TYPEOFFSET] = DIRNODE;
+    node(FSROOTNODE)[VALIDOFFSET] = 1;
+    eeprom[NAMEHASHSTART + FSROOTNODE] = nameHash("root");
+    memset(flash, 0xff, FLASH_SIZE);
+}
+
+//-------------------------------------------------------------------------
+static int allocNode()
+{
+    int num;
+
+    for (num = 0; num < INODENUM; num++)
+    {
+        if (!bitGet(EEPROMVECTORSTART, num))
+        {
+            bitSet(EEPROMVECTORSTART, num, 1);
+            memset(node(num + 1), 0, INODESIZE);
+            node(num + 1)[VALIDOFFSET] = 1;
+            return num + 1;
+        }
+    }
+    fatal("out of inodes, a file system holds %d", INODENUM);
+    return -1;
+}
+
+//-------------------------------------------------------------------------
+//the free sector after the last one a file got, so that files stay contiguous like getFlashPageAfter() keeps them
+static int allocSector(int after)
+{
+    int i, sector;
+
+    for (i = 0; i < FLASH_SECTOR_NUM; i++)
+    {
+        sector = (after + i) % FLASH_SECTOR_NUM + 1;
+        if (!bitGet(FLASHVECTORSTART, sector - 1))
+        {
+            bitSet(FLASHVECTORSTART, sector - 1, 1);
+            return sector;
+        }
+    }
+    fatal("out of flash, a file system holds %ld bytes", FILE_MAX_SIZE);
+    return -1;
+}
+
+//-------------------------------------------------------------------------
+static int findChild(int directory, const char *name)
+{
+    char childname[NAMELENGTH + 1];
+    int block, i, child, depth;
+
+    block = directory;
+    for (depth = 0; depth <= INODENUM; depth++)
+    {
+        for (i = 0; i < DIR_SLOTS; i++)
+        {
+            child = node(block)[DIR_ADDRSUBOFFSET + i];
+            if ((child == 0) || (nodeType(child) == 0))
+            {
+                continue;
+            }
+            nodeName(child, childname);
+            if (strncmp(childname, name, NAMELENGTH) == 0)
+            {
+                return child;
+            }
+        }
+        block = node(block)[DIR_NEXTOFFSET];
+        if (block == 0)
+        {
+            break;
+        }
+    }
+    return -1;
+}
+
+//-------------------------------------------------------------------------
+static void addChild(int directory, int child)
+{
+    int block, next, i, extra;
+
+    block = directory;
+    while (1)
+    {
+        for (i = 0; i < DIR_SLOTS; i++)
+        {
+            if (node(block)[DIR_ADDRSUBOFFSET + i] == 0)
+            {
+                node(block)[DIR_ADDRSUBOFFSET + i] = (uint8_t) child;
+                return;
+            }
+        }
+        next = node(block)[DIR_NEXTOFFSET];
+        if (next == 0)
+        {
+            break;
+        }
+        block = next;
+    }
+    extra = allocNode();
+    node(extra)[TYPEOFFSET] = DIREXTNODE;
+    node(extra)[DIR_PARENTOFFSET] = (uint8_t) directory;
+    node(extra)[DIR_ADDRSUBOFFSET] = (uint8_t) child;
+    node(block)[DIR_NEXTOFFSET] = (uint8_t) extra;
+}
+
+//-------------------------------------------------------------------------
+static int createNode(int directory, const char *name, int type)
+{
+    int addr;
+
+    if ((name[0] == '\0') || (strlen(name) > NAMELENGTH)
+        || (strchr(name, '/') != NULL))
+    {
+        fatal("'%s' is not a valid name, names have 1 to %d characters",
+              name, NAMELENGTH);
+    }
+    if (findChild(directory, name) >= 0)
+    {
+        fatal("'%s' already exists", name);
+    }
+    addr = allocNode();
+    strncpy((char *)node(addr) + FILENAMEOFFSET, name, NAMELENGTH);
+    node(addr)[TYPEOFFSET] = (uint8_t) type;
+    node(addr)[FILE_PARENTOFFSET] = (uint8_t) directory;
+    eeprom[NAMEHASHSTART + addr] = nameHash(name);
+    addChild(directory, addr);
+    return addr;
+}
+
+//-------------------------------------------------------------------------
+//the inode of a path, or -1; with create set, missing directories on the way are made
+static int lookupPath(const char *path, int create)
+{
+    char name[256];
+    const char *p, *end;
+    int addr, child;
+
+    addr = FSROOTNODE;
+    p = path;
+    while (*p != '\0')
+    {
+        while (*p == '/')
+        {
+            p++;
+        }
+        if (*p == '\0')
+        {
+            break;
+        }
+        end = strchr(p, '/');
+        if (end == NULL)
+        {
+            end = p + strlen(p);
+        }
+        if (end - p >= (long) sizeof(name))
+        {
+            return -1;
+        }
+        memcpy(name, p, end - p);
+        name[end - p] = '\0';
+        if (nodeType(addr) != DIRNODE)
+        {
+            return -1;
+        }
+        child = findChild(addr, name);
+        if ((child < 0) && (create))
+        {
+            child = createNode(addr, name, DIRNODE);
+        }
+        if (child < 0)
+        {
+            return -1;
+        }
+        addr = child;
+        p = end;
+    }
+    return addr;
+}
+
+//-------------------------------------------------------------------------
+//split a path into the directory, made if missing, and the last name
+static int parentOf(const char *path, char *name)
+{
+    char directory[256];
+    const char *slash;
+
+    slash = strrchr(path, '/');
+    if (slash == NULL)
+    {
+        snprintf(name, NAMELENGTH + 2, "%s", path);
+        return FSROOTNODE;
+    }
+    if (slash - path >= (long) sizeof(directory))
+    {
+        fatal("path too long: %s", path);
+    }
+    memcpy(directory, path, slash - path);
+    directory[slash - path] = '\0';
+    snprintf(name, NAMELENGTH + 2, "%s", slash + 1);
+    return lookupPath(directory, 1);
+}
+
+//-------------------------------------------------------------------------
+//give a new file the sectors for length bytes, chaining continuation inodes every eight sectors
+static void allocFile(int addr, long length)
+{
+    int current, last, i;
+
+    if (length > FILE_MAX_SIZE)
+    {
+        fatal("a file holds at most %ld bytes", FILE_MAX_SIZE);
+    }
+    current = addr;
+    last = 0;
+    for (i = 0; (long) i * SECTOR_SIZE < length; i++)
+    {
+        if ((i > 0) && (i % FILE_SLOTS == 0))
+        {
+            node(current)[FILE_NEXTOFFSET] = (uint8_t) allocNode();
+            current = node(current)[FILE_NEXTOFFSET];
+            node(current)[TYPEOFFSET] = EXTNODE;
+            node(current)[FILE_PARENTOFFSET] = (uint8_t) addr;
+        }
+        last = allocSector(last);
+        setFileSector(current, i % FILE_SLOTS, last);
+    }
+}
+
+//-------------------------------------------------------------------------
+//give a new file its contents
+static void writeFile(int addr, const uint8_t * data, long length)
+{
+    int page;
+    long pos, count;
+
+    allocFile(addr, length);
+    //only the pages that hold data are programmed, and so stamped
+    for (pos = 0; pos < length; pos += FLASH_DATA_SIZE)
+    {
+        page = (fileSectorAt(addr, pos) - 1) * PAGES_PER_SECTOR +
+            pos % SECTOR_SIZE / FLASH_DATA_SIZE;
+        count = length - pos < FLASH_DATA_SIZE ? length - pos :
+            FLASH_DATA_SIZE;
+        memset(pageData(page), 0xff, FLASH_DATA_SIZE);
+        memcpy(pageData(page), data + pos, count);
+        stampPage(page);
+    }
+    setFileSize(addr, length);
+}
+
+//-------------------------------------------------------------------------
+//a ring takes all its sectors up front, the way fcreatering() does, and starts empty with its pages left erased
+static void createRing(int addr, long capacity)
+{
+    if (capacity <= 0)
+    {
+        fatal("a ring holds at least one byte");
+    }
+    allocFile(addr, (capacity + SECTOR_SIZE - 1) / SECTOR_SIZE * SECTOR_SIZE);
+    node(addr)[FILE_FLAGSOFFSET] = FILE_FLAG_RING;
+    setFileSize(addr, 0);
+}
+
+//-------------------------------------------------------------------------
+static uint8_t *readHostFile(const char *path, long *length)
+{
+    FILE *fp;
+    uint8_t *data;
+    long size;
+
+    fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        fatal("cannot open %s: %s", path, strerror(errno));
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size > FILE_MAX_SIZE)
+    {
+        fatal("%s is larger than the flash", path);
+    }
+    data = malloc(size > 0 ? size : 1);
+    if ((data == NULL) || (fread(data, 1, size, fp) != (size_t) size))
+    {
+        fatal("cannot read %s", path);
+    }
+    fclose(fp);
+    *length = size;
+    return data;
+}
+
+//-------------------------------------------------------------------------
+static void addHostFile(int directory, const char *name, const char *path)
+{
+    uint8_t *data;
+    long length;
+
+    data = readHostFile(path, &length);
+    writeFile(createNode(directory, name, FILENODE), data, length);
+    free(data);
+}
+
+//-------------------------------------------------------------------------
+static int compareNames(const struct dirent **a, const struct dirent **b)
+{
+    return strcmp((*a)->d_name, (*b)->d_name);
+}
+
+//-------------------------------------------------------------------------
+//copy a host directory tree in name order, so that the same tree always gives the same image
+static void addHostTree(int directory, const char *path)
+{
+    struct dirent **entries;
+    struct stat info;
+    char child[4096];
+    int count, i;
+
+    count = scandir(path, &entries, NULL, compareNames);
+    if (count < 0)
+    {
+        fatal("cannot read %s: %s", path, strerror(errno));
+    }
+    for (i = 0; i < count; i++)
+    {
+        if ((strcmp(entries[i]->d_name, ".") != 0)
+            && (strcmp(entries[i]->d_name, "..") != 0))
+        {
+            snprintf(child, sizeof(child), "%s/%s", path, entries[i]->d_name);
+            if (stat(child, &info) != 0)
+            {
+                fatal("cannot stat %s: %s", child, strerror(errno));
+            }
+            if (S_ISDIR(info.st_mode))
+            {
+                addHostTree(createNode(directory, entries[i]->d_name, DIRNODE),
+                            child);
+            }
+            else if (S_ISREG(info.st_mode))
+            {
+                addHostFile(directory, entries[i]->d_name, child);
+            }
+            else
+            {
+                fprintf(stderr, "fsimage: skipping %s\n", child);
+            }
+        }
+        free(entries[i]);
+    }
+    free(entries);
+}
+
+//-------------------------------------------------------------------------
+static const char *typeName(int type)
+{
+    switch (type)
+    {
+    case DIRNODE:
+        return "dir";
+    case FILENODE:
+        return "file";
+    case DEVNODE:
+        return "dev";
+    case APPNODE:
+        return "app";
+    case EXTNODE:
+        return "ext";
+    case DIREXTNODE:
+        return "dirext";
+    default:
+        return "?";
+    }
+}
+
+//-------------------------------------------------------------------------
+static void listTree(int addr, int depth)
+{
+    char name[NAMELENGTH + 1];
+    int block, i, child, guard;
+
+    nodeName(addr, name);
+    printf("%3d %-4s", addr, typeName(nodeType(addr)));
+    if (nodeType(addr) == FILENODE)
+    {
+        printf(" %7ld", fileSize(addr));
+    }
+    else
+    {
+        printf(" %7s", "");
+    }
+    printf(" %*s%s%s", depth * 2, "", name,
+           nodeType(addr) == DIRNODE ? "/" : "");
+    if ((nodeType(addr) == FILENODE)
+        && (node(addr)[FILE_FLAGSOFFSET] & FILE_FLAG_RING))
+    {
+        printf(node(addr)[FILE_FLAGSOFFSET] & FILE_FLAG_WRAPPED ?
+               "  (ring, wrapped)" : "  (ring)");
+    }
+    else if ((nodeType(addr) == FILENODE) && (node(addr)[FILE_LOGOFFSET] != 0))
+    {
+        printf(node(addr)[FILE_FLAGSOFFSET] & FILE_FLAG_COMPRESSED ?
+               "  (compressed log)" : "  (log)");
+    }
+    printf("\n");
+    if ((nodeType(addr) != DIRNODE) || (depth > INODENUM))
+    {
+        return;
+    }
+    block = addr;
+    for (guard = 0; guard <= INODENUM; guard++)
+    {
+        for (i = 0; i < DIR_SLOTS; i++)
+        {
+            child = node(block)[DIR_ADDRSUBOFFSET + i];
+            if ((child > 0) && (child <= INODENUM) && (nodeType(child) != 0))
+            {
+                listTree(child, depth + 1);
+            }
+        }
+        block = node(block)[DIR_NEXTOFFSET];
+        if (block == 0)
+        {
+            break;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+static void dumpImage()
+{
+    char name[NAMELENGTH + 1];
+    int addr, i, available, used, shared;
+    uint8_t *p;
+
+    printf("revision %d, log epoch %d, journal %s\n", eeprom[FSREVISIONOFFSET],
+           eeprom[LOGEPOCHOFFSET],
+           journalstate == JOURNAL_EMPTY ? "empty" :
+           journalstate == JOURNAL_PARTIAL ? "partial" : "committed");
+    for (addr = 0; addr <= INODENUM; addr++)
+    {
+        if (nodeType(addr) == 0)
+        {
+            continue;
+        }
+        p = node(addr);
+        nodeName(addr, name);
+        printf("%3d %-6s parent %3d next %3d hash %02x '%s'", addr,
+               typeName(p[TYPEOFFSET]), p[FILE_PARENTOFFSET],
+               p[FILE_NEXTOFFSET], eeprom[NAMEHASHSTART + addr], name);
+        if ((p[TYPEOFFSET] == DIRNODE) || (p[TYPEOFFSET] == DIREXTNODE))
+        {
+            printf(" children");
+            for (i = 0; i < DIR_SLOTS; i++)
+            {
+                printf(" %d", p[DIR_ADDRSUBOFFSET + i]);
+            }
+        }
+        else if ((p[TYPEOFFSET] == FILENODE) || (p[TYPEOFFSET] == EXTNODE))
+        {
+            printf(" sectors");
+            for (i = 0; i < FILE_SLOTS; i++)
+            {
+                printf(" %d", fileSector(addr, i));
+            }
+            if (p[TYPEOFFSET] == FILENODE)
+            {
+                printf(" size %ld epoch %d flags %02x", fileSize(addr),
+                       p[FILE_LOGOFFSET], p[FILE_FLAGSOFFSET]);
+            }
+        }
+        printf("\n");
+    }
+    available = 0;
+    used = 0;
+    shared = 0;
+    for (i = 0; i < FLASH_SECTOR_NUM; i++)
+    {
+        used += bitGet(FLASHVECTORSTART, i);
+        shared += bitGet(SHAREDVECTORSTART, i);
+    }
+    for (i = 0; i < INODENUM; i++)
+    {
+        available += !bitGet(EEPROMVECTORSTART, i);
+    }
+    printf("%d of %d inodes free, %d of %d sectors used, %d shared\n", available,
+           INODENUM, used, FLASH_SECTOR_NUM, shared);
+}
+
+//-------------------------------------------------------------------------
+//walk the records of a log, as logRecover() does, up to the size in the inode
+static void checkLog(int addr, const char *path)
+{
+    uint8_t header[LOG_HEADER_SIZE];
+    uint8_t data[256];
+    uint8_t prefix[6];
+    uint8_t epoch;
+    uint16_t crc;
+    long pos, size;
+
+    epoch = node(addr)[FILE_LOGOFFSET];
+    size = fileSize(addr);
+    for (pos = 0; pos < size; pos += LOG_HEADER_SIZE + header[0])
+    {
+        if ((readFileBytes(addr, pos, header, LOG_HEADER_SIZE) < 0)
+            || (header[0] == 0)
+            || (pos + LOG_HEADER_SIZE + header[0] > size)
+            || (readFileBytes(addr, pos + LOG_HEADER_SIZE, data, header[0]) <
+                0))
+        {
+            problem(1, "%s: log record at %ld runs past the end of the log",
+                    path, pos);
+            return;
+        }
+        prefix[0] = (uint8_t) addr;
+        prefix[1] = epoch;
+        prefix[2] = (uint8_t) pos;
+        prefix[3] = (uint8_t) (pos >> 8);
+        prefix[4] = (uint8_t) (pos >> 16);
+        prefix[5] = header[0];
+        crc = crcCcitt(crcCcitt(0xffff, prefix, 6), data, header[0]);
+        if (crc != (header[1] | (header[2] << 8)))
+        {
+            problem(1, "%s: log record at %ld fails its CRC", path, pos);
+            return;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+static void checkFile(int addr, const char *path)
+{
+    int current, previous, slot, sector, hole, count, page, result, depth;
+    long size;
+
+    count = 0;
+    hole = 0;
+    current = addr;
+    previous = 0;
+    for (depth = 0; current != 0; depth++)
+    {
+        if (current != addr)
+        {
+            if ((current > INODENUM) || (nodeType(current) != EXTNODE)
+                || (node(current)[FILE_PARENTOFFSET] != addr))
+            {
+                problem(1, "%s: inode %d chains inode %d, which is not one of its continuation inodes",
+                        path, previous, current);
+                break;
+            }
+            if (nodeseen[current])
+            {
+                problem(1, "%s: continuation inode %d is linked twice", path,
+                        current);
+                break;
+            }
+            if (hole)
+            {
+                problem(1, "%s: inode %d chains more sectors after an empty slot",
+                        path, previous);
+            }
+            nodeseen[current] = 1;
+        }
+        for (slot = 0; slot < FILE_SLOTS; slot++)
+        {
+            sector = fileSector(current, slot);
+            if (sector == 0)
+            {
+                hole = 1;
+                continue;
+            }
+            if (hole)
+            {
+                problem(1, "%s: sector %d follows an empty slot of inode %d",
+                        path, sector, current);
+            }
+            if (sector > FLASH_SECTOR_NUM)
+            {
+                problem(1, "%s: inode %d names sector %d, which does not exist",
+                        path, current, sector);
+                continue;
+            }
+            if ((sectorusers[sector] > 0) && (sectorowner[sector] == addr))
+            {
+                problem(1, "%s: sector %d is used twice within the file", path,
+                        sector);
+                continue;
+            }
+            sectorusers[sector]++;
+            sectorowner[sector] = (uint8_t) addr;
+            count++;
+            //a shared sector is only verified with its first user
+            for (page = (sector - 1) * PAGES_PER_SECTOR;
+                 (flash != NULL) && (sectorusers[sector] == 1)
+                 && (page < sector * PAGES_PER_SECTOR); page++)
+            {
+                result = verifyPage(page);
+                if (result == 1)
+                {
+                    problem(1, "%s: flash page %d does not match its CRC",
+                            path, page);
+                }
+            }
+        }
+        previous = current;
+        current = node(current)[FILE_NEXTOFFSET];
+    }
+    size = fileSize(addr);
+    if ((node(addr)[FILE_FLAGSOFFSET] & FILE_FLAG_RING)
+        && (size >= (long) count * SECTOR_SIZE))
+    {
+        problem(1, "%s: the head %ld of the ring lies past its %d sectors",
+                path, size, count);
+    }
+    else if (size > (long) count * SECTOR_SIZE)
+    {
+        problem(1, "%s: size %ld exceeds the %d sectors the file owns", path,
+                size, count);
+    }
+    else if ((node(addr)[FILE_LOGOFFSET] != 0) && (flash != NULL))
+    {
+        checkLog(addr, path);
+    }
+}
+
+//-------------------------------------------------------------------------
+static void checkDirectory(int addr, const char *path)
+{
+    char names[INODENUM + 1][NAMELENGTH + 1];
+    char childpath[512];
+    int block, previous, i, j, child, type, count;
+
+    count = 0;
+    block = addr;
+    previous = addr;
+    while (1)
+    {
+        if (block != addr)
+        {
+            if ((block > INODENUM) || (nodeType(block) != DIREXTNODE)
+                || (node(block)[DIR_PARENTOFFSET] != addr))
+            {
+                problem(1, "%s: inode %d chains inode %d, which is not one of its continuation blocks",
+                        path, previous, block);
+                return;
+            }
+            if (nodeseen[block])
+            {
+                problem(1, "%s: continuation block %d is linked twice", path,
+                        block);
+                return;
+            }
+            nodeseen[block] = 1;
+        }
+        for (i = 0; i < DIR_SLOTS; i++)
+        {
+            child = node(block)[DIR_ADDRSUBOFFSET + i];
+            if (child == 0)
+            {
+                continue;
+            }
+            type = nodeType(child);
+            if ((child > INODENUM) || (type == 0))
+            {
+                problem(1, "%s: inode %d lists inode %d, which is not in use",
+                        path, block, child);
+                continue;
+            }
+            if ((type == EXTNODE) || (type == DIREXTNODE) || (type > DIREXTNODE))
+            {
+                problem(1, "%s: inode %d lists inode %d of type %d as a child",
+                        path, block, child, type);
+                continue;
+            }
+            if (nodeseen[child])
+            {
+                problem(1, "%s: inode %d is linked twice", path, child);
+                continue;
+            }
+            nodeseen[child] = 1;
+            nodeName(child, names[count]);
+            snprintf(childpath, sizeof(childpath), "%s%s%s", path,
+                     addr == FSROOTNODE ? "" : "/", names[count]);
+            if (names[count][0] == '\0')
+            {
+                problem(1, "%s: inode %d has an empty name", path, child);
+            }
+            if (eeprom[NAMEHASHSTART + child] != nameHash(names[count]))
+            {
+                problem(1, "%s: the name hash of inode %d is stale, lookups cannot find it",
+                        childpath, child);
+            }
+            if (node(child)[FILE_PARENTOFFSET] != addr)
+            {
+                problem(1, "%s: inode %d names %d as its parent, not %d",
+                        childpath, child, node(child)[FILE_PARENTOFFSET],
+                        addr);
+            }
+            for (j = 0; j < count; j++)
+            {
+                if (strcmp(names[j], names[count]) == 0)
+                {
+                    problem(1, "%s: the name is used twice", childpath);
+                }
+            }
+            count++;
+            if (type == DIRNODE)
+            {
+                checkDirectory(child, childpath);
+            }
+            else if (type == FILENODE)
+            {
+                checkFile(child, childpath);
+            }
+        }
+        previous = block;
+        block = node(block)[DIR_NEXTOFFSET];
+        if (block == 0)
+        {
+            break;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+//check everything mountSystem() and the allocators rely on; returns the number of errors
+static int checkImage()
+{
+    char path[256];
+    int addr, sector, used, marked, authoritative;
+
+    if (eeprom[FSREVISIONOFFSET] > FS_REVISION)
+    {
+        problem(1, "revision %d is not a LiteOS file system this tool knows",
+                eeprom[FSREVISIONOFFSET]);
+        return errors;
+    }
+    if (eeprom[FSREVISIONOFFSET] < FS_REVISION)
+    {
+        problem(0, "revision %d, mounting migrates it to revision %d",
+                eeprom[FSREVISIONOFFSET], FS_REVISION);
+    }
+    if (journalstate == JOURNAL_PARTIAL)
+    {
+        problem(0, "the journal ends inside a transaction, mounting keeps the metadata of its last part");
+    }
+    if ((nodeType(FSROOTNODE) != DIRNODE)
+        || (node(FSROOTNODE)[DIR_PARENTOFFSET] != FSROOTNODE))
+    {
+        problem(1, "the root directory is missing");
+        return errors;
+    }
+    memset(sectorowner, 0, sizeof(sectorowner));
+    memset(sectorusers, 0, sizeof(sectorusers));
+    memset(nodeseen, 0, sizeof(nodeseen));
+    nodeseen[FSROOTNODE] = 1;
+    checkDirectory(FSROOTNODE, "/");
+    for (addr = 1; addr <= INODENUM; addr++)
+    {
+        if ((nodeType(addr) != 0) && (!nodeseen[addr]))
+        {
+            nodePath(addr, path, sizeof(path));
+            problem(1, "inode %d (%s, last known as %s) cannot be reached from the root",
+                    addr, typeName(nodeType(addr)), path);
+        }
+    }
+    //bitmaps are only loaded after a committed transaction; otherwise mounting rebuilds them from the inodes
+    authoritative = journalstate == JOURNAL_COMPLETE;
+    for (addr = 1; (authoritative) && (addr <= INODENUM); addr++)
+    {
+        if (bitGet(EEPROMVECTORSTART, addr - 1) != (node(addr)[VALIDOFFSET] != 0))
+        {
+            problem(1, "inode %d is %s but the inode bitmap says otherwise",
+                    addr, node(addr)[VALIDOFFSET] ? "in use" : "free");
+        }
+    }
+    for (sector = 1; (authoritative) && (sector <= FLASH_SECTOR_NUM); sector++)
+    {
+        used = sectorusers[sector];
+        marked = bitGet(FLASHVECTORSTART, sector - 1);
+        if ((used > 0) && (!marked))
+        {
+            problem(1, "sector %d is in use but free in the flash bitmap",
+                    sector);
+        }
+        else if ((used == 0) && (marked))
+        {
+            problem(0, "sector %d is allocated but no file uses it", sector);
+        }
+        marked = bitGet(SHAREDVECTORSTART, sector - 1);
+        if ((used > 1) && (!marked))
+        {
+            problem(1, "sector %d is used by %d files but not marked shared",
+                    sector, used);
+        }
+        else if ((used < 2) && (marked))
+        {
+            problem(0, "sector %d is marked shared but used by %d file%s",
+                    sector, used, used == 1 ? "" : "s");
+        }
+    }
+    return errors;
+}
+
+//-------------------------------------------------------------------------
+static void usage()
+{
+    fprintf(stderr,
+            "usage: fsimage format <eeprom> <flash>\n"
+            "       fsimage build <eeprom> <flash> <directory>\n"
+            "       fsimage add <eeprom> <flash> <file> <path>\n"
+            "       fsimage mkdir <eeprom> <path>\n"
+            "       fsimage ring <eeprom> <capacity> <path>\n"
+            "       fsimage get <eeprom> <flash> <path> <file | ->\n"
+            "       fsimage ls <eeprom> [<path>]\n"
+            "       fsimage dump <eeprom>\n"
+            "       fsimage check <eeprom> [<flash>]\n");
+    exit(2);
+}
+
+//-------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    char name[NAMELENGTH + 2];
+    char *end;
+    uint8_t *data;
+    FILE *fp;
+    long size, start;
+    int addr;
+
+    if (argc < 3)
+    {
+        usage();
+    }
+    if ((strcmp(argv[1], "format") == 0) && (argc == 4))
+    {
+        allocFlash();
+        formatImage();
+        saveImage(argv[2], eeprom, EEPROM_SIZE);
+        saveImage(argv[3], flash, FLASH_SIZE);
+    }
+    else if ((strcmp(argv[1], "build") == 0) && (argc == 5))
+    {
+        allocFlash();
+        formatImage();
+        addHostTree(FSROOTNODE, argv[4]);
+        saveImage(argv[2], eeprom, EEPROM_SIZE);
+        saveImage(argv[3], flash, FLASH_SIZE);
+    }
+    else if ((strcmp(argv[1], "add") == 0) && (argc == 6))
+    {
+        mountImage(argv[2]);
+        loadFlash(argv[3]);
+        addr = parentOf(argv[5], name);
+        if (nodeType(addr) != DIRNODE)
+        {
+            fatal("no directory for %s", argv[5]);
+        }
+        addHostFile(addr, name, argv[4]);
+        journalReset();
+        saveImage(argv[2], eeprom, EEPROM_SIZE);
+        saveImage(argv[3], flash, FLASH_SIZE);
+    }
+    else if ((strcmp(argv[1], "mkdir") == 0) && (argc == 4))
+    {
+        mountImage(argv[2]);
+        addr = parentOf(argv[3], name);
+        if (nodeType(addr) != DIRNODE)
+        {
+            fatal("no directory for %s", argv[3]);
+        }
+        createNode(addr, name, DIRNODE);
+        journalReset();
+        saveImage(argv[2], eeprom, EEPROM_SIZE);
+    }
+    else if ((strcmp(argv[1], "ring") == 0) && (argc == 5))
+    {
+        mountImage(argv[2]);
+        size = strtol(argv[3], &end, 0);
+        if ((*end != '\0') || (end == argv[3]))
+        {
+            fatal("%s is not a capacity", argv[3]);
+        }
+        addr = parentOf(argv[4], name);
+        if (nodeType(addr) != DIRNODE)
+        {
+            fatal("no directory for %s", argv[4]);
+        }
+        createRing(createNode(addr, name, FILENODE), size);
+        journalReset();
+        saveImage(argv[2], eeprom, EEPROM_SIZE);
+    }
+    else if ((strcmp(argv[1], "get") == 0) && (argc == 6))
+    {
+        mountImage(argv[2]);
+        loadFlash(argv[3]);
+        addr = lookupPath(argv[4], 0);
+        if (nodeType(addr) != FILENODE)
+        {
+            fatal("%s is not a file", argv[4]);
+        }
+        size = fileSize(addr);
+        start = 0;
+        //the size of a ring is its head, and a wrapped ring starts there
+        if ((node(addr)[FILE_FLAGSOFFSET] & FILE_FLAG_RING)
+            && (node(addr)[FILE_FLAGSOFFSET] & FILE_FLAG_WRAPPED))
+        {
+            start = size;
+            size = fileCapacity(addr);
+        }
+        data = malloc(size > 0 ? size : 1);
+        if ((data == NULL)
+            || (readFileBytes(addr, start, data, size - start) < 0)
+            || (readFileBytes(addr, 0, data + size - start, start) < 0))
+        {
+            fatal("%s is damaged, run check", argv[4]);
+        }
+        fp = strcmp(argv[5], "-") == 0 ? stdout : fopen(argv[5], "wb");
+        if ((fp == NULL) || (fwrite(data, 1, size, fp) != (size_t) size))
+        {
+            fatal("cannot write %s", argv[5]);
+        }
+        if (fp != stdout)
+        {
+            fclose(fp);
+        }
+        free(data);
+    }
+    else if ((strcmp(argv[1], "ls") == 0) && (argc <= 4))
+    {
+        mountImage(argv[2]);
+        addr = lookupPath(argc == 4 ? argv[3] : "/", 0);
+        if (addr < 0)
+        {
+            fatal("%s does not exist", argv[3]);
+        }
+        listTree(addr, 0);
+    }
+    else if ((strcmp(argv[1], "dump") == 0) && (argc == 3))
+    {
+        loadImage(argv[2], eeprom, EEPROM_SIZE);
+        journalReplay();
+        dumpImage();
+    }
+    else if ((strcmp(argv[1], "check") == 0) && (argc <= 4))
+    {
+        loadImage(argv[2], eeprom, EEPROM_SIZE);
+        if (argc == 4)
+        {
+            loadFlash(argv[3]);
+        }
+        journalReplay();
+        checkImage();
+        printf("%d error%s, %d warning%s\n", errors, errors == 1 ? "" : "s",
+               warnings, warnings == 1 ? "" : "s");
+        return errors > 0;
+    }
+    else
+    {
+        usage();
+    }
+    return 0;
+}
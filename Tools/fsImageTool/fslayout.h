@@ -0,0 +1,89 @@
+/** @file fslayout.h
+	@brief The on-storage layout of the LiteOS file system, as seen from the host.
+
+	These values mirror storage/filesys/fsconfig.h and storage/filesys/storageconstants.h of the kernel, which cannot
+	be included here because the kernel defines its own fixed-width types. Keep them in step with FS_REVISION.
+*/
+
+#ifndef FSLAYOUTH
+#define FSLAYOUTH
+
+/** @brief The size of the EEPROM image. */
+#define EEPROM_SIZE 4096
+
+/** @brief The AT45DB041 has 2048 pages of 264 bytes, of which the file system uses the first 256. */
+#define FLASH_PAGES 2048
+#define FLASH_PAGE_SIZE 264
+#define FLASH_DATA_SIZE 256
+#define FLASH_SIZE ((long) FLASH_PAGES * FLASH_PAGE_SIZE)
+
+/** @brief A sector is 8 pages. Sector ids start at 1. */
+#define FLASH_SECTOR_NUM 256
+#define SECTOR_SIZE 2048
+#define PAGES_PER_SECTOR 8
+
+/** @brief The revision of the layout written by this tool. */
+#define FS_REVISION 4
+
+/** @brief Inodes are INODESIZE bytes at the start of the EEPROM. Inode 0 is the root directory. */
+#define INODESIZE 32
+#define INODENUM 96
+#define FSROOTNODE 0
+
+/** @brief Node types. */
+#define DIRNODE 1
+#define FILENODE 2
+#define DEVNODE 3
+#define APPNODE 4
+#define EXTNODE 5
+#define DIREXTNODE 6
+
+/** @brief Fields shared by all inodes. */
+#define FILENAMEOFFSET 0
+#define NAMELENGTH 12
+#define TYPEOFFSET 12
+#define VALIDOFFSET 13
+
+/** @brief Directory fields. A directory holds 10 children and chains continuation blocks (DIREXTNODE). */
+#define DIR_ADDRSUBOFFSET 14
+#define DIR_SLOTS 10
+#define DIR_NEXTOFFSET 24
+#define DIR_PARENTOFFSET 31
+
+/** @brief File fields. A file holds 8 sectors and chains continuation inodes (EXTNODE) whose parent is the file. */
+#define FILE_ADDRPAGEOFFSET 14
+#define FILE_SLOTS 8
+#define FILE_SIZEHIGHOFFSET 22
+#define FILE_NEXTOFFSET 24
+#define FILE_SECTORHIGHOFFSET 25
+#define FILE_FLAGSOFFSET 26
+#define FILE_LOGOFFSET 27
+#define FILE_UIDOFFSET 28
+#define FILE_SIZEOFFSET 29
+#define FILE_PARENTOFFSET 31
+#define FILE_FLAG_COMPRESSED 0x01
+#define FILE_FLAG_RING 0x02
+#define FILE_FLAG_WRAPPED 0x04
+#define FILE_MAX_SIZE ((long) FLASH_SECTOR_NUM * SECTOR_SIZE)
+
+/** @brief Byte storage areas after the inodes. */
+#define EEPROMVECTORSTART 3168
+#define FLASHVECTORSTART 3180
+#define LOGEPOCHOFFSET 3212
+#define FSREVISIONOFFSET 3213
+#define WEARCOUNTSTART 3216
+#define NAMEHASHSTART 3472
+#define OPENLOGSTART 3570
+#define JOURNALSTART 3584
+#define JOURNALSIZE 256
+#define SHAREDVECTORSTART 3840
+
+/** @brief The journal (see storage/filesys/journal.c). */
+#define JOURNAL_HEADER 5
+#define JOURNAL_CONTINUED 0x8000
+#define JOURNAL_RECORD_MAX 32
+
+/** @brief Log records start with the length and a CRC-CCITT (see storage/filesys/logfile.h). */
+#define LOG_HEADER_SIZE 3
+
+#endif